@@ -32,6 +32,8 @@ class GraphicsConan(ConanFile):
             "GL_ARB_base_instance,"
             "GL_ARB_multi_draw_indirect,"
             "GL_ARB_texture_filter_anisotropic," # anisotropic texture filtering
+            "GL_EXT_texture_compression_s3tc," # BC1 to BC3 compressed textures
+            "GL_EXT_texture_sRGB," # sRGB variants of the S3TC formats
         )
     }
 
@@ -42,6 +44,7 @@ class GraphicsConan(ConanFile):
         ("nlohmann_json/3.11.2"),
         ("spdlog/1.13.0"),
         ("utfcpp/4.0.1"),
+        ("zlib/1.2.13"),
         ("imgui/1.89.8"),
 
         ("handy/e2b164a804@adnn/develop"),
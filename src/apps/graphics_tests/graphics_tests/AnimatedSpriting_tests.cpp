@@ -0,0 +1,124 @@
+#include "catch.hpp"
+
+#include "FilesystemHelpers.h"
+#include "GlContext.h"
+
+#include <arte/SpriteSheet.h>
+
+#include <graphics/AnimatedSpriting.h>
+#include <graphics/SpriteAnimator.h>
+#include <graphics/Spriting.h>
+
+#include <handy/StringId.h>
+
+#include <renderer/FrameBuffer.h>
+#include <renderer/Texture.h>
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::graphics;
+
+
+namespace {
+
+
+    constexpr GLsizei gSide = 128;
+
+
+    /// \brief Clear the framebuffer bound to the draw target, invoke `aRender`, then read back all the pixels.
+    template <class F_render>
+    std::vector<GLubyte> renderPixels(F_render && aRender)
+    {
+        glViewport(0, 0, gSide, gSide);
+        glClearColor(0.f, 0.f, 0.f, 0.f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        aRender();
+
+        std::vector<GLubyte> pixels(4 * gSide * gSide);
+        glReadPixels(0, 0, gSide, gSide, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        return pixels;
+    }
+
+
+} // anonymous namespace
+
+
+SCENARIO("Animated sprites are rendered as the sprite of their current frame")
+{
+    INITIALIZE_GL_CONTEXT();
+
+    GIVEN("A render target, and an animation loaded in an atlas")
+    {
+        Texture target{GL_TEXTURE_2D};
+        allocateStorage(target, GL_RGBA8, gSide, gSide);
+        FrameBuffer frameBuffer;
+        attachImage(frameBuffer, target);
+        ScopedBind boundFrameBuffer{frameBuffer};
+
+        // 8 frames of 100 ms each, for a total duration of 800 ms.
+        const arte::AnimationSpriteSheet sheet =
+            arte::AnimationSpriteSheet::LoadAseFile(resource::pathFor("animations/run.json"));
+        sprite::Animator animator;
+        const sprite::LoadedAtlas atlas = animator.load(sheet);
+        const sprite::AnimationHandle handle = animator.getHandle(handy::StringId{sheet.name()});
+        const sprite::Animation::Duration_t totalDuration = animator.get(handle).totalDuration;
+
+        // A sprite pixel covers a target pixel, and the sprite origin is a quarter of a pixel
+        // away from the pixel boundaries, so both renderers rasterize exactly the same pixels.
+        const GLfloat pixelSize = 2.f / gSide;
+        const Position2<GLfloat> position{-1.f + 20.25f * pixelSize, -1.f + 10.25f * pixelSize};
+
+        AnimatedSpriting animatedSpriting{pixelSize};
+        animatedSpriting.loadAnimations(animator);
+        Spriting spriting{pixelSize};
+
+        auto requireSameRendering = [&](AnimatedSpriting::Playback aPlayback, GLfloat aTime)
+        {
+            const AnimatedSpriting::Instance animated{position, handle, 0.f, 1.f, aPlayback};
+            animatedSpriting.updateInstances(std::span{&animated, 1});
+            animatedSpriting.setTime(aTime);
+            const std::vector<GLubyte> animatedPixels = renderPixels([&]{ animatedSpriting.render(atlas); });
+
+            const sprite::Animation::Duration_t localTime =
+                aPlayback == AnimatedSpriting::Playback::Repeat ? std::fmod(aTime, totalDuration) : aTime;
+            const Spriting::Instance reference{position, animator.at(handle, localTime)};
+            spriting.updateInstances(std::span{&reference, 1});
+            const std::vector<GLubyte> referencePixels = renderPixels([&]{ spriting.render(atlas); });
+
+            // Otherwise the comparison would trivially succeed.
+            REQUIRE(std::any_of(referencePixels.begin(), referencePixels.end(),
+                                [](GLubyte aChannel){ return aChannel != 0; }));
+            REQUIRE(animatedPixels == referencePixels);
+            return referencePixels;
+        };
+
+        THEN("Within the first loop, the rendering matches the frame looked up by the animator")
+        {
+            const std::vector<GLubyte> middle = requireSameRendering(AnimatedSpriting::Playback::Repeat, 250.f);
+            // Exactly at the end of the third frame, which is still displayed.
+            const std::vector<GLubyte> boundary = requireSameRendering(AnimatedSpriting::Playback::Repeat, 300.f);
+            REQUIRE(boundary == middle);
+            // The next frame is a different image.
+            REQUIRE_FALSE(requireSameRendering(AnimatedSpriting::Playback::Repeat, 330.f) == middle);
+        }
+
+        THEN("After wrapping around, the rendering matches the frame at the wrapped local time")
+        {
+            requireSameRendering(AnimatedSpriting::Playback::Repeat, 1130.f);
+            // Exactly at the end of the first frame of the second loop.
+            requireSameRendering(AnimatedSpriting::Playback::Repeat, 900.f);
+            // Exactly at the end of the first loop, wrapping to local time 0.
+            requireSameRendering(AnimatedSpriting::Playback::Repeat, 1600.f);
+        }
+
+        THEN("Played once, the last frame is held once the animation is over")
+        {
+            requireSameRendering(AnimatedSpriting::Playback::Once, 1130.f);
+        }
+    }
+}
@@ -0,0 +1,289 @@
+#include "catch.hpp"
+
+#include "FilesystemHelpers.h"
+
+#include <arte/AtlasPacking.h>
+#include <arte/Image.h>
+#include <arte/SpriteSheet.h>
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+namespace {
+
+
+    /// \brief Test if the rectangles, grown by `aPadding` on the right and top, overlap.
+    bool overlap(const math::Rectangle<int> & aLhs, const math::Rectangle<int> & aRhs, int aPadding)
+    {
+        return aLhs.x() < aRhs.x() + aRhs.width() + aPadding && aRhs.x() < aLhs.x() + aLhs.width() + aPadding
+            && aLhs.y() < aRhs.y() + aRhs.height() + aPadding && aRhs.y() < aLhs.y() + aLhs.height() + aPadding;
+    }
+
+
+    void requireValidPacking(const std::vector<math::Size<2, int>> & aSizes,
+                             const RectanglePacking & aPacking,
+                             const PackingOptions & aOptions)
+    {
+        REQUIRE(aPacking.mRectangles.size() == aSizes.size());
+        for (math::Size<2, int> page : aPacking.mPageSizes)
+        {
+            REQUIRE(page.width() <= aOptions.mMaxPageSize.width());
+            REQUIRE(page.height() <= aOptions.mMaxPageSize.height());
+        }
+
+        for (std::size_t i = 0; i != aSizes.size(); ++i)
+        {
+            const PackedRectangle & packed = aPacking.mRectangles[i];
+            REQUIRE((aOptions.mAllowRotation || !packed.mRotated));
+
+            const math::Size<2, int> expected = packed.mRotated ?
+                math::Size<2, int>{aSizes[i].height(), aSizes[i].width()} : aSizes[i];
+            REQUIRE(packed.mArea.dimension() == expected);
+
+            const math::Size<2, int> page = aPacking.mPageSizes.at(packed.mPage);
+            REQUIRE(packed.mArea.x() >= 0);
+            REQUIRE(packed.mArea.y() >= 0);
+            REQUIRE(packed.mArea.x() + packed.mArea.width() <= page.width());
+            REQUIRE(packed.mArea.y() + packed.mArea.height() <= page.height());
+
+            for (std::size_t j = i + 1; j != aSizes.size(); ++j)
+            {
+                const PackedRectangle & other = aPacking.mRectangles[j];
+                if (other.mPage == packed.mPage)
+                {
+                    REQUIRE_FALSE(overlap(packed.mArea, other.mArea, aOptions.mPadding));
+                }
+            }
+        }
+    }
+
+
+    bool samePixel(math::sdr::Rgba aLhs, math::sdr::Rgba aRhs)
+    {
+        return std::memcmp(&aLhs, &aRhs, sizeof(math::sdr::Rgba)) == 0;
+    }
+
+
+} // anonymous namespace
+
+
+SCENARIO("Rectangle packing")
+{
+    GIVEN("Many rectangles of random sizes")
+    {
+        std::mt19937 generator{7};
+        std::uniform_int_distribution<int> widths{1, 60};
+        std::uniform_int_distribution<int> heights{1, 90};
+
+        std::vector<math::Size<2, int>> sizes;
+        int totalArea = 0;
+        for (int i = 0; i != 400; ++i)
+        {
+            sizes.push_back({widths(generator), heights(generator)});
+            totalArea += sizes.back().area();
+        }
+
+        WHEN("They are packed in small pages")
+        {
+            const PackingOptions options{.mMaxPageSize = {256, 256}};
+            RectanglePacking packing = packRectangles(sizes, options);
+
+            THEN("They spill over several pages, without overlapping")
+            {
+                REQUIRE(packing.mPageSizes.size() > 1);
+                requireValidPacking(sizes, packing, options);
+            }
+
+            THEN("The pages are densely packed")
+            {
+                int pagesArea = 0;
+                for (math::Size<2, int> page : packing.mPageSizes)
+                {
+                    pagesArea += page.area();
+                }
+                REQUIRE((double)totalArea / pagesArea > 0.85);
+            }
+        }
+
+        WHEN("They are packed with padding and rotation")
+        {
+            const PackingOptions options{
+                .mMaxPageSize = {256, 256},
+                .mPadding = 2,
+                .mAllowRotation = true,
+            };
+            RectanglePacking packing = packRectangles(sizes, options);
+
+            THEN("The padding is respected between all rectangles")
+            {
+                requireValidPacking(sizes, packing, options);
+            }
+        }
+    }
+
+    GIVEN("A rectangle larger than a page")
+    {
+        const std::vector<math::Size<2, int>> sizes{ {10, 10}, {300, 10} };
+
+        THEN("Packing throws")
+        {
+            REQUIRE_THROWS_AS(packRectangles(sizes, {.mMaxPageSize = {256, 256}}), std::invalid_argument);
+        }
+
+        THEN("It can be packed if rotation is allowed and makes it fit")
+        {
+            const PackingOptions options{.mMaxPageSize = {16, 512}, .mAllowRotation = true};
+            RectanglePacking packing = packRectangles(sizes, options);
+            requireValidPacking(sizes, packing, options);
+            REQUIRE(packing.mRectangles[1].mRotated);
+        }
+    }
+}
+
+
+SCENARIO("Atlas packing")
+{
+    GIVEN("Sub-images of an image")
+    {
+        const ImageRgba source{resource::pathFor("tests/Images/PNG/ColorCheck.png")};
+        const int width = source.width();
+        const int height = source.height();
+
+        const std::vector<math::Rectangle<int>> zones{
+            {{0, 0}, {width / 2, height / 4}},
+            {{width / 3, height / 5}, {width / 6, height / 2}},
+            {{width / 2, height / 2}, {width / 2, height / 2}},
+            {{1, 2}, {3, 5}},
+        };
+        std::vector<ImageView<const math::sdr::Rgba>> subImages;
+        for (const math::Rectangle<int> & zone : zones)
+        {
+            subImages.push_back(source.view(zone));
+        }
+
+        WHEN("They are packed in an atlas, allowing rotation")
+        {
+            Atlas<math::sdr::Rgba> atlas = packAtlas<math::sdr::Rgba>(
+                subImages,
+                math::sdr::gTransparent,
+                {.mPadding = 1, .mAllowRotation = true});
+
+            THEN("Each sub-image pixels are found at its placement")
+            {
+                REQUIRE(atlas.mPages.size() == 1);
+                REQUIRE(atlas.mPlacements.size() == zones.size());
+
+                for (std::size_t index = 0; index != zones.size(); ++index)
+                {
+                    const PackedRectangle & placement = atlas.mPlacements[index];
+                    const ImageRgba & page = atlas.mPages[placement.mPage];
+                    const ImageView<const math::sdr::Rgba> & subImage = subImages[index];
+
+                    for (int y = 0; y != subImage.height(); ++y)
+                    {
+                        for (int x = 0; x != subImage.width(); ++x)
+                        {
+                            const math::sdr::Rgba packed = placement.mRotated ?
+                                page.at(placement.mArea.x() + y, placement.mArea.y() + subImage.width() - 1 - x)
+                                : page.at(placement.mArea.x() + x, placement.mArea.y() + y);
+                            REQUIRE(samePixel(packed, subImage.at(x, y)));
+                        }
+                    }
+                }
+            }
+        }
+
+    GIVEN("Sub-images with pixel-identical duplicates")
+    {
+        const ImageRgba source{resource::pathFor("tests/Images/PNG/ColorCheck.png")};
+        const math::Rectangle<int> zone{{2, 3}, {source.width() / 4, source.height() / 4}};
+        const math::Rectangle<int> other{{source.width() / 2, 0}, {source.width() / 4, source.height() / 3}};
+        // A copy, so the duplicate is not at the same address.
+        const ImageRgba copy = source.crop(zone);
+
+        const std::vector<ImageView<const math::sdr::Rgba>> subImages{
+            source.view(zone),
+            source.view(other),
+            copy,
+            source.view(zone),
+        };
+
+        THEN("The duplicates are found")
+        {
+            REQUIRE(findDuplicates(std::span{subImages}) == std::vector<std::size_t>{0, 1, 0, 0});
+        }
+
+        WHEN("They are packed with deduplication")
+        {
+            PackingOptions options;
+            options.mDeduplicate = true;
+            Atlas<math::sdr::Rgba> atlas = packAtlas<math::sdr::Rgba>(subImages, math::sdr::gTransparent, options);
+
+            THEN("The duplicates share the placement of the first identical sub-image")
+            {
+                REQUIRE(atlas.mPlacements.size() == subImages.size());
+                for (std::size_t duplicate : {2, 3})
+                {
+                    REQUIRE(atlas.mPlacements[duplicate].mPage == atlas.mPlacements[0].mPage);
+                    REQUIRE(atlas.mPlacements[duplicate].mArea.origin() == atlas.mPlacements[0].mArea.origin());
+                }
+                REQUIRE_FALSE(atlas.mPlacements[1].mArea.origin() == atlas.mPlacements[0].mArea.origin());
+            }
+
+            THEN("The saved bytes are reported")
+            {
+                REQUIRE(atlas.mDeduplicatedBytes == 2 * zone.dimension().area() * sizeof(math::sdr::Rgba));
+            }
+        }
+    }
+
+    GIVEN("Sub-images which are all fully transparent frames, trimmed to their visible bounds")
+    {
+        const ImageRgba transparent{{8, 8}, math::sdr::gTransparent};
+        std::vector<ImageView<const math::sdr::Rgba>> subImages;
+        for (int frame = 0; frame != 3; ++frame)
+        {
+            // The visible bounds of a fully transparent area are empty.
+            subImages.push_back(transparent.view(getVisibleBounds(transparent.view({{0, 0}, {8, 8}}))));
+        }
+
+        WHEN("They are packed in an atlas")
+        {
+            Atlas<math::sdr::Rgba> atlas = packAtlas<math::sdr::Rgba>(
+                subImages,
+                math::sdr::gTransparent,
+                {.mPadding = 1, .mDeduplicate = true});
+
+            THEN("Each empty placement is on a page which exists, and has no pixels")
+            {
+                REQUIRE(atlas.mPages.size() == 1);
+                REQUIRE(atlas.mPages.front().dimensions().area() == 0);
+                REQUIRE(atlas.mPlacements.size() == subImages.size());
+                for (const PackedRectangle & placement : atlas.mPlacements)
+                {
+                    REQUIRE(placement.mPage == 0);
+                    REQUIRE(placement.mArea.dimension().area() == 0);
+                }
+            }
+        }
+    }
+
+    GIVEN("No sub-images")
+    {
+        THEN("The atlas has no pages")
+        {
+            Atlas<math::sdr::Rgba> atlas =
+                packAtlas<math::sdr::Rgba>(std::span<const ImageView<const math::sdr::Rgba>>{},
+                                           math::sdr::gTransparent);
+            REQUIRE(atlas.mPages.empty());
+            REQUIRE(atlas.mPlacements.empty());
+        }
+    }
+}
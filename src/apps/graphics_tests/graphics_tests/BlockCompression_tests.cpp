@@ -0,0 +1,174 @@
+#include "catch.hpp"
+
+#include "FilesystemHelpers.h"
+
+#include <arte/BlockCompression.h>
+#include <arte/Image.h>
+#include <arte/ThreadPool.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+namespace {
+
+
+    ImageRgba toOpaqueRgba(const ImageRgb & aSource)
+    {
+        auto result = ImageRgba::makeUninitialized(aSource.dimensions());
+        for (int row = 0; row != aSource.height(); ++row)
+        {
+            auto * source = reinterpret_cast<const std::uint8_t *>(aSource.row(row));
+            auto * destination = reinterpret_cast<std::uint8_t *>(result.row(row));
+            for (int column = 0; column != aSource.width(); ++column)
+            {
+                std::memcpy(destination + 4 * column, source + 3 * column, 3);
+                destination[4 * column + 3] = 255;
+            }
+        }
+        return result;
+    }
+
+
+    /// \brief Peak signal to noise ratio (in dB) of the `aChannels` first channels of each pixel.
+    template <class T_pixel>
+    double psnr(const Image<T_pixel> & aReference, const Image<T_pixel> & aDecoded, int aChannels)
+    {
+        REQUIRE(aReference.dimensions() == aDecoded.dimensions());
+        double squaredErrors = 0.;
+        for (int row = 0; row != aReference.height(); ++row)
+        {
+            auto * reference = reinterpret_cast<const std::uint8_t *>(aReference.row(row));
+            auto * decoded = reinterpret_cast<const std::uint8_t *>(aDecoded.row(row));
+            for (int column = 0; column != aReference.width(); ++column)
+            {
+                for (int channel = 0; channel != aChannels; ++channel)
+                {
+                    const double difference = reference[sizeof(T_pixel) * column + channel]
+                                            - decoded[sizeof(T_pixel) * column + channel];
+                    squaredErrors += difference * difference;
+                }
+            }
+        }
+        const double meanSquaredError = squaredErrors / (aReference.dimensions().area() * aChannels);
+        return 10. * std::log10(255. * 255. / meanSquaredError);
+    }
+
+
+} // anonymous namespace
+
+
+SCENARIO("Block compression")
+{
+    GIVEN("An opaque RGBA image, whose dimensions are not multiples of the block size")
+    {
+        const ImageRgb yacht{resource::pathFor("tests/Images/PPM/Yacht.512.ppm")};
+        const ImageRgba source{toOpaqueRgba(yacht).view({{0, 0}, {509, 478}})};
+
+        WHEN("It is compressed to Bc1")
+        {
+            CompressedImage compressed = compressBlocks(source, BlockFormat::Bc1);
+
+            THEN("Each block of 4x4 pixels takes 8 bytes")
+            {
+                CHECK(compressed.blockCounts() == math::Size<2, int>{128, 120});
+                CHECK(compressed.size_bytes() == 128 * 120 * 8);
+            }
+
+            THEN("The decoded image is close to the source")
+            {
+                CHECK(psnr(source, decompressBlocks<math::sdr::Rgba>(compressed), 3) > 32.);
+            }
+        }
+
+        WHEN("It is compressed to Bc3 and Bc7")
+        {
+            CompressedImage bc3 = compressBlocks(source, BlockFormat::Bc3);
+            CompressedImage bc7 = compressBlocks(source, BlockFormat::Bc7);
+
+            THEN("Each block takes 16 bytes")
+            {
+                CHECK(bc3.size_bytes() == 128 * 120 * 16);
+                CHECK(bc7.size_bytes() == 128 * 120 * 16);
+            }
+
+            THEN("The alpha is preserved, and Bc7 has a lower error")
+            {
+                ImageRgba decoded3 = decompressBlocks<math::sdr::Rgba>(bc3);
+                ImageRgba decoded7 = decompressBlocks<math::sdr::Rgba>(bc7);
+                CHECK(psnr(source, decoded3, 4) > 32.);
+                CHECK(psnr(source, decoded7, 4) > 36.);
+                CHECK(psnr(source, decoded7, 4) > psnr(source, decoded3, 4));
+            }
+
+            THEN("They cannot be decoded to a single channel image")
+            {
+                REQUIRE_THROWS(decompressBlocks<math::sdr::Grayscale>(bc7));
+            }
+        }
+
+        WHEN("It is compressed in parallel")
+        {
+            ThreadPool pool{4};
+            CompressedImage parallel = compressBlocks(source, BlockFormat::Bc7, Execution{pool, 3});
+
+            THEN("The blocks are the same as compressed serially")
+            {
+                CHECK(parallel.mBlocks == compressBlocks(source, BlockFormat::Bc7).mBlocks);
+            }
+        }
+    }
+
+    GIVEN("A grayscale image")
+    {
+        const Image<math::sdr::Grayscale> source =
+            toGrayscale(ImageRgb{resource::pathFor("tests/Images/PPM/Yacht.512.ppm")});
+
+        WHEN("It is compressed to Bc4")
+        {
+            CompressedImage compressed = compressBlocks(source);
+
+            THEN("The decoded image is close to the source")
+            {
+                CHECK(compressed.mFormat == BlockFormat::Bc4);
+                CHECK(compressed.size_bytes() == 128 * 120 * 8);
+                CHECK(psnr(source, decompressBlocks<math::sdr::Grayscale>(compressed), 1) > 40.);
+            }
+        }
+    }
+
+    GIVEN("A uniform translucent image")
+    {
+        ImageRgba source = ImageRgba::makeUninitialized({6, 6});
+        for (int row = 0; row != source.height(); ++row)
+        {
+            auto * channels = reinterpret_cast<std::uint8_t *>(source.row(row));
+            for (int column = 0; column != source.width(); ++column)
+            {
+                const std::uint8_t color[4]{30, 140, 255, 200};
+                std::memcpy(channels + 4 * column, color, 4);
+            }
+        }
+
+        THEN("Bc7 encodes it within a unit per channel")
+        {
+            // The endpoints share their least significant bit across channels, so not all colors are exact.
+            ImageRgba decoded = decompressBlocks<math::sdr::Rgba>(compressBlocks(source, BlockFormat::Bc7));
+            for (int row = 0; row != source.height(); ++row)
+            {
+                auto * expected = reinterpret_cast<const std::uint8_t *>(source.row(row));
+                auto * actual = reinterpret_cast<const std::uint8_t *>(decoded.row(row));
+                for (std::size_t i = 0; i != source.size_bytes_line(); ++i)
+                {
+                    REQUIRE(std::abs(expected[i] - actual[i]) <= 1);
+                }
+            }
+        }
+    }
+}
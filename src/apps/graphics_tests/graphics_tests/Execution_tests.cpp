@@ -0,0 +1,171 @@
+#include "catch.hpp"
+
+#include "FilesystemHelpers.h"
+
+#include <arte/Execution.h>
+#include <arte/Image.h>
+#include <arte/ImageConvolution.h>
+#include <arte/ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+template <class T_image>
+bool areIdentical(const T_image & aLhs, const T_image & aRhs)
+{
+    return aLhs.dimensions() == aRhs.dimensions()
+        && std::equal(aLhs.begin(), aLhs.end(), aRhs.begin(), aRhs.end());
+}
+
+
+SCENARIO("Thread pool")
+{
+    GIVEN("A thread pool")
+    {
+        ThreadPool pool{4};
+        REQUIRE(pool.size() == 4);
+
+        THEN("Pushed tasks provide their results through futures")
+        {
+            std::vector<std::future<int>> results;
+            for (int i = 0; i != 100; ++i)
+            {
+                results.push_back(pool.push([i](){ return i * i; }));
+            }
+            for (int i = 0; i != 100; ++i)
+            {
+                REQUIRE(results[i].get() == i * i);
+            }
+        }
+
+        THEN("Exceptions are transported by the futures")
+        {
+            auto result = pool.push([]() -> int { throw std::runtime_error{"task failure"}; });
+            REQUIRE_THROWS_AS(result.get(), std::runtime_error);
+        }
+    }
+}
+
+
+SCENARIO("Parallel execution of row bands")
+{
+    ThreadPool pool{4};
+
+    GIVEN("Parallel executions with automatic and explicit band heights")
+    {
+        auto requireEachRowOnce = [](const Execution & aExecution)
+        {
+            const int rowCount = 1001;
+            std::vector<std::atomic<int>> visits(rowCount);
+            aExecution.forEachBand(rowCount, [&](int aFirstRow, int aEndRow)
+            {
+                for (int row = aFirstRow; row != aEndRow; ++row)
+                {
+                    ++visits[row];
+                }
+            });
+            REQUIRE(std::all_of(visits.begin(), visits.end(), [](const auto & aCount){ return aCount == 1; }));
+        };
+
+        THEN("Each row is processed exactly once")
+        {
+            requireEachRowOnce(Execution{pool});
+            requireEachRowOnce(Execution{pool, 7});
+        }
+    }
+
+    GIVEN("An execution on a pool without workers")
+    {
+        ThreadPool empty{0};
+        Execution execution{empty};
+        REQUIRE_FALSE(execution.isParallel());
+
+        THEN("All the rows are processed on the calling thread")
+        {
+            const std::thread::id caller = std::this_thread::get_id();
+            int rows = 0;
+            execution.forEachBand(100, [&](int aFirstRow, int aEndRow)
+            {
+                REQUIRE(std::this_thread::get_id() == caller);
+                rows += aEndRow - aFirstRow;
+            });
+            REQUIRE(rows == 100);
+        }
+    }
+
+    GIVEN("A band throwing an exception")
+    {
+        Execution execution{pool, 10};
+        auto failing = [](int aFirstRow, int)
+        {
+            if (aFirstRow == 50)
+            {
+                throw std::runtime_error{"band failure"};
+            }
+        };
+
+        THEN("The exception is rethrown on the calling thread")
+        {
+            REQUIRE_THROWS_AS(execution.forEachBand(100, failing), std::runtime_error);
+        }
+    }
+
+    GIVEN("An execution invoked from within the pool workers")
+    {
+        ThreadPool single{1};
+        Execution execution{single, 1};
+
+        THEN("It completes, the calling worker processing the bands")
+        {
+            std::atomic<int> rows{0};
+            auto nested = single.push([&]()
+            {
+                execution.forEachBand(20, [&](int aFirstRow, int aEndRow){ rows += aEndRow - aFirstRow; });
+            });
+            nested.get();
+            REQUIRE(rows == 20);
+        }
+    }
+}
+
+
+SCENARIO("Parallel image operations")
+{
+    ThreadPool pool{4};
+    const Execution parallel{pool};
+
+    GIVEN("An image")
+    {
+        ImageRgb yacht{resource::pathFor("tests/Images/PPM/Yacht.512.ppm")};
+
+        THEN("Parallel conversions are identical to the serial ones")
+        {
+            REQUIRE(areIdentical(toGrayscale(yacht.view(), parallel), toGrayscale(yacht.view())));
+
+            Image<math::hdr::Rgb_f> hdr = to_hdr(yacht);
+            REQUIRE(areIdentical(to_hdr(yacht, parallel), hdr));
+            REQUIRE(areIdentical(tonemap(hdr, parallel), tonemap(hdr)));
+
+            ImageRgb decodedParallel = yacht;
+            ImageRgb decodedSerial = yacht;
+            REQUIRE(areIdentical(decodeSRGBToLinear(decodedParallel, parallel),
+                                 decodeSRGBToLinear(decodedSerial)));
+        }
+
+        THEN("Parallel resampling is identical to the serial one")
+        {
+            REQUIRE(areIdentical(resampleImage(yacht, {1000, 1000}, parallel),
+                                 resampleImage(yacht, {1000, 1000})));
+            REQUIRE(areIdentical(resampleImage(yacht, {123, 77}, parallel),
+                                 resampleImage(yacht, {123, 77})));
+        }
+    }
+}
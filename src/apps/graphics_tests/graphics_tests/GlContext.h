@@ -0,0 +1,20 @@
+#pragma once
+
+
+#include <graphics/ApplicationGlfw.h>
+
+#include <memory>
+
+
+#define INITIALIZE_GL_CONTEXT() \
+    std::unique_ptr<graphics::ApplicationGlfw> glApp; \
+    try \
+    { \
+        glApp = std::make_unique<graphics::ApplicationGlfw>("dummy", math::Size<2, int>{1, 1}); \
+    } \
+    catch (const std::exception &) \
+    { \
+        /* We are on a platform where we cannot obtain the GL context via Glfw, just pass. */ \
+        return; \
+    } \
+
@@ -0,0 +1,136 @@
+#include "catch.hpp"
+
+#include "FilesystemHelpers.h"
+
+#include <arte/detail/Json.h>
+#include <arte/gltf/Gltf.h>
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <variant>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+namespace {
+
+
+    /// \brief Write a glTF document with `aNodeCount` nodes, each with its own mesh and two accessors.
+    ///
+    /// The skins are written before the nodes, which they reference as joints.
+    filesystem::path writeGltf(const filesystem::path & aFile, std::size_t aNodeCount, bool aWithAccessors = true)
+    {
+        std::ofstream out{aFile.string()};
+        out << R"({"asset": {"version": "2.0", "extras": {"generator": "graphics_tests"}}, "scene": 0,)"
+            << R"("scenes": [{"name": "main", "nodes": [0]}],)"
+            << R"("skins": [{"name": "skeleton", "joints": [1, 2]}],)"
+            << R"("nodes": [)";
+        for (std::size_t i = 0; i != aNodeCount; ++i)
+        {
+            out << (i == 0 ? "" : ",")
+                << R"({"name": "node_)" << i << R"(", "mesh": )" << i
+                << R"(, "translation": [1.5, )" << i << R"(, -3.0])"
+                << (i + 1 < aNodeCount ? R"(, "children": [)" + std::to_string(i + 1) + "]" : "")
+                << "}";
+        }
+        out << R"(], "meshes": [)";
+        for (std::size_t i = 0; i != aNodeCount; ++i)
+        {
+            out << (i == 0 ? "" : ",")
+                << R"({"primitives": [{"attributes": {"POSITION": )" << 2 * i
+                << R"(}, "indices": )" << 2 * i + 1 << "}]}";
+        }
+        out << R"(], "buffers": [{"uri": "data.bin", "byteLength": 1024}],)"
+            << R"("bufferViews": [{"buffer": 0, "byteLength": 1024}])";
+        if (aWithAccessors)
+        {
+            out << R"(, "accessors": [)";
+            for (std::size_t i = 0; i != 2 * aNodeCount; ++i)
+            {
+                out << (i == 0 ? "" : ",")
+                    << R"({"bufferView": 0, "componentType": 5126, "count": )" << i
+                    << R"(, "type": "VEC3", "max": [1.0, 1.0, 1.0], "min": [-1.0, -1.0, -1.0]})";
+            }
+            out << "]";
+        }
+        out << "}";
+        return aFile;
+    }
+
+
+} // anonymous namespace
+
+
+SCENARIO("glTF loading")
+{
+    const filesystem::path folder = ensureTemporaryImageFolder("ad_graphics_tests_gltf");
+
+    GIVEN("A glTF document with many elements")
+    {
+        constexpr std::size_t nodeCount = 50;
+        const Gltf gltf{writeGltf(folder / "many.gltf", nodeCount)};
+
+        THEN("All elements of its top-level arrays are loaded, in order")
+        {
+            REQUIRE(gltf.countScenes() == 1);
+            REQUIRE(gltf.countNodes() == nodeCount);
+            REQUIRE(gltf.getMeshes().size() == nodeCount);
+
+            REQUIRE(gltf.getDefaultScene());
+            REQUIRE((*gltf.getDefaultScene())->name == "main");
+
+            const gltf::Node & node = *gltf.get(gltf::Index<gltf::Node>{7});
+            REQUIRE(node.name == "node_7");
+            REQUIRE(node.mesh);
+            REQUIRE(*node.mesh == 7u);
+            REQUIRE(node.children.size() == 1);
+            REQUIRE(node.children[0] == 8u);
+            REQUIRE(std::get<gltf::Node::TRS>(node.transformation).translation.y() == 7.f);
+
+            REQUIRE(gltf.get(gltf::Index<gltf::Accessor>{2 * nodeCount - 1})->count == 2 * nodeCount - 1);
+            REQUIRE(gltf.get(gltf::Index<gltf::Mesh>{3})->primitives.at(0).indices == 7u);
+        }
+
+        THEN("Joint nodes are marked, even though the skins precede the nodes in the document")
+        {
+            REQUIRE_FALSE(gltf.get(gltf::Index<gltf::Node>{0})->usedAsJoint);
+            REQUIRE(gltf.get(gltf::Index<gltf::Node>{1})->usedAsJoint);
+            REQUIRE(gltf.get(gltf::Index<gltf::Node>{2})->usedAsJoint);
+            REQUIRE_FALSE(gltf.get(gltf::Index<gltf::Node>{3})->usedAsJoint);
+        }
+    }
+
+    GIVEN("A glTF document missing a required array")
+    {
+        const filesystem::path file = writeGltf(folder / "missing.gltf", 3, false);
+
+        THEN("Loading throws")
+        {
+            REQUIRE_THROWS(Gltf{file});
+        }
+    }
+}
+
+
+// Hidden by default, run with `graphics_tests [.benchmark]`
+TEST_CASE("Parsing a large glTF document", "[.benchmark]")
+{
+    const filesystem::path file =
+        writeGltf(ensureTemporaryImageFolder("ad_graphics_tests_gltf") / "large.gltf", 100'000);
+
+    BENCHMARK("Materializing the whole document DOM (without loading the elements)")
+    {
+        std::ifstream input{file.string()};
+        Json document;
+        input >> document;
+        return document.size();
+    };
+
+    BENCHMARK("Loading the elements while parsing")
+    {
+        return Gltf{file}.countNodes();
+    };
+}
@@ -5,6 +5,10 @@
 #include <arte/Image.h>
 #include <arte/ImageConvolution.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <fstream>
 
 
@@ -28,3 +32,149 @@ SCENARIO("Image resampling")
         }
     }
 }
+
+
+namespace {
+
+
+    // Direct evaluation of the filter for each tap of each output pixel, as reference.
+    template <class T_pixelFormat, class T_filter>
+    Image<T_pixelFormat> resampleReference(const Image<T_pixelFormat> & aInput,
+                                           math::Size<2, int> aOutputResolution,
+                                           T_filter aFilter)
+    {
+        const float r = aFilter.mRadius;
+        const float deltaX = (float)aInput.width() / (float)aOutputResolution.width();
+        const float deltaY = (float)aInput.height() / (float)aOutputResolution.height();
+
+        auto intermediary = Image<T_pixelFormat>::makeUninitialized({aOutputResolution.width(), aInput.height()});
+        for (int i = 0; i != aInput.height(); ++i)
+        {
+            for (std::size_t j = 0; j != (std::size_t)aOutputResolution.width(); ++j)
+            {
+                float x = -0.5f + deltaX/2 + j * deltaX;
+                T_pixelFormat accumulator{};
+                for (int k = (int)std::ceil(x - r); k <= std::floor(x + r); ++k)
+                {
+                    accumulator += aInput.at(std::clamp(k, 0, aInput.width() - 1), i) * aFilter(x - k);
+                }
+                intermediary.at(j, i) = accumulator;
+            }
+        }
+
+        auto output = Image<T_pixelFormat>::makeUninitialized(aOutputResolution);
+        for (int j = 0; j != aOutputResolution.width(); ++j)
+        {
+            for (std::size_t i = 0; i != (std::size_t)aOutputResolution.height(); ++i)
+            {
+                float y = -0.5f + deltaY/2 + i * deltaY;
+                T_pixelFormat accumulator{};
+                for (int k = (int)std::ceil(y - r); k <= std::floor(y + r); ++k)
+                {
+                    accumulator += intermediary.at(j, std::clamp(k, 0, aInput.height() - 1)) * aFilter(y - k);
+                }
+                output.at(j, i) = accumulator;
+            }
+        }
+        return output;
+    }
+
+
+} // anonymous namespace
+
+
+SCENARIO("Separable resampling with precomputed weights")
+{
+    GIVEN("An HDR image")
+    {
+        Image<math::hdr::Rgb_f> yacht = to_hdr(ImageRgb{resource::pathFor("tests/Images/PPM/Yacht.512.ppm")});
+        Filter filter{.mFilterFunc = [](float x){return catmullRom(x);}, .mRadius = 2.};
+
+        auto requireMatchesReference = [&](math::Size<2, int> aResolution)
+        {
+            Image<math::hdr::Rgb_f> resampled = resampleSeparable2D(yacht, aResolution, filter);
+            Image<math::hdr::Rgb_f> reference = resampleReference(yacht, aResolution, filter);
+            REQUIRE(resampled.dimensions() == aResolution);
+            REQUIRE(std::equal(resampled.begin(), resampled.end(), reference.begin(), reference.end()));
+        };
+
+        THEN("Upsampling matches the direct evaluation of the filter")
+        {
+            requireMatchesReference({1000, 700});
+        }
+
+        THEN("Downsampling matches the direct evaluation of the filter")
+        {
+            requireMatchesReference({123, 77});
+        }
+    }
+}
+
+
+SCENARIO("Fixed-point resampling of SDR images")
+{
+    GIVEN("An SDR image")
+    {
+        ImageRgb yacht{resource::pathFor("tests/Images/PPM/Yacht.512.ppm")};
+
+        auto requireCloseToFloatPath = [&](math::Size<2, int> aResolution, auto aFilter)
+        {
+            ImageRgb fixedPoint = resampleSeparable2DFixedPoint(yacht, aResolution, aFilter);
+            ImageRgb floatPath = tonemap(resampleSeparable2D(to_hdr(yacht), aResolution, aFilter));
+
+            REQUIRE(fixedPoint.dimensions() == aResolution);
+            auto channelDifference = [](std::uint8_t aLhs, std::uint8_t aRhs){ return std::abs(aLhs - aRhs); };
+            for (int row = 0; row != fixedPoint.height(); ++row)
+            {
+                auto fixedChannels = reinterpret_cast<const std::uint8_t *>(fixedPoint.row(row));
+                auto floatChannels = reinterpret_cast<const std::uint8_t *>(floatPath.row(row));
+                for (std::size_t i = 0; i != fixedPoint.size_bytes_line(); ++i)
+                {
+                    REQUIRE(channelDifference(fixedChannels[i], floatChannels[i]) <= 1);
+                }
+            }
+        };
+
+        Filter catmull{.mFilterFunc = [](float x){return catmullRom(x);}, .mRadius = 2.};
+        Filter gauss{.mFilterFunc = [](float x){return gaussian(x, 0.8f, 1.f);}, .mRadius = 2.5};
+
+        THEN("Upsampling is within 1 of the float path")
+        {
+            requireCloseToFloatPath({1000, 700}, catmull);
+            requireCloseToFloatPath({1000, 700}, gauss);
+        }
+
+        THEN("Downsampling is within 1 of the float path")
+        {
+            requireCloseToFloatPath({123, 77}, catmull);
+            requireCloseToFloatPath({123, 77}, gauss);
+        }
+    }
+}
+
+
+// Hidden by default, run with `graphics_tests [.benchmark]`
+TEST_CASE("Resampling paths on a 4K RGBA image", "[.benchmark]")
+{
+    auto image = ImageRgba::makeUninitialized({3840, 2160});
+    for (int row = 0; row != image.height(); ++row)
+    {
+        auto channels = reinterpret_cast<std::uint8_t *>(image.row(row));
+        for (std::size_t i = 0; i != image.size_bytes_line(); ++i)
+        {
+            // Smooth gradients, with a discontinuity every 64 columns
+            channels[i] = static_cast<std::uint8_t>((row + i / 4 % 64 * 3 + i % 4 * 50) % 256);
+        }
+    }
+    Filter catmull{.mFilterFunc = [](float x){return catmullRom(x);}, .mRadius = 2.};
+
+    BENCHMARK("Float path, downsampling to 1080p")
+    {
+        return tonemap(resampleSeparable2D(to_hdr(image), {1920, 1080}, catmull));
+    };
+
+    BENCHMARK("Fixed-point, downsampling to 1080p")
+    {
+        return resampleSeparable2DFixedPoint(image, {1920, 1080}, catmull);
+    };
+}
@@ -0,0 +1,139 @@
+#include "catch.hpp"
+
+#include "FilesystemHelpers.h"
+
+#include <arte/Image.h>
+#include <arte/ImageLoader.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <optional>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+template <class T_image>
+void requireSameImage(const T_image & aLhs, const T_image & aRhs)
+{
+    REQUIRE(aLhs.dimensions() == aRhs.dimensions());
+    REQUIRE(std::equal(aLhs.begin(), aLhs.end(), aRhs.begin(), aRhs.end()));
+}
+
+
+SCENARIO("Loading images concurrently")
+{
+    const std::vector<filesystem::path> imageFiles{
+        resource::pathFor("tests/Images/PPM/Yacht.512.ppm"),
+        resource::pathFor("tests/Images/PPM/Phoenix.512.ppm"),
+        resource::pathFor("tests/Images/PNG/ColorCheck.png"),
+        resource::pathFor("tests/Images/JPEG/Lion_Afrique.jpg"),
+    };
+
+    GIVEN("An image loader with the default budget")
+    {
+        ImageLoader loader;
+
+        WHEN("A batch of images is loaded")
+        {
+            auto futures = loader.loadAll<math::sdr::Rgba>(imageFiles, ImageOrientation::InvertVerticalAxis);
+
+            THEN("Each image is identical to the image loaded serially")
+            {
+                REQUIRE(futures.size() == imageFiles.size());
+                for (std::size_t i = 0; i != imageFiles.size(); ++i)
+                {
+                    requireSameImage(futures[i].get().take(),
+                                     ImageRgba::LoadFile(imageFiles[i], ImageOrientation::InvertVerticalAxis));
+                }
+            }
+        }
+
+        WHEN("An image is loaded from a stream")
+        {
+            std::ifstream input{imageFiles[2].string(), std::ios_base::in | std::ios_base::binary};
+            auto future = loader.load<math::sdr::Rgba>(input);
+
+            THEN("Its format is detected from the content")
+            {
+                requireSameImage(future.get().take(), ImageRgba::LoadFile(imageFiles[2]));
+            }
+        }
+
+        WHEN("A missing file is loaded")
+        {
+            auto future = loader.load<math::sdr::Rgb>(filesystem::path{"missing_image.ppm"});
+
+            THEN("The exception is provided by the future")
+            {
+                REQUIRE_THROWS(future.get());
+            }
+        }
+    }
+
+    GIVEN("An image loader on an external pool, with a budget smaller than any image")
+    {
+        ThreadPool pool{3};
+        ImageLoader loader{pool, 1};
+        REQUIRE(loader.maxInFlightBytes() == 1);
+
+        WHEN("A batch of images is loaded")
+        {
+            auto futures = loader.loadAll<math::sdr::Rgb>(imageFiles);
+
+            THEN("The images are decoded one at a time, and all complete")
+            {
+                for (std::size_t i = 0; i != imageFiles.size(); ++i)
+                {
+                    requireSameImage(futures[i].get().take(), ImageRgb::LoadFile(imageFiles[i]));
+                }
+            }
+        }
+
+        WHEN("A decoded image is kept in its LoadedImage")
+        {
+            auto futures = loader.loadAll<math::sdr::Rgb>(imageFiles);
+            LoadedImage<math::sdr::Rgb> first = futures[0].get();
+
+            THEN("The next image is not decoded until the first is taken")
+            {
+                REQUIRE(futures[1].wait_for(std::chrono::milliseconds{50}) == std::future_status::timeout);
+
+                requireSameImage(first.take(), ImageRgb::LoadFile(imageFiles[0]));
+                requireSameImage(futures[1].get().take(), ImageRgb::LoadFile(imageFiles[1]));
+            }
+
+            THEN("The waiting loads do not occupy the pool workers")
+            {
+                REQUIRE(pool.push([](){ return 42; }).get() == 42);
+            }
+        }
+    }
+
+    GIVEN("An image loader on a single worker pool, with a budget smaller than any image")
+    {
+        ThreadPool pool{1};
+        std::future<LoadedImage<math::sdr::Rgb>> waiting;
+        std::optional<LoadedImage<math::sdr::Rgb>> first;
+
+        WHEN("The loader is destroyed while a load waits for budget")
+        {
+            {
+                ImageLoader loader{pool, 1};
+                std::future<LoadedImage<math::sdr::Rgb>> firstFuture = loader.load<math::sdr::Rgb>(imageFiles[0]);
+                waiting = loader.load<math::sdr::Rgb>(imageFiles[1]);
+                first.emplace(firstFuture.get());
+            }
+
+            THEN("The decoded image is still valid, and the waiting load is abandoned")
+            {
+                requireSameImage(first->take(), ImageRgb::LoadFile(imageFiles[0]));
+                REQUIRE_THROWS_AS(waiting.get(), std::future_error);
+            }
+        }
+    }
+}
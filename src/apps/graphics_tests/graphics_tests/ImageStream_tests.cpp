@@ -0,0 +1,167 @@
+#include "catch.hpp"
+
+#include "FilesystemHelpers.h"
+
+#include <arte/Image.h>
+#include <arte/ImageConvolution.h>
+#include <arte/ImageStream.h>
+
+#include <algorithm>
+#include <sstream>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+template <class T_pixel>
+bool haveSamePixels(ImageView<const T_pixel> aLhs, ImageView<const T_pixel> aRhs)
+{
+    if (aLhs.dimensions() != aRhs.dimensions())
+    {
+        return false;
+    }
+    for (int row = 0; row != aLhs.height(); ++row)
+    {
+        if (!std::equal(aLhs.row(row), aLhs.row(row) + aLhs.width(), aRhs.row(row)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+SCENARIO("Reading and writing images by bands of rows")
+{
+    const filesystem::path yachtPath = resource::pathFor("tests/Images/PPM/Yacht.512.ppm");
+    const ImageRgb yacht{yachtPath};
+
+    GIVEN("A band reader on a PPM file")
+    {
+        BandReaderRgb reader{yachtPath};
+        REQUIRE(reader.dimensions() == yacht.dimensions());
+
+        THEN("The bands cover all the rows of the image, in order")
+        {
+            int expectedFirstRow = 0;
+            readBands(reader, 37, [&](ImageView<const math::sdr::Rgb> aBand, int aFirstRow)
+            {
+                REQUIRE(aFirstRow == expectedFirstRow);
+                REQUIRE(aBand.height() == std::min(37, yacht.height() - aFirstRow));
+                REQUIRE(haveSamePixels(aBand, yacht.view({{0, aFirstRow}, aBand.dimensions()})));
+                expectedFirstRow += aBand.height();
+            });
+            REQUIRE(expectedFirstRow == yacht.height());
+            REQUIRE(reader.done());
+            REQUIRE(reader.read(10).empty());
+        }
+
+        THEN("Bands without rows are rejected, instead of never advancing")
+        {
+            REQUIRE_THROWS_AS(reader.read(0), std::invalid_argument);
+            REQUIRE_THROWS_AS(readBands(reader, -1, [](ImageView<const math::sdr::Rgb>, int){}),
+                              std::invalid_argument);
+            REQUIRE(reader.nextRow() == 0);
+        }
+    }
+
+    GIVEN("A band reader on a PNG file")
+    {
+        const filesystem::path pngPath = resource::pathFor("tests/Images/PNG/ColorCheck.png");
+        const ImageRgba expected{pngPath};
+        BandReader<math::sdr::Rgba> reader{pngPath};
+
+        THEN("The bands are views in the decoded image")
+        {
+            readBands(reader, 5, [&](ImageView<const math::sdr::Rgba> aBand, int aFirstRow)
+            {
+                REQUIRE(haveSamePixels(aBand, expected.view({{0, aFirstRow}, aBand.dimensions()})));
+            });
+            REQUIRE(reader.done());
+        }
+    }
+
+    GIVEN("A band writer to a PPM stream")
+    {
+        std::stringstream buffer;
+        BandWriterRgb writer{buffer, ImageFormat::Ppm, yacht.dimensions()};
+
+        WHEN("The rows are written in bands of varying heights")
+        {
+            for (int row = 0, band = 1; row != yacht.height(); band *= 2)
+            {
+                const int rows = std::min(band, yacht.height() - row);
+                writer.write(yacht.view({{0, row}, {yacht.width(), rows}}));
+                row += rows;
+            }
+
+            THEN("The stream contains the same PPM as the image writer produces")
+            {
+                REQUIRE(writer.done());
+                std::stringstream reference;
+                yacht.write(ImageFormat::Ppm, reference);
+                REQUIRE(buffer.str() == reference.str());
+            }
+
+            THEN("Writing more rows throws")
+            {
+                REQUIRE_THROWS_AS(writer.write(yacht.view({{0, 0}, {yacht.width(), 1}})), std::out_of_range);
+            }
+        }
+    }
+}
+
+
+SCENARIO("Bounded memory pipelines")
+{
+    const filesystem::path yachtPath = resource::pathFor("tests/Images/PPM/Yacht.512.ppm");
+    const ImageRgb yacht{yachtPath};
+
+    GIVEN("A grayscale conversion stage between a band reader and a band writer")
+    {
+        BandReaderRgb reader{yachtPath};
+        std::stringstream output;
+        BandWriter<math::sdr::Grayscale> writer{output, ImageFormat::Pgm, reader.dimensions()};
+
+        readBands(reader, 64, [&](ImageView<const math::sdr::Rgb> aBand, int)
+        {
+            writer.write(toGrayscale(aBand));
+        });
+
+        THEN("The result is the conversion of the whole image")
+        {
+            REQUIRE(haveSamePixels<math::sdr::Grayscale>(
+                Image<math::sdr::Grayscale>::Read(ImageFormat::Pgm, output),
+                toGrayscale(yacht.view())));
+        }
+    }
+
+    GIVEN("A resampling stage between a band reader and a band writer")
+    {
+        const math::Size<2, int> outputResolution{300, 700};
+        Filter filter{.mFilterFunc = [](float x){ return catmullRom(x); }, .mRadius = 2.f};
+
+        BandReaderRgb reader{yachtPath};
+        BandResampler<math::hdr::Rgb_f> resampler{reader.dimensions(), outputResolution, filter};
+        std::stringstream output;
+        BandWriterRgb writer{output, ImageFormat::Ppm, outputResolution};
+
+        readBands(reader, 50, [&](ImageView<const math::sdr::Rgb> aBand, int)
+        {
+            resampler.push(to_hdr(aBand), [&](ImageView<const math::hdr::Rgb_f> aRows, int)
+            {
+                writer.write(tonemap(aRows));
+            });
+        });
+
+        THEN("The result is identical to resampling the whole image")
+        {
+            REQUIRE(resampler.done());
+            REQUIRE(writer.done());
+            REQUIRE(haveSamePixels<math::sdr::Rgb>(
+                ImageRgb::Read(ImageFormat::Ppm, output),
+                tonemap(resampleSeparable2D(to_hdr(yacht), outputResolution, filter))));
+        }
+    }
+}
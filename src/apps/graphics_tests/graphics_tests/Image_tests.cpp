@@ -4,7 +4,10 @@
 
 #include <arte/Image.h>
 
+#include <cmath>
 #include <fstream>
+#include <sstream>
+#include <string>
 
 
 using namespace ad;
@@ -170,6 +173,133 @@ SCENARIO("Image manipulations")
 }
 
 
+SCENARIO("Image rows alignment")
+{
+    GIVEN("An RGB image whose rows are aligned to 64 bytes")
+    {
+        constexpr std::size_t alignment = 64;
+        ImageRgb aligned{math::Size<2, int>{7, 5}, Green, alignment};
+
+        THEN("Each row starts on an aligned address")
+        {
+            REQUIRE(aligned.rowAlignment() == alignment);
+            REQUIRE(aligned.stride_bytes() == alignment);
+            REQUIRE_FALSE(aligned.isContiguous());
+            REQUIRE(aligned.size_bytes() == alignment * 5);
+            for (int row = 0; row != aligned.height(); ++row)
+            {
+                REQUIRE(reinterpret_cast<std::uintptr_t>(aligned.row(row)) % alignment == 0);
+            }
+        }
+
+        THEN("All pixels are initialized to the background value")
+        {
+            for (int row = 0; row != aligned.height(); ++row)
+            {
+                REQUIRE(std::all_of(aligned.row(row), aligned.row(row) + aligned.width(),
+                                    [&](auto pixel){ return pixel == Green; }));
+            }
+        }
+
+        WHEN("A pixel is modified")
+        {
+            aligned.at(6, 4) = Red;
+            aligned[0][1] = Blue;
+
+            THEN("The modification is visible at the same coordinates via a view")
+            {
+                REQUIRE(aligned.view().at(6, 4) == Red);
+                REQUIRE(aligned.view().at(0, 1) == Blue);
+                REQUIRE(aligned.view().at(1, 1) == Green);
+            }
+
+            THEN("A copy preserves the layout and the pixels")
+            {
+                ImageRgb copy{aligned};
+                REQUIRE(copy.stride_bytes() == aligned.stride_bytes());
+                REQUIRE(copy.at(6, 4) == Red);
+                REQUIRE(copy.at(0, 1) == Blue);
+            }
+
+            THEN("It can be written and read back")
+            {
+                std::stringstream buffer;
+                aligned.write(ImageFormat::Ppm, buffer);
+                ImageRgb readBack = ImageRgb::Read(ImageFormat::Ppm, buffer);
+                REQUIRE(readBack.isContiguous());
+                requireImagesEquality(readBack, ImageRgb{aligned.view()});
+            }
+        }
+    }
+
+    GIVEN("Images decoded by stb_image, which allocates their rasters")
+    {
+        const ImageRgba png{resource::pathFor("tests/Images/PNG/ColorCheck.png")};
+        const ImageRgb jpeg{resource::pathFor("tests/Images/JPEG/Lion_Afrique.jpg")};
+
+        THEN("Their rasters are aligned like the rasters allocated by Image")
+        {
+            REQUIRE(reinterpret_cast<std::uintptr_t>(png.data()) % gRasterAlignment == 0);
+            REQUIRE(reinterpret_cast<std::uintptr_t>(jpeg.data()) % gRasterAlignment == 0);
+        }
+    }
+}
+
+
+SCENARIO("Image views")
+{
+    GIVEN("An image with distinct pixel values")
+    {
+        ImageRgb image{math::Size<2, int>{8, 6}, Red};
+        for (int row = 0; row != image.height(); ++row)
+        {
+            for (int column = 0; column != image.width(); ++column)
+            {
+                image.at(column, row) = math::sdr::Rgb{(std::uint8_t)column, (std::uint8_t)row, 0};
+            }
+        }
+
+        WHEN("A view on a sub-rectangle is obtained")
+        {
+            ImageView<const math::sdr::Rgb> view = image.view({{2, 1}, {4, 3}});
+
+            THEN("It addresses the pixels of the image, without copy")
+            {
+                REQUIRE(view.dimensions() == math::Size<2, int>{4, 3});
+                REQUIRE(view.data() == &image.at(2, 1));
+                REQUIRE(view.stride_bytes() == image.size_bytes_line());
+                REQUIRE_FALSE(view.isContiguous());
+                REQUIRE(view.at(0, 0) == image.at(2, 1));
+                REQUIRE(view.at(3, 2) == image.at(5, 3));
+            }
+
+            THEN("It gives the same pixels as a crop")
+            {
+                ImageRgb cropped = image.crop({{2, 1}, {4, 3}});
+                requireImagesEquality(ImageRgb{view}, cropped);
+            }
+
+            THEN("It can be pasted into another image")
+            {
+                ImageRgb destination{math::Size<2, int>{4, 6}, Blue};
+                destination.pasteFrom(view, {0, 3});
+                REQUIRE(destination.at(0, 0) == Blue);
+                REQUIRE(destination.at(3, 2) == Blue);
+                REQUIRE(destination.at(0, 3) == image.at(2, 1));
+                REQUIRE(destination.at(3, 5) == image.at(5, 3));
+            }
+
+            THEN("It can be written and read back")
+            {
+                std::stringstream buffer;
+                write(view, ImageFormat::Ppm, buffer);
+                requireImagesEquality(ImageRgb::Read(ImageFormat::Ppm, buffer), ImageRgb{view});
+            }
+        }
+    }
+}
+
+
 SCENARIO("Image files creation, read, write")
 {
     filesystem::path tempFolder = ensureTemporaryImageFolder("ad_graphics_tests_image");
@@ -268,6 +398,340 @@ SCENARIO("Image files creation, read, write")
 }
 
 
+SCENARIO("PNG encoding")
+{
+    GIVEN("An RGB image")
+    {
+        const ImageRgb yacht{resource::pathFor("tests/Images/PPM/Yacht.512.ppm")};
+
+        WHEN("It is written as PNG at different compression levels")
+        {
+            std::stringstream stored;
+            yacht.write(ImageFormat::Png, stored, ImageOrientation::Unchanged, {.mCompressionLevel = 0});
+            std::stringstream fast;
+            yacht.write(ImageFormat::Png, fast, ImageOrientation::Unchanged, {.mCompressionLevel = 1});
+            std::stringstream small;
+            yacht.write(ImageFormat::Png, small, ImageOrientation::Unchanged, {.mCompressionLevel = 9});
+
+            THEN("Each is read back losslessly")
+            {
+                requireImagesEquality(ImageRgb::Read(ImageFormat::Png, stored), yacht);
+                requireImagesEquality(ImageRgb::Read(ImageFormat::Png, fast), yacht);
+                requireImagesEquality(ImageRgb::Read(ImageFormat::Png, small), yacht);
+            }
+
+            THEN("Higher levels produce smaller outputs")
+            {
+                REQUIRE(stored.str().size() > yacht.size_bytes());
+                REQUIRE(fast.str().size() < stored.str().size());
+                REQUIRE(small.str().size() <= fast.str().size());
+            }
+        }
+
+        WHEN("It is written as PNG with a parallel execution")
+        {
+            ThreadPool pool{4};
+            std::stringstream parallel;
+            yacht.write(ImageFormat::Png, parallel, ImageOrientation::InvertVerticalAxis,
+                        {.mExecution = Execution{pool, 16}});
+            std::stringstream serial;
+            yacht.write(ImageFormat::Png, serial, ImageOrientation::InvertVerticalAxis);
+
+            THEN("The output is identical to the serial output")
+            {
+                REQUIRE(parallel.str() == serial.str());
+            }
+
+            THEN("It is read back with the requested orientation")
+            {
+                requireImagesEquality(ImageRgb::Read(ImageFormat::Png, parallel, ImageOrientation::InvertVerticalAxis),
+                                      yacht);
+            }
+        }
+    }
+
+    GIVEN("A grayscale view on a sub-rectangle")
+    {
+        const Image<math::sdr::Grayscale> gray = toGrayscale(ImageRgb{resource::pathFor("tests/Images/PPM/Yacht.512.ppm")});
+        const Image<math::sdr::Grayscale> expected{gray.view({{13, 7}, {101, 55}})};
+
+        THEN("Its PNG encoding is read back losslessly")
+        {
+            std::stringstream png;
+            write(gray.view({{13, 7}, {101, 55}}), ImageFormat::Png, png);
+            requireImagesEquality(Image<math::sdr::Grayscale>::Read(ImageFormat::Png, png), expected);
+        }
+    }
+}
+
+
+SCENARIO("QOI images")
+{
+    GIVEN("An RGBA image with transparency")
+    {
+        ImageRgba source{resource::pathFor("tests/Images/PNG/ColorCheck.png")};
+        const ImageRgba transparent{{5, 3}, math::sdr::gTransparent};
+        source.pasteFrom(transparent, {1, 2});
+
+        WHEN("It is written as QOI")
+        {
+            std::stringstream qoi;
+            source.write(ImageFormat::Qoi, qoi);
+
+            THEN("It is read back losslessly")
+            {
+                requireImagesEquality(ImageRgba::Read(ImageFormat::Qoi, qoi), source);
+            }
+
+            THEN("It is read back as RGB, dropping the alpha channel")
+            {
+                ImageRgb rgb = ImageRgb::Read(ImageFormat::Qoi, qoi);
+                REQUIRE(rgb.dimensions() == source.dimensions());
+                REQUIRE(rgb.at(3, 3).r() == source.at(3, 3).r());
+                REQUIRE(rgb.at(3, 3).b() == source.at(3, 3).b());
+            }
+
+            THEN("Probing returns its properties")
+            {
+                ImageProbe probe = probeImage(qoi);
+                REQUIRE(probe.mFormat == ImageFormat::Qoi);
+                REQUIRE(probe.mChannels == 4);
+                REQUIRE(probe.mDimensions == source.dimensions());
+            }
+        }
+    }
+
+    GIVEN("An RGB image")
+    {
+        ImageRgb yacht{resource::pathFor("tests/Images/PPM/Yacht.512.ppm")};
+
+        WHEN("It is written as QOI with an inverted vertical axis")
+        {
+            std::stringstream qoi;
+            yacht.write(ImageFormat::Qoi, qoi, ImageOrientation::InvertVerticalAxis);
+
+            THEN("Reading it with an inverted vertical axis restores the image")
+            {
+                requireImagesEquality(ImageRgb::Read(ImageFormat::Qoi, qoi, ImageOrientation::InvertVerticalAxis),
+                                      yacht);
+            }
+
+            THEN("The stream content is smaller than the raw pixels")
+            {
+                REQUIRE(qoi.str().size() < yacht.size_bytes());
+            }
+        }
+    }
+
+    GIVEN("A QOI content written by hand, as a reference encoder would")
+    {
+        // 2x1 RGBA, sRGB with linear alpha.
+        std::string content{'q', 'o', 'i', 'f', 0, 0, 0, 2, 0, 0, 0, 1, 4, 0};
+        // Transparent black is found at the index start, which is zeroed: QOI_OP_INDEX 0.
+        content.push_back('\x00');
+        // QOI_OP_RGB keeps the alpha of the previous pixel.
+        content.append({'\xFE', 10, 20, 30});
+        content.append({0, 0, 0, 0, 0, 0, 0, 1});
+
+        THEN("It is decoded as specified")
+        {
+            std::stringstream qoi{content};
+            const ImageRgba decoded = ImageRgba::Read(ImageFormat::Qoi, qoi);
+            REQUIRE(decoded.dimensions() == math::Size<2, int>{2, 1});
+            REQUIRE(decoded.at(0, 0) == math::sdr::Rgba{0, 0, 0, 0});
+            REQUIRE(decoded.at(1, 0) == math::sdr::Rgba{10, 20, 30, 0});
+        }
+
+        THEN("A transparent black pixel is encoded to the same bytes")
+        {
+            std::stringstream qoi;
+            ImageRgba{{1, 1}, math::sdr::Rgba{0, 0, 0, 0}}.write(ImageFormat::Qoi, qoi);
+
+            std::string expected{'q', 'o', 'i', 'f', 0, 0, 0, 1, 0, 0, 0, 1, 4, 0};
+            expected.push_back('\x00');
+            expected.append({0, 0, 0, 0, 0, 0, 0, 1});
+            REQUIRE(qoi.str() == expected);
+        }
+    }
+
+    GIVEN("A truncated QOI content")
+    {
+        std::stringstream qoi;
+        ImageRgb{{16, 16}, Red}.write(ImageFormat::Qoi, qoi);
+        std::stringstream truncated{qoi.str().substr(0, 10)};
+
+        THEN("Reading throws")
+        {
+            REQUIRE_THROWS_AS(ImageRgb::Read(ImageFormat::Qoi, truncated), std::runtime_error);
+        }
+    }
+}
+
+
+SCENARIO("Image probing")
+{
+    GIVEN("Image files in different formats")
+    {
+        const filesystem::path ppmPath = resource::pathFor("tests/Images/PPM/Yacht.512.ppm");
+        const filesystem::path pngPath = resource::pathFor("tests/Images/PNG/ColorCheck.png");
+        const filesystem::path jpegPath = resource::pathFor("tests/Images/JPEG/Lion_Afrique.jpg");
+
+        THEN("Probing returns the format and the dimensions of the decoded images")
+        {
+            ImageProbe ppm = probeImage(ppmPath);
+            REQUIRE(ppm.mFormat == ImageFormat::Ppm);
+            REQUIRE(ppm.mChannels == 3);
+            REQUIRE(ppm.mDimensions == ImageRgb{ppmPath}.dimensions());
+
+            ImageProbe png = probeImage(pngPath);
+            REQUIRE(png.mFormat == ImageFormat::Png);
+            REQUIRE(png.mDimensions == ImageRgba{pngPath}.dimensions());
+
+            ImageProbe jpeg = probeImage(jpegPath);
+            REQUIRE(jpeg.mFormat == ImageFormat::Jpg);
+            REQUIRE(jpeg.mChannels == 3);
+            REQUIRE(jpeg.mDimensions == ImageRgb{jpegPath}.dimensions());
+        }
+    }
+
+    GIVEN("Images written to streams")
+    {
+        Image<math::sdr::Grayscale> gray{{33, 7}, math::sdr::Grayscale{127}};
+        Image<math::hdr::Rgb_f> hdr = to_hdr(ImageRgb{{20, 10}, Red});
+
+        std::stringstream pgm;
+        gray.write(ImageFormat::Pgm, pgm);
+        std::stringstream bmp;
+        gray.write(ImageFormat::Bmp, bmp);
+        std::stringstream radiance;
+        hdr.write(ImageFormat::Hdr, radiance);
+
+        THEN("The format is detected from the content")
+        {
+            ImageProbe pgmProbe = probeImage(pgm);
+            REQUIRE(pgmProbe.mFormat == ImageFormat::Pgm);
+            REQUIRE(pgmProbe.mChannels == 1);
+            REQUIRE(pgmProbe.mDimensions == gray.dimensions());
+
+            ImageProbe bmpProbe = probeImage(bmp);
+            REQUIRE(bmpProbe.mFormat == ImageFormat::Bmp);
+            REQUIRE(bmpProbe.mDimensions == gray.dimensions());
+
+            ImageProbe hdrProbe = probeImage(radiance);
+            REQUIRE(hdrProbe.mFormat == ImageFormat::Hdr);
+            REQUIRE(hdrProbe.mChannels == 3);
+            REQUIRE(hdrProbe.mDimensions == hdr.dimensions());
+        }
+    }
+
+    GIVEN("A stream which is not an image")
+    {
+        std::stringstream text{"Not an image"};
+
+        THEN("Probing throws")
+        {
+            REQUIRE_THROWS_AS(probeImage(text), std::runtime_error);
+        }
+    }
+}
+
+
+SCENARIO("Half-float images")
+{
+    GIVEN("Half-float values")
+    {
+        THEN("They round to nearest, and overflow to infinity above the largest half")
+        {
+            REQUIRE(float(Half{1.f}) == 1.f);
+            REQUIRE(float(Half{65504.f}) == 65504.f);
+            REQUIRE(std::isinf(float(Half{65520.f})));
+            REQUIRE(std::abs(float(Half{1.f / 3.f}) - 1.f / 3.f) <= 1.f / 4096.f);
+            // The smallest subnormal
+            REQUIRE(float(Half::FromBits(0x0001)) == std::ldexp(1.f, -24));
+        }
+    }
+
+    GIVEN("An SDR image")
+    {
+        ImageRgb yacht{resource::pathFor("tests/Images/PPM/Yacht.512.ppm")};
+
+        WHEN("It is converted to half-float HDR")
+        {
+            Image<Rgb_h> half = to_hdr<Half>(yacht);
+
+            THEN("It takes half the memory of the float HDR image")
+            {
+                REQUIRE(half.dimensions() == yacht.dimensions());
+                REQUIRE(half.size_bytes() * 2 == to_hdr<float>(yacht).size_bytes());
+            }
+
+            THEN("Tonemapping it restores the SDR image")
+            {
+                requireImagesEquality(tonemap(half), yacht);
+            }
+
+            THEN("Its channels are within the half-float precision of the float HDR image")
+            {
+                Image<math::hdr::Rgb_f> widened = to_float(half);
+                Image<math::hdr::Rgb_f> hdr = to_hdr<float>(yacht);
+                for (int row = 0; row != hdr.height(); ++row)
+                {
+                    auto * expected = reinterpret_cast<const float *>(hdr.row(row));
+                    auto * actual = reinterpret_cast<const float *>(widened.row(row));
+                    for (int channel = 0; channel != hdr.width() * 3; ++channel)
+                    {
+                        REQUIRE(std::abs(expected[channel] - actual[channel]) <= expected[channel] / 2048.f);
+                    }
+                }
+
+                AND_THEN("Narrowing back to half-float is exact")
+                {
+                    requireImagesEquality(to_half(widened), half);
+                }
+            }
+        }
+    }
+
+    GIVEN("An RGBA image")
+    {
+        ImageRgba rgba{resource::pathFor("tests/Images/PNG/ColorCheck.png")};
+
+        THEN("It survives a roundtrip through half-floats, in parallel")
+        {
+            ThreadPool pool{3};
+            requireImagesEquality(tonemap(to_hdr<Half>(rgba, Execution{pool, 5}), Execution{pool}), rgba);
+        }
+    }
+
+    GIVEN("A half-float RGBA image filled with a value")
+    {
+        const Rgba_h value{Half{0.5f}, Half{1.f}, Half{2.f}, Half{1.f}};
+        const Image<Rgba_h> half{{16, 8}, value};
+
+        THEN("It can be copied, cropped and cleared as any other image")
+        {
+            Image<Rgba_h> copy{half};
+            requireImagesEquality(copy, half);
+
+            const Image<Rgba_h> cropped = half.crop({{2, 3}, {5, 4}});
+            REQUIRE(cropped.dimensions() == math::Size<2, int>{5, 4});
+            REQUIRE(cropped.at(4, 3) == value);
+
+            const Rgba_h cleared{Half{0.f}, Half{0.f}, Half{0.f}, Half{0.f}};
+            copy.clear(cleared);
+            REQUIRE(copy.at(15, 7) == cleared);
+            REQUIRE(half.at(15, 7) == value);
+        }
+
+        THEN("Writing it to a stream throws")
+        {
+            std::stringstream out;
+            REQUIRE_THROWS_AS(half.write(ImageFormat::Png, out), std::runtime_error);
+        }
+    }
+}
+
+
 SCENARIO("Image high level operations")
 {
     filesystem::path tempFolder = ensureTemporaryImageFolder("ad_graphics_tests_image");
@@ -0,0 +1,144 @@
+#include "catch.hpp"
+
+#include "FilesystemHelpers.h"
+
+#include <arte/Image.h>
+#include <arte/MappedImage.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+template <class T_pixel>
+void requireSamePixels(ImageView<const T_pixel> aLhs, ImageView<const T_pixel> aRhs)
+{
+    REQUIRE(aLhs.dimensions() == aRhs.dimensions());
+    for (int row = 0; row != aLhs.height(); ++row)
+    {
+        REQUIRE(std::equal(aLhs.row(row), aLhs.row(row) + aLhs.width(), aRhs.row(row)));
+    }
+}
+
+
+SCENARIO("Memory mapped Netpbm images")
+{
+    filesystem::path tempFolder = ensureTemporaryImageFolder("ad_graphics_tests_mapped");
+    const filesystem::path yachtPath = resource::pathFor("tests/Images/PPM/Yacht.512.ppm");
+
+    GIVEN("A PPM file")
+    {
+        ImageRgb streamed = ImageRgb::Read(
+            ImageFormat::Ppm,
+            std::ifstream{yachtPath.string(), std::ios_base::in | std::ios_base::binary});
+
+        WHEN("It is mapped")
+        {
+            MappedImageRgb mapped = MappedImageRgb::Open(yachtPath);
+
+            THEN("The view addresses the same pixels as the streamed image")
+            {
+                requireSamePixels<math::sdr::Rgb>(mapped, streamed);
+            }
+
+            THEN("It can be copied to images of both orientations")
+            {
+                requireSamePixels<math::sdr::Rgb>(mapped.toImage(), streamed);
+
+                ImageRgb inverted = mapped.toImage(ImageOrientation::InvertVerticalAxis);
+                std::stringstream buffer;
+                streamed.write(ImageFormat::Ppm, buffer, ImageOrientation::InvertVerticalAxis);
+                requireSamePixels<math::sdr::Rgb>(inverted, ImageRgb::Read(ImageFormat::Ppm, buffer));
+            }
+        }
+
+        WHEN("A view on part of the image is written through a mapping, inverting it")
+        {
+            filesystem::path destination = tempFolder / "mapped_cropped_yacht.ppm";
+            ImageView<const math::sdr::Rgb> cropped = streamed.view({{100, 50}, {300, 200}});
+            saveMapped(cropped, destination, ImageOrientation::InvertVerticalAxis);
+
+            THEN("Reading it back with the stream reader, inverting again, gives the original pixels")
+            {
+                ImageRgb result = ImageRgb::Read(
+                    ImageFormat::Ppm,
+                    std::ifstream{destination.string(), std::ios_base::in | std::ios_base::binary},
+                    ImageOrientation::InvertVerticalAxis);
+                requireSamePixels<math::sdr::Rgb>(result, cropped);
+            }
+        }
+    }
+
+    GIVEN("A PGM image created as a mapped file")
+    {
+        filesystem::path destination = tempFolder / "mapped_gradient.pgm";
+        {
+            MappedImageGrayscale created = MappedImageGrayscale::Create(destination, {256, 16});
+            ImageView<math::sdr::Grayscale> view = created.view();
+            for (int row = 0; row != view.height(); ++row)
+            {
+                for (int column = 0; column != view.width(); ++column)
+                {
+                    view.at(column, row) = math::sdr::Grayscale{static_cast<std::uint8_t>(column)};
+                }
+            }
+        }
+
+        THEN("It is a valid PGM file")
+        {
+            Image<math::sdr::Grayscale> loaded = Image<math::sdr::Grayscale>::Read(
+                ImageFormat::Pgm,
+                std::ifstream{destination.string(), std::ios_base::in | std::ios_base::binary});
+            REQUIRE(loaded.dimensions() == math::Size<2, int>{256, 16});
+            REQUIRE(loaded.at(200, 10) == math::sdr::Grayscale{200});
+            requireSamePixels<math::sdr::Grayscale>(loaded, MappedImageGrayscale::Open(destination));
+        }
+    }
+
+    GIVEN("A truncated PPM file")
+    {
+        filesystem::path truncated = tempFolder / "truncated.ppm";
+        {
+            std::ofstream out{truncated.string(), std::ios_base::out | std::ios_base::binary};
+            out << "P6\n4 4\n255\n" << "not enough pixels";
+        }
+
+        THEN("Mapping it throws")
+        {
+            REQUIRE_THROWS_AS(MappedImageRgb::Open(truncated), std::runtime_error);
+        }
+    }
+
+    GIVEN("A PGM file whose header declares more than 2^31 pixels, without the raster")
+    {
+        filesystem::path huge = tempFolder / "huge.pgm";
+        {
+            std::ofstream out{huge.string(), std::ios_base::out | std::ios_base::binary};
+            out << "P5\n65536 65536\n255\n";
+        }
+
+        THEN("The expected size does not overflow, mapping it reports the truncation")
+        {
+            REQUIRE_THROWS_WITH(MappedImageGrayscale::Open(huge), Catch::Contains("truncated content"));
+        }
+    }
+
+    GIVEN("A PGM file with invalid dimensions")
+    {
+        filesystem::path invalid = tempFolder / "invalid.pgm";
+        {
+            std::ofstream out{invalid.string(), std::ios_base::out | std::ios_base::binary};
+            out << "P5\n0 4\n255\n" << "pixels";
+        }
+
+        THEN("The error designates the PGM format")
+        {
+            REQUIRE_THROWS_WITH(MappedImageGrayscale::Open(invalid), "Invalid PGM dimensions");
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#include "catch.hpp"
+
+#include "FilesystemHelpers.h"
+
+#include <arte/Mipmaps.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+SCENARIO("Mipmap chain layout")
+{
+    GIVEN("A non-square, non power of 2, resolution")
+    {
+        math::Size<2, int> resolution{300, 70};
+
+        THEN("The complete chain goes down to 1x1, flooring each division")
+        {
+            REQUIRE(countCompleteMipmaps(resolution) == 9);
+            REQUIRE(getMipmapSize(resolution, 1) == math::Size<2, int>{150, 35});
+            REQUIRE(getMipmapSize(resolution, 2) == math::Size<2, int>{75, 17});
+            REQUIRE(getMipmapSize(resolution, 7) == math::Size<2, int>{2, 1});
+            REQUIRE(getMipmapSize(resolution, 8) == math::Size<2, int>{1, 1});
+        }
+
+        WHEN("A mip chain is allocated")
+        {
+            MipChain<math::sdr::Rgb> chain{resolution};
+
+            THEN("All the levels are held by a single allocation")
+            {
+                REQUIRE(chain.levelCount() == 9);
+                const std::byte * begin = reinterpret_cast<const std::byte *>(chain.level(0).data());
+                for (int level = 0; level != chain.levelCount(); ++level)
+                {
+                    ImageView<math::sdr::Rgb> view = chain.level(level);
+                    REQUIRE(view.dimensions() == getMipmapSize(resolution, level));
+                    REQUIRE(view.isContiguous());
+
+                    const std::byte * levelBegin = reinterpret_cast<const std::byte *>(view.data());
+                    REQUIRE(reinterpret_cast<std::uintptr_t>(levelBegin) % gRasterAlignment == 0);
+                    REQUIRE(levelBegin + view.size_bytes_line() * view.height() <= begin + chain.size_bytes());
+                }
+            }
+        }
+    }
+}
+
+
+SCENARIO("Mipmap chain generation")
+{
+    GIVEN("A checkerboard of black and white pixels")
+    {
+        ImageRgb checker{{16, 8}, math::sdr::gBlack};
+        for (int row = 0; row != checker.height(); ++row)
+        {
+            for (int column = (row % 2); column < checker.width(); column += 2)
+            {
+                checker.at(column, row) = math::sdr::gWhite;
+            }
+        }
+
+        WHEN("The chain is built assuming linear values")
+        {
+            MipChain<math::sdr::Rgb> chain = buildMipChain(checker, MipmapFilter::Box, ColorEncoding::Linear);
+
+            THEN("The box filtered levels are mid-gray")
+            {
+                for (int level = 1; level != chain.levelCount(); ++level)
+                {
+                    ImageView<const math::sdr::Rgb> view = std::as_const(chain).level(level);
+                    for (int row = 0; row != view.height(); ++row)
+                    {
+                        REQUIRE(std::all_of(view.row(row), view.row(row) + view.width(),
+                                            [](math::sdr::Rgb aPixel){ return aPixel.r() == 128; }));
+                    }
+                }
+            }
+        }
+
+        WHEN("The chain is built assuming sRGB values")
+        {
+            MipChain<math::sdr::Rgb> chain = buildMipChain(checker, MipmapFilter::Box, ColorEncoding::Srgb);
+
+            THEN("Level 0 is a copy of the image")
+            {
+                ImageView<const math::sdr::Rgb> base = std::as_const(chain).level(0);
+                REQUIRE(std::equal(base.data(), base.data() + checker.dimensions().area(), checker.begin()));
+            }
+
+            THEN("The averaging is done on linear intensities, giving a brighter encoded value")
+            {
+                // 0.5 linear intensity is encoded as ~187.5
+                math::sdr::Rgb pixel = std::as_const(chain).level(1).at(0, 0);
+                REQUIRE(std::abs(pixel.r() - 188) <= 1);
+                REQUIRE(pixel.r() == pixel.g());
+            }
+        }
+    }
+
+    GIVEN("An image")
+    {
+        ImageRgb yacht{resource::pathFor("tests/Images/PPM/Yacht.512.ppm")};
+
+        THEN("All filters produce a complete chain, down to 1x1")
+        {
+            for (MipmapFilter filter : {MipmapFilter::Box, MipmapFilter::CatmullRom, MipmapFilter::Gaussian})
+            {
+                MipChain<math::sdr::Rgb> chain = buildMipChain(yacht, filter);
+                REQUIRE(chain.levelCount() == countCompleteMipmaps(yacht.dimensions()));
+                REQUIRE(std::as_const(chain).level(chain.levelCount() - 1).dimensions()
+                        == math::Size<2, int>{1, 1});
+            }
+        }
+    }
+}
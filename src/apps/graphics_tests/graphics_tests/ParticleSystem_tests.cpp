@@ -0,0 +1,228 @@
+#include "catch.hpp"
+
+#include "GlContext.h"
+
+#include <graphics/ParticleSystem.h>
+#include <graphics/SpriteLoading.h>
+
+#include <math/Transformations.h>
+
+#include <renderer/FrameBuffer.h>
+#include <renderer/Texture.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::graphics;
+
+
+namespace {
+
+
+    /// \brief The sprite of the particle emitted `aIndex`-th, so instances can be traced back to their particle.
+    TrimmedSprite identifyingSprite(int aIndex)
+    {
+        return LoadedSprite{{aIndex, 0}, {4, 4}};
+    }
+
+
+    std::vector<Spriting::Instance> getInstances(const ParticleSystem & aParticles)
+    {
+        std::vector<Spriting::Instance> instances(
+            aParticles.size(),
+            Spriting::Instance{Position2<GLfloat>{0.f, 0.f}, identifyingSprite(-1)});
+        aParticles.writeInstances(instances);
+        return instances;
+    }
+
+
+} // anonymous namespace
+
+
+SCENARIO("Particle system simulation")
+{
+    GIVEN("A particle system under an acceleration")
+    {
+        ParticleSystem particles{8, {0.f, -2.f}};
+        REQUIRE(particles.emit({
+            .mPosition{0.f, 0.f},
+            .mVelocity{1.f, 0.f},
+            .mLifetime = 10.f,
+            .mSprite = identifyingSprite(0),
+        }));
+
+        WHEN("It is updated")
+        {
+            particles.update(0.5f);
+            particles.update(0.5f);
+
+            THEN("The velocity is integrated before the position")
+            {
+                const std::vector<Spriting::Instance> instances = getInstances(particles);
+                REQUIRE(instances.size() == 1);
+                REQUIRE(instances[0].mModelTransform
+                        == math::trans2d::translate(math::Vec<2, GLfloat>{1.f, -1.5f}));
+            }
+
+            THEN("The opacity fades over the lifetime")
+            {
+                REQUIRE(getInstances(particles)[0].mOpacity == Approx(0.9f));
+            }
+        }
+    }
+
+    GIVEN("More particles than fill complete vectors, half of them short-lived")
+    {
+        constexpr int count = 23;
+        ParticleSystem particles{count, {0.f, 0.f}, ParticleSystem::Fading::None};
+        for (int i = 0; i != count; ++i)
+        {
+            REQUIRE(particles.emit({
+                .mPosition{(GLfloat)i, 0.f},
+                .mVelocity{0.f, 1.f},
+                .mLifetime = (i % 2 == 0) ? 1.f : 10.f,
+                .mSprite = identifyingSprite(i),
+            }));
+        }
+
+        THEN("It cannot emit past its capacity")
+        {
+            REQUIRE_FALSE(particles.emit({{0.f, 0.f}, {0.f, 0.f}, 1.f, identifyingSprite(count)}));
+            REQUIRE(particles.size() == count);
+        }
+
+        WHEN("It is updated past the short lifetime")
+        {
+            particles.update(2.f);
+
+            THEN("Exactly the dead particles are removed, and the live ones are all updated")
+            {
+                const std::vector<Spriting::Instance> instances = getInstances(particles);
+                REQUIRE(instances.size() == count / 2);
+
+                std::vector<int> seen(count, 0);
+                for (const Spriting::Instance & instance : instances)
+                {
+                    const int index = instance.mLoadedSprite.x();
+                    REQUIRE(index % 2 == 1);
+                    ++seen[index];
+                    REQUIRE(instance.mModelTransform
+                            == math::trans2d::translate(math::Vec<2, GLfloat>{(GLfloat)index, 2.f}));
+                    REQUIRE(instance.mOpacity == 1.f);
+                }
+                for (int i = 1; i < count; i += 2)
+                {
+                    REQUIRE(seen[i] == 1);
+                }
+            }
+
+            THEN("The capacity is unchanged, freed slots are reused")
+            {
+                REQUIRE(particles.capacity() == count);
+                for (int i = 0; i != (count + 1) / 2; ++i)
+                {
+                    REQUIRE(particles.emit({{0.f, 0.f}, {0.f, 0.f}, 1.f, identifyingSprite(i)}));
+                }
+                REQUIRE(particles.size() == count);
+            }
+        }
+    }
+}
+
+
+SCENARIO("Particle system rendering")
+{
+    INITIALIZE_GL_CONTEXT();
+
+    GIVEN("A render target and a white sprite")
+    {
+        constexpr GLsizei side = 64;
+        Texture target{GL_TEXTURE_2D};
+        allocateStorage(target, GL_RGBA8, side, side);
+        FrameBuffer frameBuffer;
+        attachImage(frameBuffer, target);
+
+        sprite::LoadedAtlas atlas{.texture{std::make_shared<Texture>(GL_TEXTURE_RECTANGLE)}};
+        allocateStorage(*atlas.texture, GL_RGBA8, 4, 4);
+        {
+            const std::vector<GLubyte> white(4 * 4 * 4, 255);
+            ScopedBind bound{*atlas.texture};
+            glTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, 4, 4, GL_RGBA, GL_UNSIGNED_BYTE, white.data());
+        }
+
+        // The 4 pixels sprites are 0.4 wide in normalized device coordinates.
+        Spriting spriting{0.1f};
+
+        WHEN("A particle system with one dead and one live particle is rendered")
+        {
+            ParticleSystem particles{16};
+            particles.emit({{-0.8f, -0.8f}, {0.f, 0.f}, 1.f, LoadedSprite{{0, 0}, {4, 4}}});
+            particles.emit({{0.2f, 0.2f}, {0.f, 0.f}, 10.f, LoadedSprite{{0, 0}, {4, 4}}});
+            particles.update(2.f);
+            particles.writeInstances(spriting);
+
+            ScopedBind boundFrameBuffer{frameBuffer};
+            glViewport(0, 0, side, side);
+            glClearColor(0.f, 0.f, 0.f, 0.f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            spriting.render(atlas);
+
+            auto readPixel = [](GLint aX, GLint aY)
+            {
+                std::array<GLubyte, 4> pixel;
+                glReadPixels(aX, aY, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel.data());
+                return pixel;
+            };
+
+            THEN("Only the live particle is drawn, faded by its age")
+            {
+                REQUIRE(readPixel(12, 12) == std::array<GLubyte, 4>{0, 0, 0, 0});
+
+                // Opacity is 1 - 2/10
+                const std::array<GLubyte, 4> live = readPixel(44, 44);
+                for (GLubyte channel : live)
+                {
+                    REQUIRE((int)channel == Approx(204).margin(1));
+                }
+            }
+        }
+    }
+}
+
+
+// Hidden by default, run with `graphics_tests [.benchmark]`
+TEST_CASE("Updating particles", "[.benchmark]")
+{
+    constexpr std::size_t count = 100'000;
+    ParticleSystem particles{count, {0.f, -9.8f}};
+
+    // Long lived particles, so the count is stable across the benchmark runs.
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        particles.emit({{(GLfloat)i, 0.f}, {1.f, 1.f}, 1e9f, LoadedSprite{{0, 0}, {4, 4}}, 0.f, 1.f});
+    }
+
+    // The throughput in particles/ms is 100'000 divided by the mean time in ms.
+    BENCHMARK("Update 100'000 particles")
+    {
+        particles.update(1.f / 60.f);
+        return particles.size();
+    };
+
+    BENCHMARK_ADVANCED("Emit 100'000 particles, then update them with a tenth dying")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&particles]
+        {
+            particles.clear();
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                particles.emit({{0.f, 0.f}, {1.f, 1.f}, (i % 10 == 0) ? 0.f : 1e9f, LoadedSprite{{0, 0}, {4, 4}}});
+            }
+            particles.update(1.f / 60.f);
+            return particles.size();
+        });
+    };
+}
@@ -0,0 +1,308 @@
+#include "catch.hpp"
+
+#include <arte/Image.h>
+#include <arte/detail/PixelKernels.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+namespace kernels = ad::arte::detail::kernels;
+
+
+namespace {
+
+
+    /// \brief Restore the detected SIMD level when going out of scope.
+    struct ScopedSimdLevel
+    {
+        explicit ScopedSimdLevel(kernels::SimdLevel aLevel)
+        { kernels::setSimdLevel(aLevel); }
+
+        ~ScopedSimdLevel()
+        { kernels::setSimdLevel(kernels::detectSimdLevel()); }
+    };
+
+
+    template <class T_pixel>
+    Image<T_pixel> makeNoise(math::Size<2, int> aDimensions)
+    {
+        auto result = Image<T_pixel>::makeUninitialized(aDimensions);
+        std::minstd_rand engine{42};
+        std::uniform_int_distribution<int> distribution{0, 255};
+        for (int row = 0; row != result.height(); ++row)
+        {
+            auto * channels = reinterpret_cast<std::uint8_t *>(result.row(row));
+            for (std::size_t i = 0; i != result.size_bytes_line(); ++i)
+            {
+                channels[i] = static_cast<std::uint8_t>(distribution(engine));
+            }
+        }
+        return result;
+    }
+
+
+    /// \brief Compare all the channels of two images, allowing `aTolerance` absolute difference.
+    template <class T_channel, class T_image>
+    void requireChannelsClose(const T_image & aLhs, const T_image & aRhs, double aTolerance)
+    {
+        REQUIRE(aLhs.dimensions() == aRhs.dimensions());
+        for (int row = 0; row != aLhs.height(); ++row)
+        {
+            auto lhs = reinterpret_cast<const T_channel *>(aLhs.row(row));
+            auto rhs = reinterpret_cast<const T_channel *>(aRhs.row(row));
+            for (std::size_t i = 0; i != aLhs.size_bytes_line() / sizeof(T_channel); ++i)
+            {
+                if (std::abs(static_cast<double>(lhs[i]) - static_cast<double>(rhs[i])) > aTolerance)
+                {
+                    FAIL("Channel " << i << " on row " << row << " differs: " << +lhs[i] << " vs " << +rhs[i]);
+                }
+            }
+        }
+    }
+
+
+} // anonymous namespace
+
+
+SCENARIO("Vectorized pixel conversions")
+{
+    GIVEN("An RGB and an RGBA image, whose width is not a multiple of the vector size")
+    {
+        ImageRgb rgb = makeNoise<math::sdr::Rgb>({67, 13});
+        ImageRgba rgba = makeNoise<math::sdr::Rgba>({67, 13});
+
+        WHEN("They are converted with the scalar code")
+        {
+            ScopedSimdLevel scalar{kernels::SimdLevel::Scalar};
+            Image<math::sdr::Grayscale> grayScalar = toGrayscale(rgb.view());
+            Image<math::hdr::Rgba_f> hdrScalar = to_hdr(rgba);
+            ImageRgba tonemappedScalar = tonemap(hdrScalar);
+            ImageRgba decodedScalar = rgba;
+            decodeSRGBToLinear(decodedScalar);
+
+            THEN("The vectorized kernels supported by the CPU give the same results")
+            {
+                for (auto level : {kernels::SimdLevel::Sse, kernels::SimdLevel::Avx2})
+                {
+                    if (kernels::setSimdLevel(level) != level)
+                    {
+                        continue;
+                    }
+                    INFO("SIMD level " << static_cast<int>(level));
+
+                    requireChannelsClose<std::uint8_t>(toGrayscale(rgb.view()), grayScalar, 0);
+                    requireChannelsClose<float>(to_hdr(rgba), hdrScalar, 1e-6);
+                    // Rounding of the math library might differ on exact halves.
+                    requireChannelsClose<std::uint8_t>(tonemap(hdrScalar), tonemappedScalar, 1);
+
+                    ImageRgba decoded = rgba;
+                    decodeSRGBToLinear(decoded);
+                    requireChannelsClose<std::uint8_t>(decoded, decodedScalar, 0);
+                }
+            }
+        }
+    }
+
+    GIVEN("Linear values covering the unit range")
+    {
+        constexpr int count = 10001;
+        std::vector<float> linear(count);
+        for (int i = 0; i != count; ++i)
+        {
+            linear[i] = static_cast<float>(i) / (count - 1);
+        }
+
+        WHEN("They are encoded to sRGB")
+        {
+            std::vector<std::uint8_t> encoded(count);
+            kernels::encodeSRGB(linear.data(), encoded.data(), count);
+
+            THEN("The polynomial approximation is within one step of the exact transfer function")
+            {
+                for (int i = 0; i != count; ++i)
+                {
+                    double c = linear[i];
+                    double exact = (c <= 0.0031308 ? 12.92 * c : 1.055 * std::pow(c, 1 / 2.4) - 0.055) * 255.;
+                    REQUIRE(std::abs(exact - encoded[i]) <= 1.);
+                }
+            }
+        }
+
+        THEN("All 8-bit sRGB values survive a decode and encode roundtrip")
+        {
+            for (int value = 0; value != 256; ++value)
+            {
+                float decoded = kernels::decodeSRGB(static_cast<std::uint8_t>(value));
+                std::uint8_t encoded;
+                kernels::encodeSRGB(&decoded, &encoded, 1);
+                REQUIRE(encoded == value);
+            }
+        }
+    }
+
+    GIVEN("Floats covering the half-float range, special values, and their tails")
+    {
+        std::vector<float> values{0.f, -0.f, 1.f, 65504.f, 65519.f, 65520.f, 1e-8f, -3e-5f, 1e30f,
+                                  std::numeric_limits<float>::infinity(),
+                                  std::numeric_limits<float>::quiet_NaN()};
+        for (int i = -200000; i != 200000; i += 7)
+        {
+            values.push_back(i * 0.3371f);
+            values.push_back(1.f / i);
+        }
+
+        WHEN("They are converted with the scalar code")
+        {
+            std::vector<std::uint16_t> halvesScalar(values.size());
+            std::vector<float> widenedScalar(values.size());
+            {
+                ScopedSimdLevel scalar{kernels::SimdLevel::Scalar};
+                kernels::floatToHalf(values.data(), halvesScalar.data(), values.size());
+                kernels::halfToFloat(halvesScalar.data(), widenedScalar.data(), values.size());
+            }
+
+            THEN("The vectorized conversions give the same results")
+            {
+                std::vector<std::uint16_t> halves(values.size());
+                std::vector<float> widened(values.size());
+                kernels::floatToHalf(values.data(), halves.data(), values.size());
+                kernels::halfToFloat(halvesScalar.data(), widened.data(), values.size());
+
+                REQUIRE(halves == halvesScalar);
+                for (std::size_t i = 0; i != values.size(); ++i)
+                {
+                    REQUIRE((widened[i] == widenedScalar[i]
+                             || (std::isnan(widened[i]) && std::isnan(widenedScalar[i]))));
+                }
+            }
+        }
+    }
+
+    GIVEN("Blocks of 16 RGBA pixels, and palettes of all the sizes")
+    {
+        std::minstd_rand engine{7};
+        std::uniform_int_distribution<int> distribution{0, 255};
+        auto randomize = [&](auto & aBytes)
+        {
+            for (auto & byte : aBytes)
+            {
+                byte = static_cast<std::uint8_t>(distribution(engine));
+            }
+        };
+
+        THEN("The vectorized palette index selection gives the same results as the scalar code")
+        {
+            for (int paletteSize = 1; paletteSize != 17; ++paletteSize)
+            {
+                std::uint8_t block[64], palette[64], indicesScalar[16], indices[16];
+                randomize(block);
+                randomize(palette);
+                // Duplicated colors exercise the tie breaking.
+                if (paletteSize > 1)
+                {
+                    std::copy(palette, palette + 4, palette + 4 * (paletteSize - 1));
+                }
+
+                std::uint32_t errorScalar;
+                {
+                    ScopedSimdLevel scalar{kernels::SimdLevel::Scalar};
+                    errorScalar = kernels::selectPaletteIndices(block, palette, paletteSize, indicesScalar);
+                }
+                std::uint32_t error = kernels::selectPaletteIndices(block, palette, paletteSize, indices);
+
+                INFO("Palette size " << paletteSize);
+                REQUIRE(error == errorScalar);
+                REQUIRE(std::equal(indices, indices + 16, indicesScalar));
+            }
+        }
+    }
+
+    GIVEN("Rows of RGBA pixels of all lengths, with a few visible pixels")
+    {
+        std::minstd_rand engine{11};
+        std::uniform_int_distribution<int> distribution{0, 255};
+
+        THEN("The vectorized search of visible pixels gives the same results as the scalar code")
+        {
+            for (std::size_t count = 0; count != 70; ++count)
+            {
+                std::vector<std::uint8_t> row(4 * count);
+                for (std::size_t pixel = 0; pixel != count; ++pixel)
+                {
+                    // Color channels are random, only the alpha decides visibility.
+                    row[4 * pixel + 0] = static_cast<std::uint8_t>(distribution(engine));
+                    row[4 * pixel + 1] = static_cast<std::uint8_t>(distribution(engine));
+                    row[4 * pixel + 2] = static_cast<std::uint8_t>(distribution(engine));
+                    row[4 * pixel + 3] = (distribution(engine) < 16) ? 1 : 0;
+                }
+
+                std::size_t firstScalar, endScalar;
+                {
+                    ScopedSimdLevel scalar{kernels::SimdLevel::Scalar};
+                    firstScalar = kernels::findFirstVisible(row.data(), count);
+                    endScalar = kernels::findVisibleEnd(row.data(), count);
+                }
+
+                INFO("Pixel count " << count);
+                REQUIRE(kernels::findFirstVisible(row.data(), count) == firstScalar);
+                REQUIRE(kernels::findVisibleEnd(row.data(), count) == endScalar);
+            }
+        }
+    }
+}
+
+
+// Hidden by default, run with `graphics_tests [.benchmark]`
+TEST_CASE("Pixel conversions on a 4K RGBA image", "[.benchmark]")
+{
+    ImageRgb imageRgb = makeNoise<math::sdr::Rgb>({3840, 2160});
+    ImageRgba image = makeNoise<math::sdr::Rgba>({3840, 2160});
+    Image<math::hdr::Rgba_f> hdr = to_hdr(image);
+
+    for (auto level : {kernels::SimdLevel::Scalar, kernels::SimdLevel::Sse, kernels::SimdLevel::Avx2})
+    {
+        ScopedSimdLevel scoped{level};
+        if (kernels::getSimdLevel() != level)
+        {
+            continue;
+        }
+
+        const std::string suffix = " (level " + std::to_string(static_cast<int>(level)) + ")";
+
+        BENCHMARK("toGrayscale (RGB)" + suffix)
+        {
+            return toGrayscale(imageRgb.view());
+        };
+
+        BENCHMARK("to_hdr" + suffix)
+        {
+            return to_hdr(image);
+        };
+
+        BENCHMARK("tonemap" + suffix)
+        {
+            return tonemap(hdr);
+        };
+
+        BENCHMARK_ADVANCED("decodeSRGBToLinear" + suffix)(Catch::Benchmark::Chronometer meter)
+        {
+            ImageRgba copy = image;
+            meter.measure([&copy]{ return decodeSRGBToLinear(copy).data(); });
+        };
+
+        BENCHMARK("tonemapToSRGB" + suffix)
+        {
+            return tonemapToSRGB(hdr);
+        };
+    }
+}
@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include <arte/Image.h>
+#include <arte/ImageConvolution.h>
+#include <arte/RasterAllocator.h>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+SCENARIO("Recycling image rasters")
+{
+    GIVEN("A raster pool made current")
+    {
+        RasterPool pool;
+        ScopedRasterAllocator scope{pool};
+
+        WHEN("Images of the same dimensions are successively created and destroyed")
+        {
+            const math::Size<2, int> dimensions{128, 64};
+            for (int i = 0; i != 10; ++i)
+            {
+                ImageRgb image{dimensions, math::sdr::gRed};
+                ImageRgb copy{image};
+            }
+
+            THEN("Only the first images were allocated from the heap")
+            {
+                RasterAllocationStats stats = pool.stats();
+                CHECK(stats.mAllocations == 20);
+                CHECK(stats.mHeapAllocations == 2);
+                CHECK(stats.mBytesInUse == 0);
+                CHECK(stats.mHighWaterBytes == 2 * dimensions.area() * sizeof(math::sdr::Rgb));
+                CHECK(stats.mCachedBytes == stats.mHighWaterBytes);
+            }
+
+            THEN("Releasing the pool returns the cached rasters")
+            {
+                pool.release();
+                CHECK(pool.stats().mCachedBytes == 0);
+            }
+        }
+
+        WHEN("A resampling is repeated")
+        {
+            Image<math::hdr::Rgb_f> source = to_hdr(ImageRgb{{64, 64}, math::sdr::gRed});
+            Filter filter{.mFilterFunc = [](float x){ return catmullRom(x); }, .mRadius = 2.f};
+
+            resampleSeparable2D(source, {32, 16}, filter);
+            const std::size_t firstHeapAllocations = pool.stats().mHeapAllocations;
+            resampleSeparable2D(source, {32, 16}, filter);
+
+            THEN("The intermediate and output rasters are recycled")
+            {
+                CHECK(pool.stats().mHeapAllocations == firstHeapAllocations);
+            }
+        }
+    }
+
+    GIVEN("A raster pool with a limited cache")
+    {
+        RasterPool pool{1024};
+
+        WHEN("Two rasters that do not both fit in the cache are released")
+        {
+            {
+                auto first = ImageRgba::makeUninitialized({16, 16}, 1, pool);
+                auto second = ImageRgba::makeUninitialized({16, 16}, 1, pool);
+            }
+
+            THEN("Only one is kept")
+            {
+                CHECK(pool.stats().mCachedBytes == 16 * 16 * 4);
+            }
+        }
+    }
+
+    GIVEN("No allocator made current")
+    {
+        THEN("Images are allocated by the default allocator")
+        {
+            REQUIRE(&currentRasterAllocator() == &defaultRasterAllocator());
+            const std::size_t before = defaultRasterAllocator().stats().mAllocations;
+            ImageRgb image{{4, 4}, math::sdr::gBlue};
+            CHECK(defaultRasterAllocator().stats().mAllocations == before + 1);
+        }
+    }
+}
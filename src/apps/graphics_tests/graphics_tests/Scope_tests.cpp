@@ -1,6 +1,6 @@
 #include "catch.hpp"
 
-#include <graphics/ApplicationGlfw.h>
+#include "GlContext.h"
 
 #include <renderer/FrameBuffer.h>
 #include <renderer/Shading.h>
@@ -14,19 +14,6 @@ using namespace ad;
 using namespace ad::graphics;
 
 
-#define INITIALIZE_GL_CONTEXT() \
-    std::unique_ptr<graphics::ApplicationGlfw> glApp; \
-    try \
-    { \
-        glApp = std::make_unique<graphics::ApplicationGlfw>("dummy", math::Size<2, int>{1, 1}); \
-    } \
-    catch (const std::exception &) \
-    { \
-        /* We are on a platform where we cannot obtain the GL context via Glfw, just pass. */ \
-        return; \
-    } \
-
-
 SCENARIO("Vertex and Index buffer scoping.")
 {
     INITIALIZE_GL_CONTEXT();
@@ -0,0 +1,99 @@
+#include "catch.hpp"
+
+#include <graphics/SpriteAnimator.h>
+
+#include <limits>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::graphics;
+
+
+namespace {
+
+
+    /// \brief Make an animation whose frame `i` is the sprite at x == i, lasting `aDurations[i]`.
+    sprite::Animation makeAnimation(const std::vector<sprite::Animation::Duration_t> & aDurations)
+    {
+        std::vector<sprite::Animation::Frame> frames;
+        sprite::Animation::Duration_t endTime = 0;
+        for (int index = 0; index != (int)aDurations.size(); ++index)
+        {
+            endTime += aDurations[index];
+            const LoadedSprite loaded{{index, 0}, {1, 1}};
+            frames.push_back({endTime, loaded, SpriteTrim{.sourceSize = loaded.dimension()}});
+        }
+        return sprite::Animation{endTime, std::move(frames)};
+    }
+
+
+    int frameAt(const sprite::Animation & aAnimation, sprite::Animation::Duration_t aLocalTime)
+    {
+        return aAnimation.at(aLocalTime).mLoadedSprite.x();
+    }
+
+
+} // anonymous namespace
+
+
+SCENARIO("Sprite animation frame lookup")
+{
+    GIVEN("An animation whose frames all have the same duration")
+    {
+        const sprite::Animation animation = makeAnimation({100.f, 100.f, 100.f, 100.f});
+
+        THEN("It is looked up with a fixed step")
+        {
+            REQUIRE(animation.uniformFrameDuration == 100.f);
+        }
+
+        THEN("Each time maps to the first frame ending at or after it")
+        {
+            REQUIRE(frameAt(animation, -5.f) == 0);
+            REQUIRE(frameAt(animation, 0.f) == 0);
+            REQUIRE(frameAt(animation, 100.f) == 0);
+            REQUIRE(frameAt(animation, 100.5f) == 1);
+            REQUIRE(frameAt(animation, 299.f) == 2);
+            REQUIRE(frameAt(animation, 400.f) == 3);
+        }
+
+        THEN("Times past the end map to the last frame")
+        {
+            REQUIRE(frameAt(animation, 401.f) == 3);
+            REQUIRE(frameAt(animation, 1e9f) == 3);
+        }
+
+        THEN("A NaN time maps to the last frame")
+        {
+            REQUIRE(frameAt(animation, std::numeric_limits<sprite::Animation::Duration_t>::quiet_NaN()) == 3);
+        }
+    }
+
+    GIVEN("An animation with frames of different durations")
+    {
+        const sprite::Animation animation = makeAnimation({50.f, 10.f, 0.f, 200.f, 40.f});
+
+        THEN("It is looked up by searching the end times")
+        {
+            REQUIRE(animation.uniformFrameDuration == 0.f);
+        }
+
+        THEN("Each time maps to the first frame ending at or after it")
+        {
+            REQUIRE(frameAt(animation, 0.f) == 0);
+            REQUIRE(frameAt(animation, 50.f) == 0);
+            REQUIRE(frameAt(animation, 55.f) == 1);
+            // The third frame has no duration, it is never displayed.
+            REQUIRE(frameAt(animation, 60.f) == 1);
+            REQUIRE(frameAt(animation, 60.1f) == 3);
+            REQUIRE(frameAt(animation, 261.f) == 4);
+            REQUIRE(frameAt(animation, 1000.f) == 4);
+        }
+
+        THEN("A NaN time maps to the last frame")
+        {
+            REQUIRE(frameAt(animation, std::numeric_limits<sprite::Animation::Duration_t>::quiet_NaN()) == 4);
+        }
+    }
+}
@@ -0,0 +1,292 @@
+#include "catch.hpp"
+
+#include "FilesystemHelpers.h"
+
+#include <arte/SpriteSheet.h>
+#include <arte/detail/SpriteSheetCache.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+SCENARIO("Sprite sheets share their image")
+{
+    GIVEN("An animation sprite sheet")
+    {
+        const AnimationSpriteSheet sheet =
+            AnimationSpriteSheet::LoadAseFile(resource::pathFor("animations/run.json"));
+        REQUIRE(sheet.image().dimensions().area() > 0);
+
+        WHEN("It is copied")
+        {
+            const AnimationSpriteSheet copy{sheet};
+
+            THEN("Both sheets refer to the same pixels")
+            {
+                REQUIRE(&copy.image() == &sheet.image());
+                REQUIRE(sheet.sharedImage().use_count() == 2);
+            }
+        }
+
+        WHEN("Its image is retained after the sheet is destroyed")
+        {
+            std::shared_ptr<const ImageRgba> image;
+            {
+                AnimationSpriteSheet temporary{sheet};
+                image = temporary.sharedImage();
+            }
+
+            THEN("The image is still valid")
+            {
+                REQUIRE(image.get() == &sheet.image());
+            }
+        }
+
+        WHEN("Sheets are stacked vertically")
+        {
+            std::vector<std::reference_wrapper<const AnimationSpriteSheet>> sheets{sheet, sheet};
+            ImageRgba stacked = stackVertical<math::sdr::Rgba>(
+                sheets,
+                [](const AnimationSpriteSheet & aSheet) -> const ImageRgba &
+                {
+                    return aSheet.image();
+                });
+
+            THEN("The result has the cumulated height, and the sheets were not copied")
+            {
+                REQUIRE(stacked.height() == 2 * sheet.image().height());
+                REQUIRE(sheet.sharedImage().use_count() == 1);
+            }
+        }
+    }
+}
+
+
+SCENARIO("Sprite frames trimming")
+{
+    GIVEN("A transparent image with a few visible pixels")
+    {
+        ImageRgba image{{9, 6}, math::sdr::gTransparent};
+        auto makeVisible = [&](int aX, int aY)
+        {
+            reinterpret_cast<std::uint8_t *>(image.row(aY))[4 * aX + 3] = 255;
+        };
+        makeVisible(4, 1);
+        makeVisible(6, 2);
+        makeVisible(5, 3);
+
+        THEN("Its visible bounds tightly enclose the visible pixels")
+        {
+            const SpriteArea bounds = getVisibleBounds(image);
+            REQUIRE(bounds.origin() == math::Position<2, int>{4, 1});
+            REQUIRE(bounds.dimension() == math::Size<2, int>{3, 3});
+        }
+
+        THEN("A fully transparent area has empty visible bounds")
+        {
+            REQUIRE(getVisibleBounds(image.view(SpriteArea{{0, 3}, {4, 3}})).dimension().area() == 0);
+        }
+    }
+
+    GIVEN("An animation sprite sheet, whose frames are trimmed")
+    {
+        const AnimationSpriteSheet sheet =
+            AnimationSpriteSheet::LoadAseFile(resource::pathFor("animations/run.json"));
+
+        THEN("Each trimmed frame lies within its untrimmed frame, and keeps all its visible pixels")
+        {
+            REQUIRE(sheet.frameCount() > 0);
+            for (auto frameIt = sheet.cbegin(); frameIt != sheet.cend(); ++frameIt)
+            {
+                const FrameTrim & trim = frameIt->trim;
+                REQUIRE(trim.sourceSize == math::Size<2, int>{83, 97});
+                REQUIRE(trim.offset.x() >= 0);
+                REQUIRE(trim.offset.y() >= 0);
+                REQUIRE(trim.offset.x() + frameIt->area.width() <= trim.sourceSize.width());
+                REQUIRE(trim.offset.y() + frameIt->area.height() <= trim.sourceSize.height());
+
+                // Trimming again is a no-op.
+                const SpriteArea bounds = getVisibleBounds(sheet.image().view(frameIt->area));
+                REQUIRE(bounds.origin() == math::Position<2, int>{0, 0});
+                REQUIRE(bounds.dimension() == frameIt->area.dimension());
+            }
+        }
+
+        THEN("Some frames were trimmed")
+        {
+            int trimmedArea = 0;
+            int sourceArea = 0;
+            for (auto frameIt = sheet.cbegin(); frameIt != sheet.cend(); ++frameIt)
+            {
+                trimmedArea += frameIt->area.dimension().area();
+                sourceArea += frameIt->trim.sourceSize.area();
+            }
+            REQUIRE(trimmedArea < sourceArea);
+        }
+    }
+}
+
+
+SCENARIO("Sprite sheet binary cache")
+{
+    GIVEN("A copy of an Ase sprite sheet, and a cache file path")
+    {
+        // Each run starts from an empty folder, without a cache.
+        const filesystem::path folder = ensureTemporaryImageFolder("ad_graphics_tests_sheetcache");
+        filesystem::remove_all(folder);
+        filesystem::create_directories(folder);
+        filesystem::copy_file(resource::pathFor("animations/run.json"), folder / "run.json");
+        filesystem::copy_file(resource::pathFor("animations/run.png"), folder / "run.png");
+        const filesystem::path cacheFile = folder / "cache" / "run.sheet";
+
+        WHEN("The sheet is loaded through the cache a first time")
+        {
+            const AnimationSpriteSheet source = AnimationSpriteSheet::LoadAseFileCached(folder / "run.json", cacheFile);
+
+            THEN("The cache is written")
+            {
+                REQUIRE(filesystem::exists(cacheFile));
+            }
+
+            WHEN("It is loaded again")
+            {
+                const auto writeTime = filesystem::last_write_time(cacheFile);
+                const AnimationSpriteSheet cached = AnimationSpriteSheet::LoadAseFileCached(folder / "run.json", cacheFile);
+
+                THEN("The cache is not rewritten")
+                {
+                    REQUIRE(filesystem::last_write_time(cacheFile) == writeTime);
+                }
+
+                THEN("The cached sheet is identical to the sheet loaded from the sources")
+                {
+                    REQUIRE(cached.name() == source.name());
+                    REQUIRE(cached.scale() == source.scale());
+                    REQUIRE(cached.totalDuration() == source.totalDuration());
+                    REQUIRE(cached.frameCount() == source.frameCount());
+
+                    for (auto sourceIt = source.cbegin(), cachedIt = cached.cbegin();
+                         sourceIt != source.cend();
+                         ++sourceIt, ++cachedIt)
+                    {
+                        REQUIRE(cachedIt->name == sourceIt->name);
+                        REQUIRE(cachedIt->area.origin() == sourceIt->area.origin());
+                        REQUIRE(cachedIt->area.dimension() == sourceIt->area.dimension());
+                        REQUIRE(cachedIt->trim.offset == sourceIt->trim.offset);
+                        REQUIRE(cachedIt->trim.sourceSize == sourceIt->trim.sourceSize);
+                        REQUIRE(cachedIt->duration == sourceIt->duration);
+                    }
+
+                    REQUIRE(cached.image().dimensions() == source.image().dimensions());
+                    for (int row = 0; row != source.image().height(); ++row)
+                    {
+                        REQUIRE(std::memcmp(cached.image().row(row),
+                                            source.image().row(row),
+                                            source.image().width() * sizeof(math::sdr::Rgba)) == 0);
+                    }
+                }
+            }
+
+            WHEN("The sheet image is modified, then the sheet is loaded again")
+            {
+                const auto writeTime = filesystem::last_write_time(cacheFile);
+                filesystem::last_write_time(folder / "run.png",
+                                            filesystem::last_write_time(folder / "run.png") + std::chrono::hours{1});
+                const AnimationSpriteSheet reloaded =
+                    AnimationSpriteSheet::LoadAseFileCached(folder / "run.json", cacheFile);
+
+                THEN("The cache is rebuilt")
+                {
+                    REQUIRE(filesystem::last_write_time(cacheFile) != writeTime);
+                    REQUIRE(reloaded.frameCount() == source.frameCount());
+                }
+            }
+
+            WHEN("The cache is truncated, then the sheet is loaded again")
+            {
+                filesystem::resize_file(cacheFile, 100);
+                const AnimationSpriteSheet reloaded =
+                    AnimationSpriteSheet::LoadAseFileCached(folder / "run.json", cacheFile);
+
+                THEN("The sheet is loaded from the sources, and the cache is rebuilt")
+                {
+                    REQUIRE(reloaded.frameCount() == source.frameCount());
+                    REQUIRE(filesystem::file_size(cacheFile) > 100);
+                }
+            }
+
+            WHEN("The cache is truncated at each of its sections, then the sheet is loaded again")
+            {
+                namespace cache = detail::sheetcache;
+                const std::uintmax_t cacheSize = filesystem::file_size(cacheFile);
+
+                cache::Header header;
+                {
+                    std::ifstream in{cacheFile.string(), std::ios_base::in | std::ios_base::binary};
+                    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+                }
+
+                THEN("Each time, the sheet is loaded from the sources, and the cache is rebuilt")
+                {
+                    for (std::uint64_t truncatedSize : {std::uint64_t{sizeof(cache::Header) / 2},
+                                                        header.mFramesOffset + sizeof(cache::Frame) / 2,
+                                                        header.mStringsOffset,
+                                                        header.mRasterOffset,
+                                                        std::uint64_t{cacheSize - 1}})
+                    {
+                        filesystem::resize_file(cacheFile, truncatedSize);
+                        const AnimationSpriteSheet reloaded =
+                            AnimationSpriteSheet::LoadAseFileCached(folder / "run.json", cacheFile);
+                        REQUIRE(reloaded.frameCount() == source.frameCount());
+                        REQUIRE(filesystem::file_size(cacheFile) == cacheSize);
+                    }
+                }
+            }
+
+            WHEN("A frame name in the cache refers past the strings, then the sheet is loaded again")
+            {
+                namespace cache = detail::sheetcache;
+
+                auto readFirstFrame = [&cacheFile]()
+                {
+                    std::ifstream in{cacheFile.string(), std::ios_base::in | std::ios_base::binary};
+                    cache::Header header;
+                    cache::Frame frame;
+                    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+                    in.seekg(header.mFramesOffset);
+                    in.read(reinterpret_cast<char *>(&frame), sizeof(frame));
+                    return std::make_pair(header, frame);
+                };
+
+                auto [header, frame] = readFirstFrame();
+                frame.mName.mOffset = static_cast<std::uint32_t>(header.mStringsSize) + 1;
+                {
+                    std::fstream file{cacheFile.string(),
+                                      std::ios_base::in | std::ios_base::out | std::ios_base::binary};
+                    file.seekp(header.mFramesOffset);
+                    file.write(reinterpret_cast<const char *>(&frame), sizeof(frame));
+                }
+
+                const AnimationSpriteSheet reloaded =
+                    AnimationSpriteSheet::LoadAseFileCached(folder / "run.json", cacheFile);
+
+                THEN("The sheet is loaded from the sources, and the cache is rebuilt")
+                {
+                    REQUIRE(reloaded.frameCount() == source.frameCount());
+                    REQUIRE(reloaded.cbegin()->name == source.cbegin()->name);
+
+                    auto [rebuiltHeader, rebuiltFrame] = readFirstFrame();
+                    REQUIRE(rebuiltFrame.mName.mOffset + rebuiltFrame.mName.mSize <= rebuiltHeader.mStringsSize);
+                }
+            }
+        }
+    }
+}
@@ -41,10 +41,11 @@ public:
             arte::AnimationSpriteSheet::LoadAseFile(resource::pathFor("animations/" + gAnimationName + ".json"));
 
         mAtlas = mAnimator.load(sheet);
+        mAnimation = mAnimator.getHandle(gAnimationId);
 
         mAnimationParameter =
             ParameterAnimation_t{
-                mAnimator.get(gAnimationId).totalDuration,
+                mAnimator.get(*mAnimation).totalDuration,
                 gAnimationSpeed
         };
     }
@@ -56,11 +57,11 @@ public:
         std::vector<Spriting::Instance> instances{
             Spriting::Instance{
                 {0.f, 0.f},
-                mAnimator.at(gAnimationId, parameterValue),
+                mAnimator.at(*mAnimation, parameterValue),
             },
             Spriting::Instance{
                 {100.f, 0.f},
-                mAnimator.at(gAnimationId, parameterValue),
+                mAnimator.at(*mAnimation, parameterValue),
             },
         };
         mSpriting.updateInstances(instances);
@@ -85,6 +86,7 @@ private:
     Spriting mSpriting;
     sprite::LoadedAtlas mAtlas;
     sprite::Animator mAnimator;
+    std::optional<sprite::AnimationHandle> mAnimation;
     std::optional<ParameterAnimation_t> mAnimationParameter;
     double mAnimationTimepoint = 0.f;
 };
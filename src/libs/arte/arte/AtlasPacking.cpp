@@ -0,0 +1,279 @@
+#include "AtlasPacking.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+
+namespace ad {
+namespace arte {
+
+
+namespace {
+
+
+    bool intersects(const math::Rectangle<int> & aLhs, const math::Rectangle<int> & aRhs)
+    {
+        return aLhs.x() < aRhs.x() + aRhs.width() && aRhs.x() < aLhs.x() + aLhs.width()
+            && aLhs.y() < aRhs.y() + aRhs.height() && aRhs.y() < aLhs.y() + aLhs.height();
+    }
+
+
+    bool contains(const math::Rectangle<int> & aOuter, const math::Rectangle<int> & aInner)
+    {
+        return aInner.x() >= aOuter.x() && aInner.y() >= aOuter.y()
+            && aInner.x() + aInner.width() <= aOuter.x() + aOuter.width()
+            && aInner.y() + aInner.height() <= aOuter.y() + aOuter.height();
+    }
+
+
+} // anonymous namespace
+
+
+MaxRectsBin::MaxRectsBin(math::Size<2, int> aDimensions) :
+    mFreeRectangles{ {{0, 0}, aDimensions} }
+{}
+
+
+std::optional<PackedRectangle> MaxRectsBin::insert(math::Size<2, int> aDimensions, bool aAllowRotation)
+{
+    std::optional<PackedRectangle> best;
+    int bestShortSide = std::numeric_limits<int>::max();
+    int bestLongSide = std::numeric_limits<int>::max();
+
+    auto consider = [&](const math::Rectangle<int> & aFree, int aWidth, int aHeight, bool aRotated)
+    {
+        if (aWidth <= aFree.width() && aHeight <= aFree.height())
+        {
+            const int leftoverX = aFree.width() - aWidth;
+            const int leftoverY = aFree.height() - aHeight;
+            const int shortSide = std::min(leftoverX, leftoverY);
+            const int longSide = std::max(leftoverX, leftoverY);
+            if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+            {
+                bestShortSide = shortSide;
+                bestLongSide = longSide;
+                best = PackedRectangle{
+                    .mPage = 0,
+                    .mArea = {aFree.origin(), {aWidth, aHeight}},
+                    .mRotated = aRotated,
+                };
+            }
+        }
+    };
+
+    for (const math::Rectangle<int> & free : mFreeRectangles)
+    {
+        consider(free, aDimensions.width(), aDimensions.height(), false);
+        if (aAllowRotation && aDimensions.width() != aDimensions.height())
+        {
+            consider(free, aDimensions.height(), aDimensions.width(), true);
+        }
+    }
+
+    if (best)
+    {
+        place(best->mArea);
+    }
+    return best;
+}
+
+
+void MaxRectsBin::place(const math::Rectangle<int> & aNode)
+{
+    // Replace each free rectangle overlapping the node by its (up to 4) maximal parts outside the node.
+    std::vector<math::Rectangle<int>> split;
+    for (auto freeIt = mFreeRectangles.begin(); freeIt != mFreeRectangles.end();)
+    {
+        const math::Rectangle<int> free = *freeIt;
+        if (!intersects(free, aNode))
+        {
+            ++freeIt;
+            continue;
+        }
+
+        if (aNode.x() > free.x())
+        {
+            split.push_back({free.origin(), {aNode.x() - free.x(), free.height()}});
+        }
+        if (aNode.x() + aNode.width() < free.x() + free.width())
+        {
+            const int right = aNode.x() + aNode.width();
+            split.push_back({{right, free.y()}, {free.x() + free.width() - right, free.height()}});
+        }
+        if (aNode.y() > free.y())
+        {
+            split.push_back({free.origin(), {free.width(), aNode.y() - free.y()}});
+        }
+        if (aNode.y() + aNode.height() < free.y() + free.height())
+        {
+            const int top = aNode.y() + aNode.height();
+            split.push_back({{free.x(), top}, {free.width(), free.y() + free.height() - top}});
+        }
+
+        freeIt = mFreeRectangles.erase(freeIt);
+    }
+    mFreeRectangles.insert(mFreeRectangles.end(), split.begin(), split.end());
+
+    pruneFreeRectangles();
+
+    mUsedDimensions.width() = std::max(mUsedDimensions.width(), aNode.x() + aNode.width());
+    mUsedDimensions.height() = std::max(mUsedDimensions.height(), aNode.y() + aNode.height());
+}
+
+
+void MaxRectsBin::pruneFreeRectangles()
+{
+    // Remove the free rectangles contained in another one, keeping a single instance of duplicates.
+    for (std::size_t i = 0; i < mFreeRectangles.size(); ++i)
+    {
+        for (std::size_t j = i + 1; j < mFreeRectangles.size(); ++j)
+        {
+            if (contains(mFreeRectangles[j], mFreeRectangles[i]))
+            {
+                mFreeRectangles.erase(mFreeRectangles.begin() + i);
+                --i;
+                break;
+            }
+            else if (contains(mFreeRectangles[i], mFreeRectangles[j]))
+            {
+                mFreeRectangles.erase(mFreeRectangles.begin() + j);
+                --j;
+            }
+        }
+    }
+}
+
+
+namespace detail {
+
+
+    std::uint64_t hashBytes(const std::byte * aBytes, std::size_t aSize, std::uint64_t aSeed)
+    {
+        // Multiply-xorshift over 64-bit words, finalized with the splitmix64 mixer.
+        constexpr std::uint64_t gMultiplier = 0x9E3779B97F4A7C15ull;
+
+        std::uint64_t hash = aSeed ^ (aSize * gMultiplier);
+        std::size_t i = 0;
+        for (; i + 8 <= aSize; i += 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, aBytes + i, sizeof(word));
+            hash = (hash ^ word) * gMultiplier;
+            hash ^= hash >> 32;
+        }
+        if (i != aSize)
+        {
+            std::uint64_t word = 0;
+            std::memcpy(&word, aBytes + i, aSize - i);
+            hash = (hash ^ word) * gMultiplier;
+            hash ^= hash >> 32;
+        }
+
+        hash ^= hash >> 30;
+        hash *= 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 27;
+        hash *= 0x94D049BB133111EBull;
+        hash ^= hash >> 31;
+        return hash;
+    }
+
+
+} // namespace detail
+
+
+RectanglePacking packRectangles(std::span<const math::Size<2, int>> aSizes,
+                                const PackingOptions & aOptions)
+{
+    // The padding is added on the right and top of each rectangle, and to the page so the rectangles
+    // touching the page border do not need it.
+    const int padding = aOptions.mPadding;
+    const math::Size<2, int> binDimensions{
+        aOptions.mMaxPageSize.width() + padding,
+        aOptions.mMaxPageSize.height() + padding,
+    };
+
+    std::vector<std::size_t> order(aSizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t aLhs, std::size_t aRhs)
+                     {
+                        const math::Size<2, int> & lhs = aSizes[aLhs];
+                        const math::Size<2, int> & rhs = aSizes[aRhs];
+                        const int lhsMax = std::max(lhs.width(), lhs.height());
+                        const int rhsMax = std::max(rhs.width(), rhs.height());
+                        return lhsMax > rhsMax
+                            || (lhsMax == rhsMax
+                                && std::min(lhs.width(), lhs.height()) > std::min(rhs.width(), rhs.height()));
+                     });
+
+    std::vector<MaxRectsBin> bins;
+    RectanglePacking result;
+    result.mRectangles.resize(aSizes.size());
+
+    for (std::size_t index : order)
+    {
+        const math::Size<2, int> size = aSizes[index];
+        PackedRectangle & packed = result.mRectangles[index];
+
+        if (size.width() <= 0 || size.height() <= 0)
+        {
+            // Empty rectangles do not occupy any space, they are nominally placed on the first page.
+            packed = PackedRectangle{.mPage = 0, .mArea = {{0, 0}, size}};
+            continue;
+        }
+
+        const math::Size<2, int> padded{size.width() + padding, size.height() + padding};
+        std::optional<PackedRectangle> placed;
+        for (std::size_t page = 0; !placed && page != bins.size(); ++page)
+        {
+            if ((placed = bins[page].insert(padded, aOptions.mAllowRotation)))
+            {
+                placed->mPage = (int)page;
+            }
+        }
+
+        if (!placed)
+        {
+            MaxRectsBin & bin = bins.emplace_back(binDimensions);
+            if (!(placed = bin.insert(padded, aOptions.mAllowRotation)))
+            {
+                throw std::invalid_argument{
+                    "Rectangle of size " + std::to_string(size.width()) + "x" + std::to_string(size.height())
+                    + " does not fit in a page of size " + std::to_string(aOptions.mMaxPageSize.width())
+                    + "x" + std::to_string(aOptions.mMaxPageSize.height()) + "."};
+            }
+            placed->mPage = (int)bins.size() - 1;
+        }
+
+        packed = PackedRectangle{
+            .mPage = placed->mPage,
+            .mArea = {
+                placed->mArea.origin(),
+                {placed->mArea.width() - padding, placed->mArea.height() - padding}
+            },
+            .mRotated = placed->mRotated,
+        };
+    }
+
+    for (const MaxRectsBin & bin : bins)
+    {
+        const math::Size<2, int> used = bin.usedDimensions();
+        result.mPageSizes.push_back({used.width() - padding, used.height() - padding});
+    }
+
+    // When all rectangles are empty, no page was opened: an empty page ensures their page index is valid.
+    if (bins.empty() && !aSizes.empty())
+    {
+        result.mPageSizes.push_back({0, 0});
+    }
+
+    return result;
+}
+
+
+} // namespace arte
+} // namespace ad
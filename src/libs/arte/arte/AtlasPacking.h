@@ -0,0 +1,276 @@
+#pragma once
+
+
+#include "Image.h"
+#include "ImageView.h"
+
+#include <math/Rectangle.h>
+
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+
+
+struct PackingOptions
+{
+    /// \brief The maximum dimensions of a page, typically the maximum texture size.
+    math::Size<2, int> mMaxPageSize{4096, 4096};
+    /// \brief Count of empty pixels between packed rectangles, so filtering never samples a neighbour.
+    int mPadding{0};
+    /// \brief Allow rectangles to be rotated a quarter turn when it gives a better fit.
+    bool mAllowRotation{false};
+    /// \brief Pixel-identical sub-images share a single region of the atlas (only used by `packAtlas()`).
+    bool mDeduplicate{false};
+};
+
+
+/// \brief Placement of a rectangle in the pages of a packing.
+struct PackedRectangle
+{
+    /// \brief Empty rectangles are all on page 0, which exists (possibly empty) whenever there are rectangles.
+    int mPage;
+    /// \brief The area occupied in the page, whose dimensions are swapped if the rectangle is rotated.
+    math::Rectangle<int> mArea;
+    /// \brief If true, the pixel (x, y) of the source is at (y, width - 1 - x) in `mArea`
+    /// (where width is the source width).
+    bool mRotated{false};
+};
+
+
+/// \brief A single page of the MaxRects packing algorithm, keeping the maximal free rectangles.
+///
+/// see: Jylänki, "A Thousand Ways to Pack the Bin" (2010).
+/// Each rectangle is placed in the free rectangle minimizing its shortest leftover side
+/// ("best short side fit"), then the free rectangles overlapping it are split.
+class MaxRectsBin
+{
+public:
+    explicit MaxRectsBin(math::Size<2, int> aDimensions);
+
+    /// \return The area of the placed rectangle, or an empty optional if it does not fit.
+    std::optional<PackedRectangle> insert(math::Size<2, int> aDimensions, bool aAllowRotation);
+
+    /// \brief The dimensions of the bounding box of the placed rectangles, from the origin.
+    math::Size<2, int> usedDimensions() const
+    { return mUsedDimensions; }
+
+private:
+    void place(const math::Rectangle<int> & aNode);
+    void pruneFreeRectangles();
+
+    math::Size<2, int> mUsedDimensions{0, 0};
+    std::vector<math::Rectangle<int>> mFreeRectangles;
+};
+
+
+struct RectanglePacking
+{
+    /// \brief The placement of each rectangle, in the order they were provided.
+    std::vector<PackedRectangle> mRectangles;
+    /// \brief The dimensions of each page, as tight as the placed rectangles allow.
+    std::vector<math::Size<2, int>> mPageSizes;
+};
+
+
+/// \brief Pack the rectangles of `aSizes`, opening a new page each time a rectangle does not fit the
+/// existing pages.
+///
+/// The rectangles are inserted from the largest to the smallest, which gives much denser pages.
+/// \throw std::invalid_argument if a rectangle does not fit in an empty page.
+RectanglePacking packRectangles(std::span<const math::Size<2, int>> aSizes,
+                                const PackingOptions & aOptions = {});
+
+
+template <class T_pixelFormat>
+struct Atlas
+{
+    std::vector<Image<T_pixelFormat>> mPages;
+    /// \brief The placement of each sub-image, in the order they were provided.
+    std::vector<PackedRectangle> mPlacements;
+    /// \brief The size of the pixels that did not have to be stored, thanks to deduplication.
+    std::size_t mDeduplicatedBytes{0};
+};
+
+
+namespace detail {
+
+    /// \brief Fast non-cryptographic hash of `aSize` bytes, continuing from `aSeed`.
+    std::uint64_t hashBytes(const std::byte * aBytes, std::size_t aSize, std::uint64_t aSeed);
+
+} // namespace detail
+
+
+/// \brief Find the pixel-identical images among `aImages`.
+///
+/// Images are bucketed by a hash of their dimensions and pixels, then compared exactly within a bucket.
+/// \return For each image, the index of the first image identical to it (its own index if it is the first).
+template <class T_pixelFormat>
+std::vector<std::size_t> findDuplicates(std::span<const ImageView<const T_pixelFormat>> aImages);
+
+
+/// \brief Pack the `aSubImages` into as few pages as possible, the free space being `aBackground`.
+///
+/// This is denser than `stackVertical()`, whose width is the widest image and height the sum of all heights.
+/// With `PackingOptions::mDeduplicate`, identical sub-images are given the same placement.
+template <class T_pixelFormat>
+Atlas<T_pixelFormat> packAtlas(std::span<const ImageView<const T_pixelFormat>> aSubImages,
+                               T_pixelFormat aBackground,
+                               const PackingOptions & aOptions = {});
+
+
+//
+// Implementations
+//
+template <class T_pixelFormat>
+std::vector<std::size_t> findDuplicates(std::span<const ImageView<const T_pixelFormat>> aImages)
+{
+    auto hash = [](const ImageView<const T_pixelFormat> & aImage)
+    {
+        const math::Size<2, int> dimensions = aImage.dimensions();
+        std::uint64_t result = detail::hashBytes(reinterpret_cast<const std::byte *>(&dimensions),
+                                                 sizeof(dimensions), 0);
+        for (int row = 0; row != aImage.height(); ++row)
+        {
+            result = detail::hashBytes(reinterpret_cast<const std::byte *>(aImage.row(row)),
+                                       aImage.width() * sizeof(T_pixelFormat),
+                                       result);
+        }
+        return result;
+    };
+
+    auto identical = [](const ImageView<const T_pixelFormat> & aLhs, const ImageView<const T_pixelFormat> & aRhs)
+    {
+        if (!(aLhs.dimensions() == aRhs.dimensions()))
+        {
+            return false;
+        }
+        for (int row = 0; row != aLhs.height(); ++row)
+        {
+            if (std::memcmp(aLhs.row(row), aRhs.row(row), aLhs.width() * sizeof(T_pixelFormat)) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<std::size_t> firstIdentical(aImages.size());
+    // Associate the hash of each distinct image to its index.
+    std::unordered_multimap<std::uint64_t, std::size_t> distinct;
+    for (std::size_t index = 0; index != aImages.size(); ++index)
+    {
+        const std::uint64_t imageHash = hash(aImages[index]);
+        firstIdentical[index] = index;
+
+        auto [candidate, last] = distinct.equal_range(imageHash);
+        for (; candidate != last; ++candidate)
+        {
+            if (identical(aImages[candidate->second], aImages[index]))
+            {
+                firstIdentical[index] = candidate->second;
+                break;
+            }
+        }
+
+        if (firstIdentical[index] == index)
+        {
+            distinct.emplace(imageHash, index);
+        }
+    }
+    return firstIdentical;
+}
+
+
+template <class T_pixelFormat>
+Atlas<T_pixelFormat> packAtlas(std::span<const ImageView<const T_pixelFormat>> aSubImages,
+                               T_pixelFormat aBackground,
+                               const PackingOptions & aOptions)
+{
+    std::vector<std::size_t> firstIdentical(aSubImages.size());
+    if (aOptions.mDeduplicate)
+    {
+        firstIdentical = findDuplicates(aSubImages);
+    }
+    else
+    {
+        std::iota(firstIdentical.begin(), firstIdentical.end(), 0);
+    }
+
+    Atlas<T_pixelFormat> atlas;
+
+    // Only the distinct sub-images are packed, each one is associated to its packed rectangle.
+    std::vector<std::size_t> packedIndex(aSubImages.size());
+    std::vector<math::Size<2, int>> sizes;
+    sizes.reserve(aSubImages.size());
+    for (std::size_t index = 0; index != aSubImages.size(); ++index)
+    {
+        const ImageView<const T_pixelFormat> & subImage = aSubImages[index];
+        if (firstIdentical[index] == index)
+        {
+            packedIndex[index] = sizes.size();
+            sizes.push_back(subImage.dimensions());
+        }
+        else
+        {
+            packedIndex[index] = packedIndex[firstIdentical[index]];
+            atlas.mDeduplicatedBytes += subImage.dimensions().area() * sizeof(T_pixelFormat);
+        }
+    }
+
+    RectanglePacking packing = packRectangles(sizes, aOptions);
+
+    for (math::Size<2, int> pageSize : packing.mPageSizes)
+    {
+        atlas.mPages.emplace_back(pageSize, aBackground);
+    }
+
+    atlas.mPlacements.reserve(aSubImages.size());
+    for (std::size_t index = 0; index != aSubImages.size(); ++index)
+    {
+        const PackedRectangle & placement = packing.mRectangles[packedIndex[index]];
+        atlas.mPlacements.push_back(placement);
+        if (firstIdentical[index] != index)
+        {
+            continue;
+        }
+
+        const ImageView<const T_pixelFormat> & source = aSubImages[index];
+        if (source.width() == 0 || source.height() == 0)
+        {
+            // Nothing to copy, and the page of an empty placement might have no pixels at all.
+            continue;
+        }
+
+        Image<T_pixelFormat> & page = atlas.mPages[placement.mPage];
+
+        if (!placement.mRotated)
+        {
+            page.pasteFrom(source, placement.mArea.origin());
+        }
+        else
+        {
+            for (int y = 0; y != source.height(); ++y)
+            {
+                const T_pixelFormat * sourceRow = source.row(y);
+                for (int x = 0; x != source.width(); ++x)
+                {
+                    page.at(placement.mArea.x() + y, placement.mArea.y() + source.width() - 1 - x) = sourceRow[x];
+                }
+            }
+        }
+    }
+
+    return atlas;
+}
+
+
+} // namespace arte
+} // namespace ad
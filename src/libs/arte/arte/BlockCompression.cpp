@@ -0,0 +1,729 @@
+#include "BlockCompression.h"
+
+#include "detail/PixelKernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+
+namespace ad {
+namespace arte {
+
+
+namespace {
+
+
+    constexpr int gBlockPixels = gBlockSize * gBlockSize;
+
+    /// \brief The 16 pixels of a block, as consecutive RGBA bytes.
+    using Block = std::array<std::uint8_t, 4 * gBlockPixels>;
+    using Indices = std::array<std::uint8_t, gBlockPixels>;
+    using Endpoint = std::array<float, 4>;
+
+
+    /// \brief Copy the block at `aBlockPosition` (in blocks) to `aBlock`,
+    /// pixels outside of `aSource` replicating the closest edge.
+    template <class T_pixel>
+    void fetchBlock(ImageView<const T_pixel> aSource, math::Position<2, int> aBlockPosition, Block & aBlock)
+    {
+        for (int y = 0; y != gBlockSize; ++y)
+        {
+            const int row = std::min(aBlockPosition.y() * gBlockSize + y, aSource.height() - 1);
+            const auto * line = reinterpret_cast<const std::uint8_t *>(aSource.row(row));
+            for (int x = 0; x != gBlockSize; ++x)
+            {
+                const int column = std::min(aBlockPosition.x() * gBlockSize + x, aSource.width() - 1);
+                std::uint8_t * destination = aBlock.data() + 4 * (y * gBlockSize + x);
+                if constexpr (sizeof(T_pixel) == 4)
+                {
+                    std::memcpy(destination, line + 4 * column, 4);
+                }
+                else
+                {
+                    // Single channel, placed in red (the other channels do not contribute to the error).
+                    destination[0] = line[column];
+                    destination[1] = destination[2] = destination[3] = 0;
+                }
+            }
+        }
+    }
+
+
+    /// \brief Principal axis endpoints of the `aChannels` first channels of the block pixels:
+    /// the extreme projections of the pixels on the axis of largest variance.
+    void principalEndpoints(const Block & aBlock, int aChannels, Endpoint & aFirst, Endpoint & aSecond)
+    {
+        Endpoint mean{};
+        for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+        {
+            for (int c = 0; c != aChannels; ++c)
+            {
+                mean[c] += aBlock[4 * pixel + c];
+            }
+        }
+        for (float & value : mean)
+        {
+            value /= gBlockPixels;
+        }
+
+        float covariance[4][4]{};
+        for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+        {
+            for (int i = 0; i != aChannels; ++i)
+            {
+                for (int j = 0; j != aChannels; ++j)
+                {
+                    covariance[i][j] += (aBlock[4 * pixel + i] - mean[i]) * (aBlock[4 * pixel + j] - mean[j]);
+                }
+            }
+        }
+
+        // Power iteration, starting from the diagonal of the bounding box.
+        Endpoint axis{};
+        for (int c = 0; c != aChannels; ++c)
+        {
+            std::uint8_t low = 255, high = 0;
+            for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+            {
+                low = std::min(low, aBlock[4 * pixel + c]);
+                high = std::max(high, aBlock[4 * pixel + c]);
+            }
+            axis[c] = float(high - low) + 1.f;
+        }
+        for (int iteration = 0; iteration != 8; ++iteration)
+        {
+            Endpoint next{};
+            float norm = 0.f;
+            for (int i = 0; i != aChannels; ++i)
+            {
+                for (int j = 0; j != aChannels; ++j)
+                {
+                    next[i] += covariance[i][j] * axis[j];
+                }
+                norm = std::max(norm, std::abs(next[i]));
+            }
+            if (norm == 0.f)
+            {
+                break;
+            }
+            for (int c = 0; c != aChannels; ++c)
+            {
+                axis[c] = next[c] / norm;
+            }
+        }
+
+        float lowest = std::numeric_limits<float>::max();
+        float highest = std::numeric_limits<float>::lowest();
+        for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+        {
+            float projection = 0.f;
+            for (int c = 0; c != aChannels; ++c)
+            {
+                projection += (aBlock[4 * pixel + c] - mean[c]) * axis[c];
+            }
+            lowest = std::min(lowest, projection);
+            highest = std::max(highest, projection);
+        }
+
+        float squaredNorm = 0.f;
+        for (int c = 0; c != aChannels; ++c)
+        {
+            squaredNorm += axis[c] * axis[c];
+        }
+        if (squaredNorm == 0.f)
+        {
+            aFirst = aSecond = mean;
+            return;
+        }
+        for (int c = 0; c != aChannels; ++c)
+        {
+            aFirst[c] = mean[c] + axis[c] * lowest / squaredNorm;
+            aSecond[c] = mean[c] + axis[c] * highest / squaredNorm;
+        }
+    }
+
+
+    /// \brief Least squares endpoints for the selected `aIndices`,
+    /// where `aWeights[index]` is the position of the palette color from the first to the second endpoint.
+    /// \return false if the system is degenerate (all pixels selected the same weight).
+    bool refineEndpoints(const Block & aBlock, int aChannels, const Indices & aIndices, const float * aWeights,
+                         Endpoint & aFirst, Endpoint & aSecond)
+    {
+        float aa = 0.f, ab = 0.f, bb = 0.f;
+        Endpoint ax{}, bx{};
+        for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+        {
+            const float b = aWeights[aIndices[pixel]];
+            const float a = 1.f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c != aChannels; ++c)
+            {
+                ax[c] += a * aBlock[4 * pixel + c];
+                bx[c] += b * aBlock[4 * pixel + c];
+            }
+        }
+
+        const float determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) < 1e-6f)
+        {
+            return false;
+        }
+        for (int c = 0; c != aChannels; ++c)
+        {
+            aFirst[c] = std::clamp((bb * ax[c] - ab * bx[c]) / determinant, 0.f, 255.f);
+            aSecond[c] = std::clamp((aa * bx[c] - ab * ax[c]) / determinant, 0.f, 255.f);
+        }
+        return true;
+    }
+
+
+    //
+    // BC1
+    //
+    std::uint16_t quantize565(const Endpoint & aColor)
+    {
+        auto quantize = [](float aValue, int aMax)
+        {
+            return (std::uint16_t)std::clamp(std::lround(aValue * aMax / 255.f), 0l, (long)aMax);
+        };
+        return (std::uint16_t)((quantize(aColor[0], 31) << 11) | (quantize(aColor[1], 63) << 5)
+                               | quantize(aColor[2], 31));
+    }
+
+    std::array<std::uint8_t, 4> expand565(std::uint16_t aColor)
+    {
+        const int r = (aColor >> 11) & 0x1F;
+        const int g = (aColor >> 5) & 0x3F;
+        const int b = aColor & 0x1F;
+        return {(std::uint8_t)((r << 3) | (r >> 2)),
+                (std::uint8_t)((g << 2) | (g >> 4)),
+                (std::uint8_t)((b << 3) | (b >> 2)),
+                255};
+    }
+
+    /// \brief The BC1 palette: four opaque colors, or three colors and transparent black.
+    std::array<std::uint8_t, 16> paletteBc1(std::uint16_t aFirst, std::uint16_t aSecond, bool aFourColors)
+    {
+        const auto first = expand565(aFirst);
+        const auto second = expand565(aSecond);
+        std::array<std::uint8_t, 16> palette;
+        for (int c = 0; c != 4; ++c)
+        {
+            palette[c] = first[c];
+            palette[4 + c] = second[c];
+            if (aFourColors)
+            {
+                palette[8 + c] = (std::uint8_t)((2 * first[c] + second[c]) / 3);
+                palette[12 + c] = (std::uint8_t)((first[c] + 2 * second[c]) / 3);
+            }
+            else
+            {
+                palette[8 + c] = (std::uint8_t)((first[c] + second[c]) / 2);
+                palette[12 + c] = 0;
+            }
+        }
+        if (!aFourColors)
+        {
+            palette[15] = 0; // transparent black
+        }
+        return palette;
+    }
+
+    // Position of each palette color between the endpoints, by index.
+    constexpr float gWeightsBc1[4]{0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+
+    struct ColorCandidate
+    {
+        std::uint16_t mFirst;
+        std::uint16_t mSecond;
+        Indices mIndices;
+        std::uint32_t mError;
+    };
+
+    ColorCandidate evaluateBc1(const Block & aOpaque, const Endpoint & aFirst, const Endpoint & aSecond)
+    {
+        ColorCandidate candidate{quantize565(aFirst), quantize565(aSecond)};
+        if (candidate.mFirst < candidate.mSecond)
+        {
+            std::swap(candidate.mFirst, candidate.mSecond);
+        }
+        const auto palette = paletteBc1(candidate.mFirst, candidate.mSecond, true);
+        candidate.mError = detail::kernels::selectPaletteIndices(aOpaque.data(), palette.data(), 4,
+                                                                 candidate.mIndices.data());
+        return candidate;
+    }
+
+    /// \param aBlock The block pixels, its alpha is ignored.
+    void encodeBc1(const Block & aBlock, std::uint8_t * aOutput)
+    {
+        Block opaque = aBlock;
+        for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+        {
+            opaque[4 * pixel + 3] = 255;
+        }
+
+        Endpoint first, second;
+        principalEndpoints(opaque, 3, first, second);
+        ColorCandidate best = evaluateBc1(opaque, first, second);
+        for (int iteration = 0; iteration != 2 && best.mError != 0; ++iteration)
+        {
+            if (!refineEndpoints(opaque, 3, best.mIndices, gWeightsBc1, first, second))
+            {
+                break;
+            }
+            ColorCandidate refined = evaluateBc1(opaque, first, second);
+            if (refined.mError >= best.mError)
+            {
+                break;
+            }
+            best = refined;
+        }
+
+        std::uint32_t indices = 0;
+        if (best.mFirst != best.mSecond)
+        {
+            for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+            {
+                indices |= std::uint32_t{best.mIndices[pixel]} << (2 * pixel);
+            }
+        }
+        // Otherwise, equal endpoints select the 3 colors mode: all pixels use index 0.
+
+        aOutput[0] = (std::uint8_t)best.mFirst;
+        aOutput[1] = (std::uint8_t)(best.mFirst >> 8);
+        aOutput[2] = (std::uint8_t)best.mSecond;
+        aOutput[3] = (std::uint8_t)(best.mSecond >> 8);
+        for (int i = 0; i != 4; ++i)
+        {
+            aOutput[4 + i] = (std::uint8_t)(indices >> (8 * i));
+        }
+    }
+
+
+    //
+    // BC4
+    //
+    std::array<std::uint8_t, 8> paletteBc4(std::uint8_t aFirst, std::uint8_t aSecond)
+    {
+        std::array<std::uint8_t, 8> palette{aFirst, aSecond};
+        if (aFirst > aSecond)
+        {
+            for (int i = 1; i != 7; ++i)
+            {
+                palette[1 + i] = (std::uint8_t)(((7 - i) * aFirst + i * aSecond + 3) / 7);
+            }
+        }
+        else
+        {
+            for (int i = 1; i != 5; ++i)
+            {
+                palette[1 + i] = (std::uint8_t)(((5 - i) * aFirst + i * aSecond + 2) / 5);
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+        return palette;
+    }
+
+    /// \param aChannel The channel of the block pixels to encode.
+    void encodeBc4(const Block & aBlock, int aChannel, std::uint8_t * aOutput)
+    {
+        std::uint8_t low = 255, high = 0;
+        for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+        {
+            low = std::min(low, aBlock[4 * pixel + aChannel]);
+            high = std::max(high, aBlock[4 * pixel + aChannel]);
+        }
+
+        aOutput[0] = high;
+        aOutput[1] = low;
+        std::uint64_t indices = 0;
+        if (high != low)
+        {
+            // The kernel works on RGBA, the values are moved to the red channel of the block and palette.
+            Block values{};
+            for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+            {
+                values[4 * pixel] = aBlock[4 * pixel + aChannel];
+            }
+            const auto levels = paletteBc4(high, low);
+            std::array<std::uint8_t, 4 * 8> palette{};
+            for (int i = 0; i != 8; ++i)
+            {
+                palette[4 * i] = levels[i];
+            }
+
+            Indices selected;
+            detail::kernels::selectPaletteIndices(values.data(), palette.data(), 8, selected.data());
+            for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+            {
+                indices |= std::uint64_t{selected[pixel]} << (3 * pixel);
+            }
+        }
+        for (int i = 0; i != 6; ++i)
+        {
+            aOutput[2 + i] = (std::uint8_t)(indices >> (8 * i));
+        }
+    }
+
+
+    //
+    // BC7 (mode 6)
+    //
+    constexpr int gWeightsBc7[16]{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    constexpr std::array<float, 16> gWeightsBc7Float = []
+    {
+        std::array<float, 16> weights{};
+        for (int i = 0; i != 16; ++i)
+        {
+            weights[i] = gWeightsBc7[i] / 64.f;
+        }
+        return weights;
+    }();
+
+    std::uint8_t interpolateBc7(int aFirst, int aSecond, int aIndex)
+    {
+        return (std::uint8_t)(((64 - gWeightsBc7[aIndex]) * aFirst + gWeightsBc7[aIndex] * aSecond + 32) >> 6);
+    }
+
+    /// \brief A mode 6 endpoint: 7 bits per channel, and a shared least significant bit.
+    struct EndpointBc7
+    {
+        std::array<std::uint8_t, 4> mValues; // 7 bits
+        std::uint8_t mPBit;
+
+        std::uint8_t channel(int aChannel) const
+        { return (std::uint8_t)((mValues[aChannel] << 1) | mPBit); }
+    };
+
+    EndpointBc7 quantizeBc7(const Endpoint & aEndpoint)
+    {
+        EndpointBc7 best{};
+        float bestError = std::numeric_limits<float>::max();
+        for (std::uint8_t pBit : {0, 1})
+        {
+            EndpointBc7 candidate{.mPBit = pBit};
+            float error = 0.f;
+            for (int c = 0; c != 4; ++c)
+            {
+                candidate.mValues[c] =
+                    (std::uint8_t)std::clamp(std::lround((aEndpoint[c] - pBit) / 2.f), 0l, 127l);
+                const float difference = candidate.channel(c) - aEndpoint[c];
+                error += difference * difference;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                best = candidate;
+            }
+        }
+        return best;
+    }
+
+    struct CandidateBc7
+    {
+        EndpointBc7 mFirst;
+        EndpointBc7 mSecond;
+        Indices mIndices;
+        std::uint32_t mError;
+    };
+
+    CandidateBc7 evaluateBc7(const Block & aBlock, const Endpoint & aFirst, const Endpoint & aSecond)
+    {
+        CandidateBc7 candidate{quantizeBc7(aFirst), quantizeBc7(aSecond)};
+        std::array<std::uint8_t, 4 * 16> palette;
+        for (int index = 0; index != 16; ++index)
+        {
+            for (int c = 0; c != 4; ++c)
+            {
+                palette[4 * index + c] =
+                    interpolateBc7(candidate.mFirst.channel(c), candidate.mSecond.channel(c), index);
+            }
+        }
+        candidate.mError = detail::kernels::selectPaletteIndices(aBlock.data(), palette.data(), 16,
+                                                                 candidate.mIndices.data());
+        return candidate;
+    }
+
+    /// \brief Little endian bit writer for the 128 bits of a BC7 block.
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::uint8_t * aOutput) :
+            mOutput{aOutput}
+        {
+            std::fill(mOutput, mOutput + 16, 0);
+        }
+
+        void write(std::uint32_t aValue, int aBitCount)
+        {
+            for (int bit = 0; bit != aBitCount; ++bit, ++mPosition)
+            {
+                mOutput[mPosition / 8] |= (std::uint8_t)(((aValue >> bit) & 1) << (mPosition % 8));
+            }
+        }
+
+    private:
+        std::uint8_t * mOutput;
+        int mPosition{0};
+    };
+
+    void encodeBc7(const Block & aBlock, std::uint8_t * aOutput)
+    {
+        Endpoint first, second;
+        principalEndpoints(aBlock, 4, first, second);
+        CandidateBc7 best = evaluateBc7(aBlock, first, second);
+        for (int iteration = 0; iteration != 2 && best.mError != 0; ++iteration)
+        {
+            if (!refineEndpoints(aBlock, 4, best.mIndices, gWeightsBc7Float.data(), first, second))
+            {
+                break;
+            }
+            CandidateBc7 refined = evaluateBc7(aBlock, first, second);
+            if (refined.mError >= best.mError)
+            {
+                break;
+            }
+            best = refined;
+        }
+
+        // The most significant bit of the first pixel index is implicitly 0 (the "anchor"),
+        // which is obtained by swapping the endpoints if needed.
+        if (best.mIndices[0] >= 8)
+        {
+            std::swap(best.mFirst, best.mSecond);
+            for (std::uint8_t & index : best.mIndices)
+            {
+                index = (std::uint8_t)(15 - index);
+            }
+        }
+
+        BitWriter writer{aOutput};
+        writer.write(1 << 6, 7); // mode 6
+        for (int c = 0; c != 4; ++c)
+        {
+            writer.write(best.mFirst.mValues[c], 7);
+            writer.write(best.mSecond.mValues[c], 7);
+        }
+        writer.write(best.mFirst.mPBit, 1);
+        writer.write(best.mSecond.mPBit, 1);
+        writer.write(best.mIndices[0], 3);
+        for (int pixel = 1; pixel != gBlockPixels; ++pixel)
+        {
+            writer.write(best.mIndices[pixel], 4);
+        }
+    }
+
+
+    template <class T_pixel>
+    CompressedImage compressImpl(ImageView<const T_pixel> aSource,
+                                 BlockFormat aFormat,
+                                 const Execution & aExecution)
+    {
+        if (aSource.width() <= 0 || aSource.height() <= 0)
+        {
+            throw std::domain_error{"Cannot compress an empty image."};
+        }
+
+        CompressedImage result{.mFormat = aFormat, .mDimensions = aSource.dimensions()};
+        const math::Size<2, int> blocks = result.blockCounts();
+        const std::size_t blockBytes = getBlockBytes(aFormat);
+        result.mBlocks.resize(blocks.area() * blockBytes);
+
+        aExecution.forEachBand(blocks.height(), [&](int aFirstRow, int aEndRow)
+        {
+            Block block;
+            for (int blockRow = aFirstRow; blockRow != aEndRow; ++blockRow)
+            {
+                auto * output = reinterpret_cast<std::uint8_t *>(
+                    result.mBlocks.data() + (std::size_t)blockRow * blocks.width() * blockBytes);
+                for (int blockColumn = 0; blockColumn != blocks.width(); ++blockColumn, output += blockBytes)
+                {
+                    fetchBlock(aSource, {blockColumn, blockRow}, block);
+                    switch (aFormat)
+                    {
+                    case BlockFormat::Bc1:
+                        encodeBc1(block, output);
+                        break;
+                    case BlockFormat::Bc3:
+                        encodeBc4(block, 3, output);
+                        encodeBc1(block, output + 8);
+                        break;
+                    case BlockFormat::Bc4:
+                        encodeBc4(block, 0, output);
+                        break;
+                    case BlockFormat::Bc7:
+                        encodeBc7(block, output);
+                        break;
+                    }
+                }
+            }
+        });
+
+        return result;
+    }
+
+
+    //
+    // Decoding
+    //
+    void decodeBc1(const std::uint8_t * aInput, bool aAllowThreeColors, Block & aBlock)
+    {
+        const std::uint16_t first = (std::uint16_t)(aInput[0] | (aInput[1] << 8));
+        const std::uint16_t second = (std::uint16_t)(aInput[2] | (aInput[3] << 8));
+        const auto palette = paletteBc1(first, second, !aAllowThreeColors || first > second);
+        for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+        {
+            const int index = (aInput[4 + pixel / 4] >> (2 * (pixel % 4))) & 0x03;
+            std::copy_n(palette.data() + 4 * index, 4, aBlock.data() + 4 * pixel);
+        }
+    }
+
+    void decodeBc4(const std::uint8_t * aInput, int aChannel, Block & aBlock)
+    {
+        const auto palette = paletteBc4(aInput[0], aInput[1]);
+        std::uint64_t indices = 0;
+        for (int i = 0; i != 6; ++i)
+        {
+            indices |= std::uint64_t{aInput[2 + i]} << (8 * i);
+        }
+        for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+        {
+            aBlock[4 * pixel + aChannel] = palette[(indices >> (3 * pixel)) & 0x07];
+        }
+    }
+
+    void decodeBc7(const std::uint8_t * aInput, Block & aBlock)
+    {
+        int position = 0;
+        auto read = [&](int aBitCount)
+        {
+            std::uint32_t value = 0;
+            for (int bit = 0; bit != aBitCount; ++bit, ++position)
+            {
+                value |= ((aInput[position / 8] >> (position % 8)) & 1u) << bit;
+            }
+            return value;
+        };
+
+        if (read(7) != (1 << 6))
+        {
+            throw std::runtime_error{"Only mode 6 BC7 blocks can be decoded."};
+        }
+        std::array<std::uint32_t, 4> first, second;
+        for (int c = 0; c != 4; ++c)
+        {
+            first[c] = read(7) << 1;
+            second[c] = read(7) << 1;
+        }
+        const std::uint32_t firstPBit = read(1);
+        const std::uint32_t secondPBit = read(1);
+        for (int pixel = 0; pixel != gBlockPixels; ++pixel)
+        {
+            const int index = (int)read(pixel == 0 ? 3 : 4);
+            for (int c = 0; c != 4; ++c)
+            {
+                aBlock[4 * pixel + c] = interpolateBc7(first[c] | firstPBit, second[c] | secondPBit, index);
+            }
+        }
+    }
+
+
+} // anonymous namespace
+
+
+CompressedImage compressBlocks(ImageView<const math::sdr::Rgba> aSource,
+                               BlockFormat aFormat,
+                               const Execution & aExecution)
+{
+    if (aFormat == BlockFormat::Bc4)
+    {
+        throw std::domain_error{"Bc4 compresses single channel images."};
+    }
+    return compressImpl(aSource, aFormat, aExecution);
+}
+
+
+CompressedImage compressBlocks(ImageView<const math::sdr::Grayscale> aSource,
+                               const Execution & aExecution)
+{
+    return compressImpl(aSource, BlockFormat::Bc4, aExecution);
+}
+
+
+template <class T_pixelFormat>
+Image<T_pixelFormat> decompressBlocks(const CompressedImage & aCompressed)
+{
+    constexpr bool isGrayscale = (sizeof(T_pixelFormat) == 1);
+    if (isGrayscale != (aCompressed.mFormat == BlockFormat::Bc4))
+    {
+        throw std::domain_error{"The pixel format does not match the block format."};
+    }
+
+    const math::Size<2, int> blocks = aCompressed.blockCounts();
+    const std::size_t blockBytes = getBlockBytes(aCompressed.mFormat);
+    if (aCompressed.mBlocks.size() != blocks.area() * blockBytes)
+    {
+        throw std::runtime_error{"Invalid compressed image: "
+                                 + std::to_string(aCompressed.mBlocks.size()) + " bytes of blocks."};
+    }
+
+    auto image = Image<T_pixelFormat>::makeUninitialized(aCompressed.mDimensions);
+    const auto * input = reinterpret_cast<const std::uint8_t *>(aCompressed.data());
+    Block block;
+    for (int blockRow = 0; blockRow != blocks.height(); ++blockRow)
+    {
+        for (int blockColumn = 0; blockColumn != blocks.width(); ++blockColumn, input += blockBytes)
+        {
+            switch (aCompressed.mFormat)
+            {
+            case BlockFormat::Bc1:
+                decodeBc1(input, true, block);
+                break;
+            case BlockFormat::Bc3:
+                decodeBc1(input + 8, false, block);
+                decodeBc4(input, 3, block);
+                break;
+            case BlockFormat::Bc4:
+                decodeBc4(input, 0, block);
+                break;
+            case BlockFormat::Bc7:
+                decodeBc7(input, block);
+                break;
+            }
+
+            for (int y = 0; y != gBlockSize; ++y)
+            {
+                const int row = blockRow * gBlockSize + y;
+                if (row >= image.height())
+                {
+                    break;
+                }
+                auto * line = reinterpret_cast<std::uint8_t *>(image.row(row));
+                for (int x = 0; x != gBlockSize && blockColumn * gBlockSize + x < image.width(); ++x)
+                {
+                    const int column = blockColumn * gBlockSize + x;
+                    const std::uint8_t * pixel = block.data() + 4 * (y * gBlockSize + x);
+                    std::copy_n(pixel, sizeof(T_pixelFormat), line + sizeof(T_pixelFormat) * column);
+                }
+            }
+        }
+    }
+    return image;
+}
+
+
+template Image<math::sdr::Rgba> decompressBlocks(const CompressedImage &);
+template Image<math::sdr::Grayscale> decompressBlocks(const CompressedImage &);
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,97 @@
+#pragma once
+
+
+#include "Execution.h"
+#include "Image.h"
+#include "ImageView.h"
+
+#include <math/Color.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief The GPU block compression formats, each encoding blocks of 4x4 pixels in a fixed size.
+enum class BlockFormat
+{
+    /// \brief RGB, 8 bytes per block, the alpha channel is ignored.
+    Bc1,
+    /// \brief RGBA, 16 bytes per block: an alpha block (as Bc4) followed by a Bc1 color block.
+    Bc3,
+    /// \brief Single channel, 8 bytes per block.
+    Bc4,
+    /// \brief RGBA, 16 bytes per block, with a much lower error than Bc3.
+    /// \note The encoder only produces mode 6 blocks (a single pair of RGBA endpoints, 16 levels).
+    Bc7,
+};
+
+
+constexpr int gBlockSize = 4;
+
+
+constexpr std::size_t getBlockBytes(BlockFormat aFormat)
+{
+    switch (aFormat)
+    {
+    case BlockFormat::Bc1:
+    case BlockFormat::Bc4:
+        return 8;
+    case BlockFormat::Bc3:
+    case BlockFormat::Bc7:
+        return 16;
+    }
+    throw std::domain_error{"Invalid block format."};
+}
+
+
+/// \brief The blocks encoding an image, by rows of blocks starting from the first row of the image.
+///
+/// The blocks on the right and bottom edges cover pixels outside of the image when its dimensions
+/// are not multiples of gBlockSize, those pixels replicate the closest edge.
+struct CompressedImage
+{
+    math::Size<2, int> blockCounts() const
+    {
+        return {(mDimensions.width() + gBlockSize - 1) / gBlockSize,
+                (mDimensions.height() + gBlockSize - 1) / gBlockSize};
+    }
+
+    const std::byte * data() const
+    { return mBlocks.data(); }
+
+    std::size_t size_bytes() const
+    { return mBlocks.size(); }
+
+    BlockFormat mFormat;
+    math::Size<2, int> mDimensions;
+    std::vector<std::byte> mBlocks;
+};
+
+
+/// \brief Encode `aSource` into blocks of `aFormat`, which must be Bc1, Bc3 or Bc7.
+///
+/// The rows of blocks are distributed according to `aExecution`, the result does not depend on it.
+CompressedImage compressBlocks(ImageView<const math::sdr::Rgba> aSource,
+                               BlockFormat aFormat,
+                               const Execution & aExecution = {});
+
+/// \brief Encode `aSource` into Bc4 blocks.
+CompressedImage compressBlocks(ImageView<const math::sdr::Grayscale> aSource,
+                               const Execution & aExecution = {});
+
+
+/// \brief Decode the blocks of `aCompressed`, to measure the encoding error on the CPU.
+///
+/// `T_pixelFormat` is Rgba for the Bc1, Bc3 and Bc7 formats, Grayscale for Bc4.
+/// \attention Only the Bc7 blocks in mode 6 (as produced by compressBlocks()) can be decoded.
+template <class T_pixelFormat>
+Image<T_pixelFormat> decompressBlocks(const CompressedImage & aCompressed);
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,130 @@
+#pragma once
+
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief Describes how whole-image operations distribute their rows.
+///
+/// A default constructed Execution is serial, processing all rows on the calling thread.
+/// A parallel Execution splits the rows in bands, which are processed concurrently by the workers
+/// of a ThreadPool. The operations compute each row independently, so the results do not depend
+/// on the execution.
+class Execution
+{
+public:
+    /// \brief Serial execution, on the calling thread.
+    Execution() = default;
+
+    /// \brief Split the rows into bands processed by the workers of `aPool`.
+    ///
+    /// A pool without workers would never process the bands, the execution is then serial.
+    /// \param aBandRows The number of rows in each band, 0 chooses a few bands per worker.
+    explicit Execution(ThreadPool & aPool, int aBandRows = 0) :
+        mPool{&aPool},
+        mBandRows{aBandRows}
+    {}
+
+    bool isParallel() const
+    { return mPool != nullptr && mPool->size() != 0; }
+
+    /// \brief Invoke `aBand(firstRow, endRow)` on disjoint bands covering the rows [0, aRowCount).
+    ///
+    /// The calling thread also processes bands, and only returns once all of them are completed.
+    /// This means it cannot deadlock even when invoked from one of the pool's workers.
+    /// If any band throws, the first exception is rethrown from the calling thread.
+    template <class F_band>
+    void forEachBand(int aRowCount, F_band && aBand) const;
+
+private:
+    ThreadPool * mPool{nullptr};
+    int mBandRows{0};
+};
+
+
+//
+// Implementations
+//
+template <class F_band>
+void Execution::forEachBand(int aRowCount, F_band && aBand) const
+{
+    if (!isParallel() || aRowCount <= 1)
+    {
+        aBand(0, aRowCount);
+        return;
+    }
+
+    // Several bands per worker, so the load is balanced when some rows are costlier.
+    const int bandsPerWorker = 4;
+    const int bandRows = mBandRows > 0 ?
+        mBandRows
+        : std::max(1, aRowCount / static_cast<int>(mPool->size() * bandsPerWorker));
+    const int bandCount = (aRowCount + bandRows - 1) / bandRows;
+
+    struct State
+    {
+        std::atomic<int> mNext{0};
+        std::atomic<int> mCompleted{0};
+        std::mutex mMutex;
+        std::condition_variable mAllCompleted;
+        std::exception_ptr mError;
+    };
+    // Shared, because the pool might only start a task after all the bands are completed.
+    auto state = std::make_shared<State>();
+
+    // The band function is only accessed while some bands are not completed,
+    // so while the calling thread is still waiting.
+    auto drain = [state, bandRows, bandCount, aRowCount, &aBand]()
+    {
+        for (int band = state->mNext++; band < bandCount; band = state->mNext++)
+        {
+            try
+            {
+                aBand(band * bandRows, std::min(aRowCount, (band + 1) * bandRows));
+            }
+            catch (...)
+            {
+                std::lock_guard lock{state->mMutex};
+                if (!state->mError)
+                {
+                    state->mError = std::current_exception();
+                }
+            }
+
+            if (++state->mCompleted == bandCount)
+            {
+                std::lock_guard lock{state->mMutex};
+                state->mAllCompleted.notify_all();
+            }
+        }
+    };
+
+    const std::size_t helpers = std::min<std::size_t>(mPool->size(), bandCount - 1);
+    for (std::size_t i = 0; i != helpers; ++i)
+    {
+        mPool->push(drain);
+    }
+    drain();
+
+    std::unique_lock lock{state->mMutex};
+    state->mAllCompleted.wait(lock, [&](){ return state->mCompleted == bandCount; });
+    if (state->mError)
+    {
+        std::rethrow_exception(state->mError);
+    }
+}
+
+
+} // namespace arte
+} // namespace ad
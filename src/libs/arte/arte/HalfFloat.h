@@ -0,0 +1,123 @@
+#pragma once
+
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief Convert `aValue` to the bits of an IEEE 754 binary16, rounding to nearest even.
+///
+/// Magnitudes above the largest finite half (65504) become infinities, NaNs stay (quiet) NaNs.
+inline std::uint16_t toHalfBits(float aValue)
+{
+    const std::uint32_t bits = std::bit_cast<std::uint32_t>(aValue);
+    const std::uint32_t sign = (bits >> 16) & 0x8000;
+    std::uint32_t magnitude = bits & 0x7FFFFFFF;
+
+    if (magnitude >= 0x7F800000) // infinity or NaN
+    {
+        const std::uint32_t nanPayload = (magnitude > 0x7F800000) ? 0x0200 | ((magnitude >> 13) & 0x3FF) : 0;
+        return (std::uint16_t)(sign | 0x7C00 | nanPayload);
+    }
+    else if (magnitude >= 0x47800000) // 2^16, rounds to infinity
+    {
+        return (std::uint16_t)(sign | 0x7C00);
+    }
+    else if (magnitude < 0x38800000) // 2^-14, the smallest normal half
+    {
+        // Adding 0.5 aligns the value on the subnormal half quantum (2^-24), with the FPU rounding.
+        const float aligned = std::bit_cast<float>(magnitude) + 0.5f;
+        return (std::uint16_t)(sign | (std::bit_cast<std::uint32_t>(aligned) - 0x3F000000));
+    }
+
+    // Rebias the exponent (from 127 to 15) and round the 13 dropped mantissa bits to nearest even,
+    // a carry into the exponent giving the correct result (up to infinity).
+    const std::uint32_t odd = (magnitude >> 13) & 1;
+    magnitude += 0xC8000FFF + odd;
+    return (std::uint16_t)(sign | (magnitude >> 13));
+}
+
+
+/// \brief Convert the IEEE 754 binary16 `aBits` to float, which is always exact.
+inline float fromHalfBits(std::uint16_t aBits)
+{
+    const std::uint32_t sign = std::uint32_t{aBits & 0x8000u} << 16;
+    const std::uint32_t exponent = (aBits >> 10) & 0x1F;
+    const std::uint32_t mantissa = aBits & 0x3FF;
+
+    if (exponent == 0x1F)
+    {
+        return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+    }
+    else if (exponent == 0)
+    {
+        // Zero or subnormal: mantissa * 2^-24
+        const float magnitude = mantissa * (1.f / 16777216.f);
+        return sign ? -magnitude : magnitude;
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+
+/// \brief A 16-bit floating point value, the channel type of the half-float pixels.
+///
+/// It only stores the value, computations are done in float through the implicit conversions.
+struct Half
+{
+    static Half FromBits(std::uint16_t aBits)
+    {
+        Half result;
+        result.mBits = aBits;
+        return result;
+    }
+
+    Half() = default;
+
+    /*implicit*/ Half(float aValue) :
+        mBits{toHalfBits(aValue)}
+    {}
+
+    /*implicit*/ operator float() const
+    { return fromHalfBits(mBits); }
+
+    /// \brief Bitwise comparison (so NaN compares equal to itself, but -0 differs from +0).
+    bool operator==(const Half &) const = default;
+
+    std::uint16_t mBits;
+};
+
+
+/// \brief Pixel of `N_channels` consecutive half-float channels, in RGB(A) order.
+///
+/// Half the size of the corresponding math::hdr float pixel, with 11 significant bits
+/// and a range up to 65504: enough for HDR intermediates (e.g. bloom) and textures.
+template <std::size_t N_channels>
+struct HalfPixel
+{
+    Half & operator[](std::size_t aChannel)
+    { return mChannels[aChannel]; }
+
+    Half operator[](std::size_t aChannel) const
+    { return mChannels[aChannel]; }
+
+    bool operator==(const HalfPixel &) const = default;
+
+    std::array<Half, N_channels> mChannels;
+};
+
+
+using Rgb_h = HalfPixel<3>;
+using Rgba_h = HalfPixel<4>;
+
+static_assert(sizeof(Rgb_h) == 3 * sizeof(std::uint16_t) && sizeof(Rgba_h) == 4 * sizeof(std::uint16_t),
+              "Half-float pixels must be tightly packed to be uploaded as GL_HALF_FLOAT.");
+
+
+} // namespace arte
+} // namespace ad
@@ -1,9 +1,16 @@
 #include "Image.h"
 
+#include "MappedImage.h"
+
+#include "detail/PixelKernels.h"
 #include "detail/ImageFormats/Netpbm.h"
+#include "detail/ImageFormats/Png.h"
+#include "detail/ImageFormats/Qoi.h"
 #include "detail/ImageFormats/StbImageFormats.h"
 
 #include <algorithm>
+#include <array>
+#include <vector>
 #include <fstream>
 #include <string>
 #include <istream>
@@ -15,28 +22,139 @@ namespace ad {
 namespace arte {
 
 
+namespace {
+
+
+    /// \brief Detect the format of the image in `aIn` from its signature,
+    /// restoring the stream position.
+    ImageFormat detectFormat(std::istream & aIn)
+    {
+        const std::streampos start = aIn.tellg();
+        std::array<unsigned char, 8> signature{};
+        aIn.read(reinterpret_cast<char *>(signature.data()), signature.size());
+        aIn.clear();
+        aIn.seekg(start);
+
+        auto startsWith = [&signature](std::initializer_list<unsigned char> aPrefix)
+        {
+            return std::equal(aPrefix.begin(), aPrefix.end(), signature.begin());
+        };
+
+        if (startsWith({'P', '5'}))
+        {
+            return ImageFormat::Pgm;
+        }
+        else if (startsWith({'P', '6'}))
+        {
+            return ImageFormat::Ppm;
+        }
+        else if (startsWith({0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'}))
+        {
+            return ImageFormat::Png;
+        }
+        else if (startsWith({0xFF, 0xD8, 0xFF}))
+        {
+            return ImageFormat::Jpg;
+        }
+        else if (startsWith({'B', 'M'}))
+        {
+            return ImageFormat::Bmp;
+        }
+        else if (startsWith({'#', '?'})) // #?RADIANCE or #?RGBE
+        {
+            return ImageFormat::Hdr;
+        }
+        else if (startsWith({'q', 'o', 'i', 'f'}))
+        {
+            return ImageFormat::Qoi;
+        }
+        throw std::runtime_error{"Cannot detect the image format from its content."};
+    }
+
+
+} // anonymous namespace
+
+
+ImageProbe probeImage(std::istream & aIn)
+{
+    ImageProbe result{.mFormat = detectFormat(aIn)};
+    switch (result.mFormat)
+    {
+    case ImageFormat::Pgm:
+        result.mDimensions = detail::Netpbm<detail::NetpbmFormat::Pgm>::ReadHeader(aIn);
+        result.mChannels = 1;
+        break;
+    case ImageFormat::Ppm:
+        result.mDimensions = detail::Netpbm<detail::NetpbmFormat::Ppm>::ReadHeader(aIn);
+        result.mChannels = 3;
+        break;
+    case ImageFormat::Qoi:
+    {
+        const detail::Qoi::Header header = detail::Qoi::ReadHeader(aIn);
+        result.mDimensions = header.mDimensions;
+        result.mChannels = header.mChannels;
+        break;
+    }
+    default:
+        result.mDimensions = detail::StbImageFormats::ReadInfo(aIn, result.mChannels);
+        break;
+    }
+    return result;
+}
+
+
+ImageProbe probeImage(const filesystem::path & aImageFile)
+{
+    std::ifstream input{aImageFile.string(), std::ios_base::in | std::ios_base::binary};
+    if (!input)
+    {
+        throw std::runtime_error{"Cannot open image file '" + aImageFile.string() + "'."};
+    }
+    return probeImage(input);
+}
+
+
 template <class T_pixelFormat>
 Image<T_pixelFormat>::Image(math::Size<2, int> aDimensions, std::unique_ptr<unsigned char[]> aRaster) :
+    Image{aDimensions,
+          detail::adoptRaster(std::move(aRaster),
+                              static_cast<std::size_t>(aDimensions.width())
+                              * static_cast<std::size_t>(aDimensions.height())
+                              * pixel_size_v),
+          1}
+{}
+
+
+template <class T_pixelFormat>
+Image<T_pixelFormat>::Image(math::Size<2, int> aDimensions,
+                            detail::Raster aRaster,
+                            std::size_t aRowAlignment) :
     mDimensions{aDimensions},
+    mStride{detail::computeStride(aDimensions.width() * pixel_size_v, aRowAlignment)},
+    mRowAlignment{aRowAlignment},
     mRaster{std::move(aRaster)}
 {}
 
 
 template <class T_pixelFormat>
-Image<T_pixelFormat>::Image(math::Size<2, int> aDimensions, T_pixelFormat aBackgroundValue) :
-    mDimensions{aDimensions},
-    mRaster{new unsigned char[mDimensions.area() * pixel_size_v]}
+Image<T_pixelFormat>::Image(math::Size<2, int> aDimensions,
+                            T_pixelFormat aBackgroundValue,
+                            std::size_t aRowAlignment) :
+    Image{makeUninitialized(aDimensions, aRowAlignment)}
 {
-    std::fill(begin(), end(), aBackgroundValue);
+    clear(aBackgroundValue);
 }
 
 
 template <class T_pixelFormat>
 Image<T_pixelFormat>::Image(const Image & aRhs) :
     mDimensions(aRhs.mDimensions),
-    mRaster{new unsigned char[mDimensions.area() * pixel_size_v]}
+    mStride(aRhs.mStride),
+    mRowAlignment{aRhs.mRowAlignment},
+    mRaster{detail::allocateRaster(aRhs.size_bytes())}
 {
-    std::copy(aRhs.begin(), aRhs.end(), begin());
+    // The copy has the same layout, the raster (including padding) is copied at once.
+    std::copy(aRhs.mRaster.get(), aRhs.mRaster.get() + aRhs.size_bytes(), mRaster.get());
 }
 
 
@@ -48,11 +166,31 @@ Image<T_pixelFormat>::Image(const filesystem::path & aImageFile,
 
 
 template <class T_pixelFormat>
-Image<T_pixelFormat> Image<T_pixelFormat>::makeUninitialized(math::Size<2, int> aDimensions)
+Image<T_pixelFormat>::Image(ImageView<const pixel_format_t> aView) :
+    Image{makeUninitialized(aView.dimensions())}
 {
+    copyPixels(aView, view());
+}
+
+
+template <class T_pixelFormat>
+Image<T_pixelFormat> Image<T_pixelFormat>::makeUninitialized(math::Size<2, int> aDimensions,
+                                                             std::size_t aRowAlignment)
+{
+    return makeUninitialized(aDimensions, aRowAlignment, currentRasterAllocator());
+}
+
+
+template <class T_pixelFormat>
+Image<T_pixelFormat> Image<T_pixelFormat>::makeUninitialized(math::Size<2, int> aDimensions,
+                                                             std::size_t aRowAlignment,
+                                                             RasterAllocator & aAllocator)
+{
+    std::size_t stride = detail::computeStride(aDimensions.width() * pixel_size_v, aRowAlignment);
     return Image{
         aDimensions,
-        std::make_unique<unsigned char[]>(sizeof(T_pixelFormat) * aDimensions.area())
+        detail::allocateRaster(stride * aDimensions.height(), aAllocator),
+        aRowAlignment,
     };
 }
 
@@ -65,18 +203,25 @@ Image<T_pixelFormat> & Image<T_pixelFormat>::operator=(const Image & aRhs)
 
 
 template <>
-void Image<math::sdr::Rgb>::write(ImageFormat aFormat, std::ostream & aOut,
-                                  ImageOrientation aOrientation) const
+void write<math::sdr::Rgb>(ImageView<const math::sdr::Rgb> aView,
+                           ImageFormat aFormat, std::ostream & aOut,
+                           ImageOrientation aOrientation,
+                           const EncodingOptions & aOptions)
 {
     switch(aFormat)
     {
     case ImageFormat::Ppm:
-        detail::Netpbm<detail::NetpbmFormat::Ppm>::Write(aOut, *this, aOrientation);
+        detail::Netpbm<detail::NetpbmFormat::Ppm>::Write(aOut, aView, aOrientation);
+        break;
+    case ImageFormat::Qoi:
+        detail::Qoi::Write(aOut, aView, aOrientation);
+        break;
+    case ImageFormat::Png:
+        detail::Png::Write(aOut, aView, aOrientation, aOptions);
         break;
     case ImageFormat::Bmp:
     case ImageFormat::Jpg:
-    case ImageFormat::Png:
-        detail::StbImageFormats::Write<pixel_format_t>(aOut, *this, aFormat, aOrientation);
+        detail::StbImageFormats::Write(aOut, aView, aFormat, aOrientation);
         break;
     default:
         throw std::runtime_error{"Unsupported write format for RGB image: "
@@ -86,16 +231,22 @@ void Image<math::sdr::Rgb>::write(ImageFormat aFormat, std::ostream & aOut,
 
 
 template <>
-void Image<math::sdr::Rgba>::write(ImageFormat aFormat,
-                                   std::ostream & aOut,
-                                   ImageOrientation aOrientation) const
+void write<math::sdr::Rgba>(ImageView<const math::sdr::Rgba> aView,
+                            ImageFormat aFormat, std::ostream & aOut,
+                            ImageOrientation aOrientation,
+                            const EncodingOptions & aOptions)
 {
     switch(aFormat)
     {
+    case ImageFormat::Qoi:
+        detail::Qoi::Write(aOut, aView, aOrientation);
+        break;
+    case ImageFormat::Png:
+        detail::Png::Write(aOut, aView, aOrientation, aOptions);
+        break;
     case ImageFormat::Bmp:
     case ImageFormat::Jpg:
-    case ImageFormat::Png:
-        detail::StbImageFormats::Write<pixel_format_t>(aOut, *this, aFormat, aOrientation);
+        detail::StbImageFormats::Write(aOut, aView, aFormat, aOrientation);
         break;
     default:
         throw std::runtime_error{"Unsupported write format for RGBA image: "
@@ -105,13 +256,15 @@ void Image<math::sdr::Rgba>::write(ImageFormat aFormat,
 
 
 template <>
-void Image<math::hdr::Rgb_f>::write(ImageFormat aFormat, std::ostream & aOut,
-                                    ImageOrientation aOrientation) const
+void write<math::hdr::Rgb_f>(ImageView<const math::hdr::Rgb_f> aView,
+                             ImageFormat aFormat, std::ostream & aOut,
+                             ImageOrientation aOrientation,
+                             const EncodingOptions & aOptions)
 {
     switch(aFormat)
     {
     case ImageFormat::Hdr:
-        detail::StbImageFormats::WriteHdr(aOut, *this, aOrientation);
+        detail::StbImageFormats::WriteHdr(aOut, aView, aOrientation);
         break;
     default:
         throw std::runtime_error{"Unsupported write format for HDR RGB image: "
@@ -121,26 +274,52 @@ void Image<math::hdr::Rgb_f>::write(ImageFormat aFormat, std::ostream & aOut,
 
 
 template <>
-void Image<math::hdr::Rgba_f>::write(ImageFormat aFormat, std::ostream & aOut,
-                                     ImageOrientation aOrientation) const
+void write<math::hdr::Rgba_f>(ImageView<const math::hdr::Rgba_f> aView,
+                              ImageFormat aFormat, std::ostream & aOut,
+                              ImageOrientation aOrientation,
+                              const EncodingOptions & aOptions)
 {
     throw std::runtime_error{"Writing HDR image with alpha is not implemented."};
 }
 
 
 template <>
-void Image<math::sdr::Grayscale>::write(ImageFormat aFormat, std::ostream & aOut,
-                                        ImageOrientation aOrientation) const
+void write<Rgb_h>(ImageView<const Rgb_h> aView,
+                  ImageFormat aFormat, std::ostream & aOut,
+                  ImageOrientation aOrientation,
+                  const EncodingOptions & aOptions)
+{
+    throw std::runtime_error{"Writing half-float image is not implemented."};
+}
+
+
+template <>
+void write<Rgba_h>(ImageView<const Rgba_h> aView,
+                   ImageFormat aFormat, std::ostream & aOut,
+                   ImageOrientation aOrientation,
+                   const EncodingOptions & aOptions)
+{
+    throw std::runtime_error{"Writing half-float image is not implemented."};
+}
+
+
+template <>
+void write<math::sdr::Grayscale>(ImageView<const math::sdr::Grayscale> aView,
+                                 ImageFormat aFormat, std::ostream & aOut,
+                                 ImageOrientation aOrientation,
+                                 const EncodingOptions & aOptions)
 {
     switch(aFormat)
     {
+    case ImageFormat::Png:
+        detail::Png::Write(aOut, aView, aOrientation, aOptions);
+        break;
     case ImageFormat::Bmp:
     case ImageFormat::Jpg:
-    case ImageFormat::Png:
-        detail::StbImageFormats::Write<pixel_format_t>(aOut, *this, aFormat, aOrientation);
+        detail::StbImageFormats::Write(aOut, aView, aFormat, aOrientation);
         break;
     case ImageFormat::Pgm:
-        detail::Netpbm<detail::NetpbmFormat::Pgm>::Write(aOut, *this, aOrientation);
+        detail::Netpbm<detail::NetpbmFormat::Pgm>::Write(aOut, aView, aOrientation);
         break;
     default:
         throw std::runtime_error{"Unsupported write format for grayscale image: "
@@ -149,6 +328,15 @@ void Image<math::sdr::Grayscale>::write(ImageFormat aFormat, std::ostream & aOut
 }
 
 
+template <class T_pixelFormat>
+void Image<T_pixelFormat>::write(ImageFormat aFormat, std::ostream & aOut,
+                                 ImageOrientation aOrientation,
+                                 const EncodingOptions & aOptions) const
+{
+    arte::write(view(), aFormat, aOut, aOrientation, aOptions);
+}
+
+
 template <>
 Image<math::sdr::Rgb> Image<math::sdr::Rgb>::Read(ImageFormat aFormat,
                                                   std::istream & aIn,
@@ -158,6 +346,8 @@ Image<math::sdr::Rgb> Image<math::sdr::Rgb>::Read(ImageFormat aFormat,
     {
     case ImageFormat::Ppm:
         return detail::Netpbm<detail::NetpbmFormat::Ppm>::Read(aIn, aOrientation);
+    case ImageFormat::Qoi:
+        return detail::Qoi::Read<math::sdr::Rgb>(aIn, aOrientation);
     case ImageFormat::Bmp:
     case ImageFormat::Jpg:
     case ImageFormat::Png:
@@ -177,6 +367,8 @@ Image<math::sdr::Rgba> Image<math::sdr::Rgba>::Read(ImageFormat aFormat,
     // Important: PPM standard does **not** support a transparency channel.
     switch(aFormat)
     {
+    case ImageFormat::Qoi:
+        return detail::Qoi::Read<pixel_format_t>(aIn, aOrientation);
     case ImageFormat::Bmp:
     case ImageFormat::Jpg:
     case ImageFormat::Png:
@@ -240,22 +432,84 @@ Image<math::hdr::Rgba_f> Image<math::hdr::Rgba_f>::Read(ImageFormat aFormat,
 }
 
 
+template <>
+Image<Rgb_h> Image<Rgb_h>::Read(ImageFormat aFormat,
+                                std::istream & aIn,
+                                ImageOrientation aOrientation)
+{
+    throw std::runtime_error{"Reading half-float image is not implemented."};
+}
+
+
+template <>
+Image<Rgba_h> Image<Rgba_h>::Read(ImageFormat aFormat,
+                                  std::istream & aIn,
+                                  ImageOrientation aOrientation)
+{
+    throw std::runtime_error{"Reading half-float image is not implemented."};
+}
+
+
+namespace {
+
+
+    /// \brief The pixel formats for which a MappedImage is available.
+    template <class T_pixelFormat>
+    constexpr bool is_mappable_v = std::is_same_v<T_pixelFormat, math::sdr::Rgb>
+                                   || std::is_same_v<T_pixelFormat, math::sdr::Grayscale>;
+
+
+    /// \brief True if files in `aFormat` can be accessed via a MappedImage of `T_pixelFormat`.
+    template <class T_pixelFormat>
+    bool isMappable(ImageFormat aFormat)
+    {
+        return (std::is_same_v<T_pixelFormat, math::sdr::Rgb> && aFormat == ImageFormat::Ppm)
+            || (std::is_same_v<T_pixelFormat, math::sdr::Grayscale> && aFormat == ImageFormat::Pgm);
+    }
+
+
+} // anonymous namespace
+
+
 template <class T_pixelFormat>
 Image<T_pixelFormat> Image<T_pixelFormat>::LoadFile(const filesystem::path & aImageFile,
                                                     ImageOrientation aOrientation)
 {
+    ImageFormat format = from_extension(aImageFile.extension());
+    if constexpr (is_mappable_v<T_pixelFormat>)
+    {
+        if (isMappable<T_pixelFormat>(format))
+        {
+            // Avoids copying the raster through the stream.
+            return MappedImage<T_pixelFormat>::Open(aImageFile).toImage(aOrientation);
+        }
+    }
+
     std::ifstream input{aImageFile.string(), std::ios_base::in | std::ios_base::binary};
     assert(input);
-    return Read(from_extension(aImageFile.extension()), input, aOrientation);
+    return Read(format, input, aOrientation);
 }
 
 
 template <class T_pixelFormat>
-void Image<T_pixelFormat>::saveFile(const filesystem::path & aDestination, ImageOrientation aOrientation) const
+void Image<T_pixelFormat>::saveFile(const filesystem::path & aDestination,
+                                    ImageOrientation aOrientation,
+                                    const EncodingOptions & aOptions) const
 {
-    write(from_extension(aDestination.extension()),
+    ImageFormat format = from_extension(aDestination.extension());
+    if constexpr (is_mappable_v<T_pixelFormat>)
+    {
+        if (isMappable<T_pixelFormat>(format))
+        {
+            saveMapped(view(), aDestination, aOrientation);
+            return;
+        }
+    }
+
+    write(format,
           std::ofstream{aDestination.string(), std::ios_base::out | std::ios_base::binary},
-          aOrientation);
+          aOrientation,
+          aOptions);
 }
 
 
@@ -263,85 +517,143 @@ template <class T_pixelFormat>
 void Image<T_pixelFormat>::clear(T_pixelFormat aClearColor)
 {
     // TODO is there a more efficient approach?
-    std::fill(begin(), end(), aClearColor);
+    for (int rowId = 0; rowId != height(); ++rowId)
+    {
+        std::fill(row(rowId), row(rowId) + width(), aClearColor);
+    }
 }
 
 
 template <class T_pixelFormat>
 Image<T_pixelFormat> Image<T_pixelFormat>::crop(const math::Rectangle<int> & aZone) const
 {
-    auto destination = std::make_unique<unsigned char []>(aZone.mDimension.area() * pixel_size_v);
-    cropTo(reinterpret_cast<T_pixelFormat *>(destination.get()), aZone);
-    return {aZone.dimension(), std::move(destination)};
+    return Image{view(aZone)};
 }
 
 
 template <class T_pixelFormat>
-T_pixelFormat * Image<T_pixelFormat>::cropTo(T_pixelFormat * aDestination, const math::Rectangle<int> & aZone) const
+Image<T_pixelFormat> & Image<T_pixelFormat>::pasteFrom(ImageView<const pixel_format_t> aSource,
+                                                       math::Position<2, int> aPastePosition)
 {
-    std::size_t startOffset = aZone.y() * dimensions().width() + aZone.x();
-    for (int line = 0; line != aZone.height(); ++line)
+    copyPixels(aSource, view({aPastePosition, aSource.dimensions()}));
+    return *this;
+}
+
+
+namespace {
+
+
+    bool useKernels()
     {
-        aDestination = std::copy(data() + startOffset,
-                                 data() + (startOffset + aZone.width()),
-                                 aDestination);
-        startOffset += dimensions().width();
+        return detail::kernels::getSimdLevel() != detail::kernels::SimdLevel::Scalar;
     }
-    return aDestination;
-}
 
 
-template <class T_pixelFormat>
-Image<T_pixelFormat> & Image<T_pixelFormat>::pasteFrom(const Image & aSource, math::Position<2, int> aPastePosition)
-{
-    int sourceWidth = aSource.dimensions().width();
-    if (sourceWidth == dimensions().width())
+    template <class T_pixel>
+    const std::uint8_t * rowChannels(ImageView<const T_pixel> aView, int aRow)
     {
-        // Optimal case: no need to copy row by row
-        std::copy(aSource.begin(), aSource.end(), &at(aPastePosition));
+        return reinterpret_cast<const std::uint8_t *>(aView.row(aRow));
     }
-    else
+
+
+    /// \brief For each channel of `T_pixelFormat`, map each 8-bit value to its sRGB decoded value.
+    /// \note Generated through `decode_sRGB()`, so the results are exactly the ones of the math library.
+    template <class T_pixelFormat>
+    using SRGBDecodeTable = std::array<std::array<std::uint8_t, 256>, sizeof(T_pixelFormat)>;
+
+    template <class T_pixelFormat>
+    const SRGBDecodeTable<T_pixelFormat> & getSRGBDecodeTable()
     {
-        for (int sourceRow = 0; sourceRow != aSource.dimensions().height(); ++sourceRow)
+        static const SRGBDecodeTable<T_pixelFormat> table = []()
         {
-            auto begin = aSource.begin() + sourceRow * sourceWidth;
-            std::copy(begin, begin + sourceWidth, &at(aPastePosition.x(), aPastePosition.y() + sourceRow));
-        }
+            SRGBDecodeTable<T_pixelFormat> result;
+            for (int value = 0; value != 256; ++value)
+            {
+                T_pixelFormat pixel;
+                std::uint8_t * pixelChannels = reinterpret_cast<std::uint8_t *>(&pixel);
+                std::fill(pixelChannels, pixelChannels + sizeof(T_pixelFormat), static_cast<std::uint8_t>(value));
+
+                const T_pixelFormat decoded = decode_sRGB(pixel);
+                const std::uint8_t * channels = reinterpret_cast<const std::uint8_t *>(&decoded);
+                for (std::size_t channel = 0; channel != sizeof(T_pixelFormat); ++channel)
+                {
+                    result[channel][value] = channels[channel];
+                }
+            }
+            return result;
+        }();
+        return table;
     }
-    return *this;
-}
 
 
-Image<math::sdr::Grayscale> toGrayscale(const Image<math::sdr::Rgb> & aSource)
+} // anonymous namespace
+
+
+Image<math::sdr::Grayscale> toGrayscale(ImageView<const math::sdr::Rgb> aSource,
+                                        const Execution & aExecution)
 {
-    auto destination = std::make_unique<unsigned char[]>(aSource.dimensions().area());
+    auto destination = Image<math::sdr::Grayscale>::makeUninitialized(aSource.dimensions());
 
-    std::transform(aSource.begin(), aSource.end(), destination.get(),
-                   [](math::sdr::Rgb aPixel) -> unsigned char
-                   {
+    aExecution.forEachBand(aSource.height(), [&](int aFirstRow, int aEndRow)
+    {
+        for (int row = aFirstRow; row != aEndRow; ++row)
+        {
+            unsigned char * destinationRow = reinterpret_cast<unsigned char *>(destination.row(row));
+            if (useKernels())
+            {
+                detail::kernels::averageRgbToGray(rowChannels(aSource, row), destinationRow, aSource.width());
+            }
+            else
+            {
+                std::transform(
+                    aSource.row(row), aSource.row(row) + aSource.width(), destinationRow,
+                    [](math::sdr::Rgb aPixel) -> unsigned char
+                    {
                         return math::sdr::Grayscale{
                             static_cast<std::uint8_t>((aPixel.r() + aPixel.g() + aPixel.b()) / 3)
                         }.v();
-                   });
+                    });
+            }
+        }
+    });
 
-    return {aSource.dimensions(), std::move(destination)};
+    return destination;
 }
 
 
 template <class T_hdrChannel, template<class> class TT_colorFormat>
 requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
          && std::is_floating_point_v<T_hdrChannel>
-Image<TT_colorFormat<T_hdrChannel>> to_hdr(const Image<TT_colorFormat<math::sdr::Value_t>> & aSource)
+Image<TT_colorFormat<T_hdrChannel>> to_hdr(ImageView<const TT_colorFormat<math::sdr::Value_t>> aSource,
+                                           const Execution & aExecution)
 {
     using SdrFormat = TT_colorFormat<math::sdr::Value_t>;
     using HdrFormat = TT_colorFormat<T_hdrChannel>;
 
     auto result = Image<HdrFormat>::makeUninitialized(aSource.dimensions());
-    std::transform(aSource.begin(), aSource.end(), result.begin(),
-                   [](SdrFormat aSdrPixel) -> HdrFormat
-                   {
-                        return to_hdr<T_hdrChannel>(aSdrPixel);
-                   });
+    aExecution.forEachBand(aSource.height(), [&](int aFirstRow, int aEndRow)
+    {
+        for (int row = aFirstRow; row != aEndRow; ++row)
+        {
+            if constexpr (std::is_same_v<T_hdrChannel, float>)
+            {
+                if (useKernels())
+                {
+                    static_assert(sizeof(HdrFormat) == sizeof(SdrFormat) * sizeof(float));
+                    detail::kernels::unormToFloat(rowChannels(aSource, row),
+                                                  reinterpret_cast<float *>(result.row(row)),
+                                                  aSource.width() * sizeof(SdrFormat));
+                    continue;
+                }
+            }
+
+            std::transform(aSource.row(row), aSource.row(row) + aSource.width(), result.row(row),
+                           [](SdrFormat aSdrPixel) -> HdrFormat
+                           {
+                                return to_hdr<T_hdrChannel>(aSdrPixel);
+                           });
+        }
+    });
     return result;
 }
 
@@ -349,30 +661,252 @@ Image<TT_colorFormat<T_hdrChannel>> to_hdr(const Image<TT_colorFormat<math::sdr:
 template <class T_hdrChannel, template<class> class TT_colorFormat>
 requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
          && std::is_floating_point_v<T_hdrChannel>
-Image<TT_colorFormat<math::sdr::Value_t>> tonemap(const Image<TT_colorFormat<T_hdrChannel>> & aSource)
+Image<TT_colorFormat<math::sdr::Value_t>> tonemap(ImageView<const TT_colorFormat<T_hdrChannel>> aSource,
+                                                  const Execution & aExecution)
 {
     using SdrFormat = TT_colorFormat<math::sdr::Value_t>;
     using HdrFormat = TT_colorFormat<T_hdrChannel>;
 
     auto result = Image<SdrFormat>::makeUninitialized(aSource.dimensions());
-    std::transform(aSource.begin(), aSource.end(), result.begin(),
-                   [](HdrFormat aHdrPixel) -> SdrFormat
-                   {
-                        return to_sdr(aHdrPixel);
-                   });
+    aExecution.forEachBand(aSource.height(), [&](int aFirstRow, int aEndRow)
+    {
+        for (int row = aFirstRow; row != aEndRow; ++row)
+        {
+            if constexpr (std::is_same_v<T_hdrChannel, float>)
+            {
+                if (useKernels())
+                {
+                    static_assert(sizeof(HdrFormat) == sizeof(SdrFormat) * sizeof(float));
+                    detail::kernels::floatToUnorm(reinterpret_cast<const float *>(aSource.row(row)),
+                                                  reinterpret_cast<std::uint8_t *>(result.row(row)),
+                                                  aSource.width() * sizeof(SdrFormat));
+                    continue;
+                }
+            }
+
+            std::transform(aSource.row(row), aSource.row(row) + aSource.width(), result.row(row),
+                           [](HdrFormat aHdrPixel) -> SdrFormat
+                           {
+                                return to_sdr(aHdrPixel);
+                           });
+        }
+    });
     return result;
 }
 
 
+template <template<class> class TT_colorFormat>
+requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
+Image<TT_colorFormat<math::sdr::Value_t>> tonemapToSRGB(ImageView<const TT_colorFormat<float>> aSource,
+                                                        const Execution & aExecution)
+{
+    using SdrFormat = TT_colorFormat<math::sdr::Value_t>;
+    constexpr std::size_t channels = sizeof(SdrFormat);
+    // Alpha is the fourth channel when present, and is not sRGB encoded.
+    constexpr bool hasAlpha = (channels == 4);
+
+    auto result = Image<SdrFormat>::makeUninitialized(aSource.dimensions());
+    aExecution.forEachBand(aSource.height(), [&](int aFirstRow, int aEndRow)
+    {
+        for (int row = aFirstRow; row != aEndRow; ++row)
+        {
+            const float * source = reinterpret_cast<const float *>(aSource.row(row));
+            std::uint8_t * destination = reinterpret_cast<std::uint8_t *>(result.row(row));
+            detail::kernels::encodeSRGB(source, destination, aSource.width() * channels);
+            if constexpr (hasAlpha)
+            {
+                for (int pixel = 0; pixel != aSource.width(); ++pixel)
+                {
+                    std::size_t alpha = pixel * channels + 3;
+                    detail::kernels::floatToUnorm(source + alpha, destination + alpha, 1);
+                }
+            }
+        }
+    });
+    return result;
+}
+
+
+namespace {
+
+
+    // The half-float pixels are converted through rows of float channels,
+    // both conversion steps being vectorized kernels.
+
+    template <class T_half, class T_sdr>
+    Image<T_half> unormToHalf(ImageView<const T_sdr> aSource, const Execution & aExecution)
+    {
+        static_assert(sizeof(T_half) == sizeof(T_sdr) * sizeof(Half));
+        const std::size_t channels = aSource.width() * sizeof(T_sdr);
+
+        auto result = Image<T_half>::makeUninitialized(aSource.dimensions());
+        aExecution.forEachBand(aSource.height(), [&](int aFirstRow, int aEndRow)
+        {
+            std::vector<float> linear(channels);
+            for (int row = aFirstRow; row != aEndRow; ++row)
+            {
+                detail::kernels::unormToFloat(rowChannels(aSource, row), linear.data(), channels);
+                detail::kernels::floatToHalf(linear.data(),
+                                             reinterpret_cast<std::uint16_t *>(result.row(row)),
+                                             channels);
+            }
+        });
+        return result;
+    }
+
+
+    template <class T_sdr, class T_half>
+    Image<T_sdr> halfToUnorm(ImageView<const T_half> aSource, const Execution & aExecution)
+    {
+        static_assert(sizeof(T_half) == sizeof(T_sdr) * sizeof(Half));
+        const std::size_t channels = aSource.width() * sizeof(T_sdr);
+
+        auto result = Image<T_sdr>::makeUninitialized(aSource.dimensions());
+        aExecution.forEachBand(aSource.height(), [&](int aFirstRow, int aEndRow)
+        {
+            std::vector<float> linear(channels);
+            for (int row = aFirstRow; row != aEndRow; ++row)
+            {
+                detail::kernels::halfToFloat(reinterpret_cast<const std::uint16_t *>(aSource.row(row)),
+                                             linear.data(),
+                                             channels);
+                detail::kernels::floatToUnorm(linear.data(),
+                                              reinterpret_cast<std::uint8_t *>(result.row(row)),
+                                              channels);
+            }
+        });
+        return result;
+    }
+
+
+    template <class T_half, class T_float>
+    Image<T_half> floatToHalf(ImageView<const T_float> aSource, const Execution & aExecution)
+    {
+        static_assert(sizeof(T_float) / sizeof(float) == sizeof(T_half) / sizeof(Half));
+        const std::size_t channels = aSource.width() * (sizeof(T_half) / sizeof(Half));
+
+        auto result = Image<T_half>::makeUninitialized(aSource.dimensions());
+        aExecution.forEachBand(aSource.height(), [&](int aFirstRow, int aEndRow)
+        {
+            for (int row = aFirstRow; row != aEndRow; ++row)
+            {
+                detail::kernels::floatToHalf(reinterpret_cast<const float *>(aSource.row(row)),
+                                             reinterpret_cast<std::uint16_t *>(result.row(row)),
+                                             channels);
+            }
+        });
+        return result;
+    }
+
+
+    template <class T_float, class T_half>
+    Image<T_float> halfToFloat(ImageView<const T_half> aSource, const Execution & aExecution)
+    {
+        static_assert(sizeof(T_float) / sizeof(float) == sizeof(T_half) / sizeof(Half));
+        const std::size_t channels = aSource.width() * (sizeof(T_half) / sizeof(Half));
+
+        auto result = Image<T_float>::makeUninitialized(aSource.dimensions());
+        aExecution.forEachBand(aSource.height(), [&](int aFirstRow, int aEndRow)
+        {
+            for (int row = aFirstRow; row != aEndRow; ++row)
+            {
+                detail::kernels::halfToFloat(reinterpret_cast<const std::uint16_t *>(aSource.row(row)),
+                                             reinterpret_cast<float *>(result.row(row)),
+                                             channels);
+            }
+        });
+        return result;
+    }
+
+
+} // anonymous namespace
+
+
+template <class T_hdrChannel>
+requires std::is_same_v<T_hdrChannel, Half>
+Image<Rgb_h> to_hdr(ImageView<const math::sdr::Rgb> aSource, const Execution & aExecution)
+{
+    return unormToHalf<Rgb_h>(aSource, aExecution);
+}
+
+
+template <class T_hdrChannel>
+requires std::is_same_v<T_hdrChannel, Half>
+Image<Rgba_h> to_hdr(ImageView<const math::sdr::Rgba> aSource, const Execution & aExecution)
+{
+    return unormToHalf<Rgba_h>(aSource, aExecution);
+}
+
+
+Image<math::sdr::Rgb> tonemap(ImageView<const Rgb_h> aSource, const Execution & aExecution)
+{
+    return halfToUnorm<math::sdr::Rgb>(aSource, aExecution);
+}
+
+
+Image<math::sdr::Rgba> tonemap(ImageView<const Rgba_h> aSource, const Execution & aExecution)
+{
+    return halfToUnorm<math::sdr::Rgba>(aSource, aExecution);
+}
+
+
+Image<Rgb_h> to_half(ImageView<const math::hdr::Rgb_f> aSource, const Execution & aExecution)
+{
+    return floatToHalf<Rgb_h>(aSource, aExecution);
+}
+
+
+Image<Rgba_h> to_half(ImageView<const math::hdr::Rgba_f> aSource, const Execution & aExecution)
+{
+    return floatToHalf<Rgba_h>(aSource, aExecution);
+}
+
+
+Image<math::hdr::Rgb_f> to_float(ImageView<const Rgb_h> aSource, const Execution & aExecution)
+{
+    return halfToFloat<math::hdr::Rgb_f>(aSource, aExecution);
+}
+
+
+Image<math::hdr::Rgba_f> to_float(ImageView<const Rgba_h> aSource, const Execution & aExecution)
+{
+    return halfToFloat<math::hdr::Rgba_f>(aSource, aExecution);
+}
+
+
 template<class T_pixelFormat>
 requires math::is_color_v<T_pixelFormat>
-Image<T_pixelFormat> & decodeSRGBToLinear(Image<T_pixelFormat> & aImage)
+Image<T_pixelFormat> & decodeSRGBToLinear(Image<T_pixelFormat> & aImage,
+                                          const Execution & aExecution)
 {
-    std::transform(aImage.begin(), aImage.end(), aImage.begin(),
-                   [](T_pixelFormat aPixel) -> T_pixelFormat
-                   {
-                        return decode_sRGB(aPixel);
-                   });
+    aExecution.forEachBand(aImage.height(), [&](int aFirstRow, int aEndRow)
+    {
+        if (useKernels())
+        {
+            const SRGBDecodeTable<T_pixelFormat> & table = getSRGBDecodeTable<T_pixelFormat>();
+            for (int row = aFirstRow; row != aEndRow; ++row)
+            {
+                std::uint8_t * channels = reinterpret_cast<std::uint8_t *>(aImage.row(row));
+                for (int pixel = 0; pixel != aImage.width(); ++pixel)
+                {
+                    for (std::size_t channel = 0; channel != sizeof(T_pixelFormat); ++channel, ++channels)
+                    {
+                        *channels = table[channel][*channels];
+                    }
+                }
+            }
+            return;
+        }
+
+        for (int row = aFirstRow; row != aEndRow; ++row)
+        {
+            std::transform(aImage.row(row), aImage.row(row) + aImage.width(), aImage.row(row),
+                           [](T_pixelFormat aPixel) -> T_pixelFormat
+                           {
+                                return decode_sRGB(aPixel);
+                           });
+        }
+    });
     return aImage;
 }
 
@@ -387,18 +921,27 @@ template class Image<math::sdr::Grayscale>;
 template class Image<math::hdr::Rgb_f>;
 template class Image<math::hdr::Rgba_f>;
 
-template Image<math::hdr::Rgb_f> to_hdr<float>(const Image<math::sdr::Rgb> &);
-template Image<math::hdr::Rgb_d> to_hdr<double>(const Image<math::sdr::Rgb> &);
-template Image<math::hdr::Rgba_f> to_hdr<float>(const Image<math::sdr::Rgba> &);
-template Image<math::hdr::Rgba_d> to_hdr<double>(const Image<math::sdr::Rgba> &);
+template class Image<Rgb_h>;
+template class Image<Rgba_h>;
+
+template Image<math::hdr::Rgb_f> to_hdr<float>(ImageView<const math::sdr::Rgb>, const Execution &);
+template Image<math::hdr::Rgb_d> to_hdr<double>(ImageView<const math::sdr::Rgb>, const Execution &);
+template Image<math::hdr::Rgba_f> to_hdr<float>(ImageView<const math::sdr::Rgba>, const Execution &);
+template Image<math::hdr::Rgba_d> to_hdr<double>(ImageView<const math::sdr::Rgba>, const Execution &);
+
+template Image<math::sdr::Rgb> tonemap(ImageView<const math::hdr::Rgb_f>, const Execution &);
+template Image<math::sdr::Rgb> tonemap(ImageView<const math::hdr::Rgb_d>, const Execution &);
+template Image<math::sdr::Rgba> tonemap(ImageView<const math::hdr::Rgba_f>, const Execution &);
+template Image<math::sdr::Rgba> tonemap(ImageView<const math::hdr::Rgba_d>, const Execution &);
+
+template Image<Rgb_h> to_hdr<Half>(ImageView<const math::sdr::Rgb>, const Execution &);
+template Image<Rgba_h> to_hdr<Half>(ImageView<const math::sdr::Rgba>, const Execution &);
 
-template Image<math::sdr::Rgb> tonemap(const Image<math::hdr::Rgb_f> &);
-template Image<math::sdr::Rgb> tonemap(const Image<math::hdr::Rgb_d> &);
-template Image<math::sdr::Rgba> tonemap(const Image<math::hdr::Rgba_f> &);
-template Image<math::sdr::Rgba> tonemap(const Image<math::hdr::Rgba_d> &);
+template Image<math::sdr::Rgb> tonemapToSRGB(ImageView<const math::hdr::Rgb_f>, const Execution &);
+template Image<math::sdr::Rgba> tonemapToSRGB(ImageView<const math::hdr::Rgba_f>, const Execution &);
 
-template Image<math::sdr::Rgb> & decodeSRGBToLinear(Image<math::sdr::Rgb> & aImage);
-template Image<math::sdr::Rgba> & decodeSRGBToLinear(Image<math::sdr::Rgba> & aImage);
+template Image<math::sdr::Rgb> & decodeSRGBToLinear(Image<math::sdr::Rgb> & aImage, const Execution &);
+template Image<math::sdr::Rgba> & decodeSRGBToLinear(Image<math::sdr::Rgba> & aImage, const Execution &);
 
 
 } // namespace arte
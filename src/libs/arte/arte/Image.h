@@ -1,5 +1,12 @@
 #pragma once
 
+#include "Execution.h"
+#include "HalfFloat.h"
+#include "ImageView.h"
+#include "RasterAllocator.h"
+
+#include "detail/Raster.h"
+
 #include <handy/ZeroOnMove.h>
 
 #include <platform/Filesystem.h>
@@ -11,6 +18,8 @@
 #include <map>
 #include <memory>
 
+#include <cassert>
+
 
 namespace ad {
 namespace arte {
@@ -24,6 +33,7 @@ enum class ImageFormat
     Jpg,
     Png,
     Hdr,
+    Qoi,
 };
 
 
@@ -34,6 +44,16 @@ enum class ImageOrientation
 };
 
 
+/// \brief Tunes the encoders supporting it, currently PNG.
+struct EncodingOptions
+{
+    /// \brief From 0 (stored without compression, fastest) to 9 (smallest output, slowest).
+    int mCompressionLevel{6};
+    /// \brief How the rows are filtered and the chunks compressed, serially by default.
+    Execution mExecution{};
+};
+
+
 struct FormatInfo
 {
     std::string name;
@@ -48,6 +68,7 @@ static const std::map<ImageFormat, FormatInfo> gImageFormatMap {
     {ImageFormat::Jpg, {"JPG", ".jpg"}},
     {ImageFormat::Png, {"PNG", ".png"}},
     {ImageFormat::Hdr, {"HDR", ".hdr"}},
+    {ImageFormat::Qoi, {"QOI", ".qoi"}},
 };
 
 
@@ -77,6 +98,27 @@ inline ImageFormat from_extension(filesystem::path aExtension)
 
 
 
+/// \brief The properties of an image, as read from the header of its file.
+struct ImageProbe
+{
+    ImageFormat mFormat;
+    math::Size<2, int> mDimensions;
+    /// \brief The number of channels stored in the file (e.g. 3 for RGB), independently of the
+    /// pixel format it might be decoded to.
+    int mChannels;
+};
+
+
+/// \brief Read only the header of the image in `aIn`, without decoding any pixel.
+///
+/// The format is detected from the content, not from an extension.
+/// \attention `aIn` must be seekable: its first bytes are read again once the format is detected.
+ImageProbe probeImage(std::istream & aIn);
+
+/// \brief Read only the header of the image file `aImageFile`, without decoding any pixel.
+ImageProbe probeImage(const filesystem::path & aImageFile);
+
+
 template <class T_pixelFormat>
 class Image
 {
@@ -104,7 +146,7 @@ private:
     public:
         auto & operator[](std::size_t aRowId)
         {
-            return mImage.data()[aRowId*mImage.width() + mColumnId];
+            return mImage.row(aRowId)[mColumnId];
         }
 
     private:
@@ -137,28 +179,45 @@ public:
     Image & operator=(Image && aRhs) noexcept = default;
 
     /// \brief Low-level constructor, intended for loaders implementation, not general usage
-    /// \attention The calling code is responsible for providing a raster of appropriate size
+    /// \attention The calling code is responsible for providing a raster of appropriate size,
+    /// with tightly packed rows (i.e. a row alignment of 1).
+    /// \note A raster which is not aligned to gRasterAlignment is copied into an aligned raster.
     Image(math::Size<2, int> aDimensions, std::unique_ptr<unsigned char[]> aRaster);
 
     /// \brief Creates an image
-    Image(math::Size<2, int> aDimensions, pixel_format_t aBackgroundValue);
+    /// \param aRowAlignment Each row start is aligned to a multiple of this value (in bytes),
+    /// which must be a power of 2. Rows are padded as needed.
+    Image(math::Size<2, int> aDimensions, pixel_format_t aBackgroundValue,
+          std::size_t aRowAlignment = 1);
 
     /// \brief Load an Image from a file on disk.
     /// \note Similar functionality to LoadFile().
     explicit Image(const filesystem::path & aImageFile,
                    ImageOrientation aOrientation = ImageOrientation::Unchanged);
 
+    /// \brief Creates an image holding a copy of the pixels addressed by `aView`.
+    explicit Image(ImageView<const pixel_format_t> aView);
+
 
     /// \brief Return an image of requested dimensions, where the pixel memory contains garbage.
     ///
     /// Each pixel can be written, but reading it before it is first written is an undefined behaviour.
-    static Image makeUninitialized(math::Size<2, int> aDimensions);
+    /// \param aRowAlignment see the constructor.
+    /// \note The raster is obtained from currentRasterAllocator().
+    static Image makeUninitialized(math::Size<2, int> aDimensions, std::size_t aRowAlignment = 1);
+
+    /// \brief Overload obtaining the raster from `aAllocator`, which must outlive the image raster.
+    static Image makeUninitialized(math::Size<2, int> aDimensions,
+                                   std::size_t aRowAlignment,
+                                   RasterAllocator & aAllocator);
 
     void write(ImageFormat aFormat, std::ostream & aOut,
-               ImageOrientation aOrientation = ImageOrientation::Unchanged) const;
+               ImageOrientation aOrientation = ImageOrientation::Unchanged,
+               const EncodingOptions & aOptions = {}) const;
     void write(ImageFormat aFormat, std::ostream && aOut,
-               ImageOrientation aOrientation = ImageOrientation::Unchanged) const
-    { return write(aFormat, aOut, aOrientation); };
+               ImageOrientation aOrientation = ImageOrientation::Unchanged,
+               const EncodingOptions & aOptions = {}) const
+    { return write(aFormat, aOut, aOrientation, aOptions); };
 
     static Image Read(ImageFormat aFormat, std::istream & aIn,
                       ImageOrientation aOrientation = ImageOrientation::Unchanged);
@@ -170,7 +229,8 @@ public:
                           ImageOrientation aOrientation = ImageOrientation::Unchanged);
 
     void saveFile(const filesystem::path & aDestination,
-                  ImageOrientation aOrientation = ImageOrientation::Unchanged) const;
+                  ImageOrientation aOrientation = ImageOrientation::Unchanged,
+                  const EncodingOptions & aOptions = {}) const;
 
     void clear(T_pixelFormat aClearColor);
 
@@ -180,10 +240,10 @@ public:
     const_Column operator[](std::size_t aColumnId) const;
 
     pixel_format_t & at(std::size_t aColumn, std::size_t aRow)
-    { return data()[aRow*width() + aColumn]; }
+    { return row(aRow)[aColumn]; }
 
     pixel_format_t at(std::size_t aColumn, std::size_t aRow) const
-    { return data()[aRow*width() + aColumn]; }
+    { return row(aRow)[aColumn]; }
 
     template <class T_integer>
     pixel_format_t & at(math::Position<2, T_integer> aPosition)
@@ -200,29 +260,46 @@ public:
     const pixel_format_t * data() const
     { return reinterpret_cast<const pixel_format_t *>(mRaster.get()); }
 
+    pixel_format_t * row(std::size_t aRow)
+    { return reinterpret_cast<pixel_format_t *>(mRaster.get() + aRow * mStride); }
+
+    const pixel_format_t * row(std::size_t aRow) const
+    { return reinterpret_cast<const pixel_format_t *>(mRaster.get() + aRow * mStride); }
+
     explicit operator const unsigned char * () const
     { return mRaster.get(); }
 
     explicit operator const std::byte * () const
     { return reinterpret_cast<const std::byte *>(mRaster.get()); }
 
+    /// \brief The size of the raster, including the rows padding if any.
     std::size_t size_bytes() const
-    { return dimensions().area() * pixel_size_v; }
+    { return stride_bytes() * height(); }
 
+    /// \brief The number of bytes occupied by the pixels of a row, excluding padding.
     std::size_t size_bytes_line() const
     { return dimensions().width() * pixel_size_v; }
 
+    /// \brief Distance in bytes between the start of two consecutive rows.
+    std::size_t stride_bytes() const
+    { return mStride; }
+
+    /// \brief True if rows are not padded, i.e. all the pixels form a single array.
+    bool isContiguous() const
+    { return stride_bytes() == size_bytes_line(); }
+
+    // Iteration over all pixels as a single array is only valid for contiguous images.
     auto begin()
     { return data(); }
 
     auto end()
-    { return data() + mDimensions.area(); }
+    { assert(isContiguous()); return data() + mDimensions.area(); }
 
     auto cbegin() const
     { return data(); }
 
     auto cend() const
-    { return data() + mDimensions.area(); }
+    { assert(isContiguous()); return data() + mDimensions.area(); }
 
     auto begin() const
     { return cbegin(); }
@@ -236,34 +313,53 @@ public:
     int height() const
     { return mDimensions.height(); }
 
+    ImageView<pixel_format_t> view()
+    { return {data(), dimensions(), stride_bytes()}; }
+
+    ImageView<const pixel_format_t> view() const
+    { return {data(), dimensions(), stride_bytes()}; }
+
+    /// \brief Return a view on the rectangle `aZone` of this image, without copying any pixel.
+    ImageView<pixel_format_t> view(const math::Rectangle<int> & aZone)
+    { return view().crop(aZone); }
+
+    ImageView<const pixel_format_t> view(const math::Rectangle<int> & aZone) const
+    { return view().crop(aZone); }
+
+    /*implicit*/ operator ImageView<const pixel_format_t> () const
+    { return view(); }
+
     math::Size<2, int> dimensions() const
     { return static_cast<math::Size<2, int>>(mDimensions); }
 
     /// \brief The alignment of consecutive rows. This is important for OpenGL, which uses 4 by default.
-    /// \note Currently 1 in all the cases for us, even stb_image tightly packs rows.
+    /// \note 1 unless requested otherwise at construction, even stb_image tightly packs rows.
     std::size_t rowAlignment() const
-    { return 1; }
+    { return mRowAlignment; }
 
     //
     // Image edition
     //
+    /// \brief Return an image containing a copy of the rectangle `aZone`.
+    /// \note Use `view(aZone)` when a copy is not required.
     Image crop(const math::Rectangle<int> & aZone) const;
 
     template <class T_iterator>
     Image prepareArray(T_iterator aFirstPosition, T_iterator aLastPosition, math::Size<2, int> aDimension) const;
 
-    /// \brief Paste a copy of `aSource` image into this, placing it at `aPastePosition`.
-    Image & pasteFrom(const Image & aSource, math::Position<2, int> aPastePosition);
+    /// \brief Paste a copy of `aSource` pixels into this, placing it at `aPastePosition`.
+    Image & pasteFrom(ImageView<const pixel_format_t> aSource, math::Position<2, int> aPastePosition);
 
 private:
-    /// \return Position immediatly after the last writen element.
-    T_pixelFormat * cropTo(T_pixelFormat * aDestination, const math::Rectangle<int> & aZone) const;
+    Image(math::Size<2, int> aDimensions, detail::Raster aRaster, std::size_t aRowAlignment);
 
     math::Size<2, ZeroOnMove<int>> mDimensions{0, 0};
+    ZeroOnMove<std::size_t> mStride{0};
+    std::size_t mRowAlignment{1};
     // NOTE: it is not possible to allocate an array of non-default constructible objects
     //std::unique_ptr<T_pixelFormat[]> mRaster{nullptr};
     // TODO try with byte
-    std::unique_ptr<unsigned char[]> mRaster{nullptr};
+    detail::Raster mRaster{nullptr};
 };
 
 
@@ -273,22 +369,86 @@ math::Size<2, int> dimensions(const Image<T_pixelFormat> & aImage)
 { return aImage.dimensions(); }
 
 
-Image<math::sdr::Grayscale> toGrayscale(const Image<math::sdr::Rgb> & aSource);
+/// \brief Write the pixels addressed by `aView` in `aFormat`, without requiring an owning Image.
+template <class T_pixelFormat>
+void write(ImageView<const T_pixelFormat> aView, ImageFormat aFormat, std::ostream & aOut,
+           ImageOrientation aOrientation = ImageOrientation::Unchanged,
+           const EncodingOptions & aOptions = {});
+
+
+// The whole-image conversions below distribute their rows according to `aExecution`,
+// producing the same result with any execution.
+
+Image<math::sdr::Grayscale> toGrayscale(ImageView<const math::sdr::Rgb> aSource,
+                                        const Execution & aExecution = {});
 
 
 template <class T_hdrChannel = float, template<class> class TT_colorFormat>
 requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
          && std::is_floating_point_v<T_hdrChannel>
-Image<TT_colorFormat<T_hdrChannel>> to_hdr(const Image<TT_colorFormat<math::sdr::Value_t>> & aSource);
+Image<TT_colorFormat<T_hdrChannel>> to_hdr(ImageView<const TT_colorFormat<math::sdr::Value_t>> aSource,
+                                           const Execution & aExecution = {});
 
 template <class T_hdrChannel = float, template<class> class TT_colorFormat>
 requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
          && std::is_floating_point_v<T_hdrChannel>
-Image<TT_colorFormat<math::sdr::Value_t>> tonemap(const Image<TT_colorFormat<T_hdrChannel>> & aSource);
+Image<TT_colorFormat<T_hdrChannel>> to_hdr(const Image<TT_colorFormat<math::sdr::Value_t>> & aSource,
+                                           const Execution & aExecution = {})
+{ return to_hdr<T_hdrChannel>(aSource.view(), aExecution); }
+
+template <class T_hdrChannel = float, template<class> class TT_colorFormat>
+requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
+         && std::is_floating_point_v<T_hdrChannel>
+Image<TT_colorFormat<math::sdr::Value_t>> tonemap(ImageView<const TT_colorFormat<T_hdrChannel>> aSource,
+                                                  const Execution & aExecution = {});
+
+template <class T_hdrChannel, template<class> class TT_colorFormat>
+requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
+         && std::is_floating_point_v<T_hdrChannel>
+Image<TT_colorFormat<math::sdr::Value_t>> tonemap(const Image<TT_colorFormat<T_hdrChannel>> & aSource,
+                                                  const Execution & aExecution = {})
+{ return tonemap(aSource.view(), aExecution); }
+
+/// \brief Convert to half-float channels in [0, 1], with half the memory of `to_hdr<float>()`.
+/// \note Selected by `to_hdr<Half>()`, since the half-float pixels are not math library colors.
+template <class T_hdrChannel>
+requires std::is_same_v<T_hdrChannel, Half>
+Image<Rgb_h> to_hdr(ImageView<const math::sdr::Rgb> aSource, const Execution & aExecution = {});
+
+template <class T_hdrChannel>
+requires std::is_same_v<T_hdrChannel, Half>
+Image<Rgba_h> to_hdr(ImageView<const math::sdr::Rgba> aSource, const Execution & aExecution = {});
+
+Image<math::sdr::Rgb> tonemap(ImageView<const Rgb_h> aSource, const Execution & aExecution = {});
+Image<math::sdr::Rgba> tonemap(ImageView<const Rgba_h> aSource, const Execution & aExecution = {});
+
+/// \brief Narrow float channels to half-floats, rounding to nearest.
+/// \attention Magnitudes above 65504 become infinities, which RGBE (.hdr) images can exceed.
+Image<Rgb_h> to_half(ImageView<const math::hdr::Rgb_f> aSource, const Execution & aExecution = {});
+Image<Rgba_h> to_half(ImageView<const math::hdr::Rgba_f> aSource, const Execution & aExecution = {});
+
+/// \brief Widen half-float channels to float, which is exact.
+Image<math::hdr::Rgb_f> to_float(ImageView<const Rgb_h> aSource, const Execution & aExecution = {});
+Image<math::hdr::Rgba_f> to_float(ImageView<const Rgba_h> aSource, const Execution & aExecution = {});
+
+/// \brief Tonemap linear values to SDR, encoding the color channels with the sRGB transfer function.
+///
+/// The alpha channel, if any, is tonemapped linearly.
+template <template<class> class TT_colorFormat>
+requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
+Image<TT_colorFormat<math::sdr::Value_t>> tonemapToSRGB(ImageView<const TT_colorFormat<float>> aSource,
+                                                        const Execution & aExecution = {});
+
+template <template<class> class TT_colorFormat>
+requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
+Image<TT_colorFormat<math::sdr::Value_t>> tonemapToSRGB(const Image<TT_colorFormat<float>> & aSource,
+                                                        const Execution & aExecution = {})
+{ return tonemapToSRGB(aSource.view(), aExecution); }
 
 template<class T_pixelFormat>
 requires math::is_color_v<T_pixelFormat>
-Image<T_pixelFormat> & decodeSRGBToLinear(Image<T_pixelFormat> & aImage);
+Image<T_pixelFormat> & decodeSRGBToLinear(Image<T_pixelFormat> & aImage,
+                                          const Execution & aExecution = {});
 
 
 template <class T_pixelFormat, std::forward_iterator T_iterator, class T_proj = std::identity>
@@ -330,15 +490,16 @@ Image<T_pixelFormat> Image<T_pixelFormat>::prepareArray(T_iterator aFirstPositio
         aDimension.width(),
         aDimension.height() * (int)std::distance(aFirstPosition, aLastPosition)};
 
-    auto target = std::make_unique<unsigned char[]>(targetDimensions.area() * pixel_size_v);
+    auto target = makeUninitialized(targetDimensions);
 
-    T_pixelFormat * destination = reinterpret_cast<T_pixelFormat *>(target.get());
-    for(; aFirstPosition != aLastPosition; ++aFirstPosition)
+    // Each element is copied directly from its zone in this image to its place in the array.
+    for(int element = 0; aFirstPosition != aLastPosition; ++aFirstPosition, ++element)
     {
-        destination = cropTo(destination, {*aFirstPosition, aDimension});
+        copyPixels(view({*aFirstPosition, aDimension}),
+                   target.view({{0, element * aDimension.height()}, aDimension}));
     }
 
-    return {targetDimensions, std::move(target)};
+    return target;
 }
 
 
@@ -346,9 +507,10 @@ template <class T_pixelFormat, std::forward_iterator T_iterator, class T_proj>
 Image<T_pixelFormat> stackVertical(T_iterator aFirst, T_iterator aLast, T_proj proj)
 {
     math::Size<2, int> atlasResolution = math::Size<2, int>::Zero();
+    // Note: the projection might return images or views, both are taken as views to avoid copies.
     std::ranges::for_each(
         aFirst, aLast,
-        [&](const Image<T_pixelFormat> & aImage)
+        [&](ImageView<const T_pixelFormat> aImage)
         {
             // TODO that would make a nice factorized function
             atlasResolution.width() = std::max(atlasResolution.width(), aImage.dimensions().width());
@@ -362,7 +524,7 @@ Image<T_pixelFormat> stackVertical(T_iterator aFirst, T_iterator aLast, T_proj p
     math::Vec<2, int> offset{0, 0};
     std::ranges::for_each(
         aFirst, aLast,
-        [&](const Image<T_pixelFormat> & aImage)
+        [&](ImageView<const T_pixelFormat> aImage)
         {
             result.pasteFrom(aImage, offset.as<math::Position>());
             offset.y() += aImage.dimensions().height();
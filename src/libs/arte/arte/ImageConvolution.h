@@ -1,11 +1,19 @@
 #pragma once
 
+#include "Execution.h"
 #include "Image.h"
 
 #include <math/Vector.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <functional>
 #include <numbers>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 
 namespace ad::arte {
@@ -39,83 +47,481 @@ struct Filter
 
 
 
+namespace detail {
+
+
+    /// \brief The taps contributing to each output coordinate along one axis, with their weights.
+    ///
+    /// It is computed once per axis, so the filter is evaluated `output size * taps` times
+    /// instead of once per tap of each output pixel.
+    class ResamplingAxis
+    {
+    public:
+        struct Tap
+        {
+            int mSource; // Already clamped to the input domain.
+            float mWeight;
+        };
+
+        template <class T_filter>
+        ResamplingAxis(int aInputSize, int aOutputSize, T_filter & aFilter) :
+            mOffsets(aOutputSize + 1, 0)
+        {
+            const float r = aFilter.mRadius;
+            const float delta = (float)aInputSize / (float)aOutputSize;
+            // With the convention that the image domain is (-0.5, N - 0.5)
+            const float x0 = -0.5f + delta/2;
+
+            for (std::size_t j = 0; j != (std::size_t)aOutputSize; ++j)
+            {
+                // coordinate of the output pixel, expressed in the input grid
+                float x = x0 + j * delta;
+                // For each pixel **center** that falls within the radius of the filter
+                // (the filter being centered on x, i.e. the output pixel)
+                // Indices outside of the domain sample the edge value (GL_CLAMP_TO_EDGE).
+                // (Skipping them instead would sample black pixels on boundaries, as with GL_CLAMP_TO_BORDER).
+                for (int k = (int)std::ceil(x - r); k <= std::floor(x + r); ++k)
+                {
+                    mTaps.push_back(Tap{
+                        .mSource = std::clamp(k, 0, aInputSize - 1),
+                        .mWeight = aFilter(x - k),
+                    });
+                }
+                mOffsets[j + 1] = mTaps.size();
+            }
+        }
+
+        std::span<const Tap> taps(std::size_t aOutput) const
+        {
+            return {mTaps.data() + mOffsets[aOutput], mTaps.data() + mOffsets[aOutput + 1]};
+        }
+
+        /// \brief The number of output coordinates.
+        std::size_t size() const
+        { return mOffsets.size() - 1; }
+
+        /// \brief Scale the weights of each output coordinate so they sum to 1.
+        ///
+        /// This is required when the filter is sampled too coarsely for its discrete sum to be 1,
+        /// e.g. box filters whose support is not a whole number of input pixels.
+        ResamplingAxis & normalize()
+        {
+            for (std::size_t j = 0; j != size(); ++j)
+            {
+                float sum = 0.f;
+                for (const auto & tap : taps(j))
+                {
+                    sum += tap.mWeight;
+                }
+                if (sum != 0.f)
+                {
+                    for (std::size_t t = mOffsets[j]; t != mOffsets[j + 1]; ++t)
+                    {
+                        mTaps[t].mWeight /= sum;
+                    }
+                }
+            }
+            return *this;
+        }
+
+    private:
+        std::vector<Tap> mTaps;
+        // The taps of output `j` are in the range [mOffsets[j], mOffsets[j + 1]).
+        std::vector<std::size_t> mOffsets;
+    };
+
+
+    /// \brief The weights of a ResamplingAxis, quantized to fixed-point.
+    class FixedPointResamplingAxis
+    {
+    public:
+        /// \brief Number of fractional bits of the weights.
+        static constexpr int gPrecision = 14;
+
+        struct Tap
+        {
+            int mSource;
+            std::int32_t mWeight;
+        };
+
+        explicit FixedPointResamplingAxis(const ResamplingAxis & aAxis)
+        {
+            mOffsets.reserve(aAxis.size() + 1);
+            mOffsets.push_back(0);
+            for (std::size_t j = 0; j != aAxis.size(); ++j)
+            {
+                float gain = 0.f;
+                for (const auto & tap : aAxis.taps(j))
+                {
+                    mTaps.push_back(Tap{
+                        .mSource = tap.mSource,
+                        .mWeight = static_cast<std::int32_t>(std::lround(tap.mWeight * (1 << gPrecision))),
+                    });
+                    gain += std::abs(tap.mWeight);
+                }
+                mOffsets.push_back(mTaps.size());
+                mGain = std::max(mGain, gain);
+            }
+        }
+
+        std::span<const Tap> taps(std::size_t aOutput) const
+        {
+            return {mTaps.data() + mOffsets[aOutput], mTaps.data() + mOffsets[aOutput + 1]};
+        }
+
+        /// \brief The largest sum of absolute weights over all outputs,
+        /// bounding the magnitude of the filtered values relative to the input values.
+        float gain() const
+        { return mGain; }
+
+    private:
+        std::vector<Tap> mTaps;
+        std::vector<std::size_t> mOffsets;
+        float mGain{0.f};
+    };
+
+
+} // namespace detail
+
+
+namespace detail {
+
+
+    /// \brief Resample `aInput` with the precomputed weights of each axis,
+    /// whose sizes define the output resolution.
+    ///
+    /// Both passes stream contiguous rows:
+    /// the horizontal pass reads each input row to produce an intermediary row,
+    /// the vertical pass accumulates whole weighted intermediary rows into each output row.
+    /// Each pass can distribute its rows according to `aExecution`.
+    template <class T_pixelFormat>
+    Image<T_pixelFormat> resampleSeparable2D(ImageView<const T_pixelFormat> aInput,
+                                             const ResamplingAxis & aHorizontal,
+                                             const ResamplingAxis & aVertical,
+                                             const Execution & aExecution)
+    {
+        const math::Size<2, int> outputResolution{(int)aHorizontal.size(), (int)aVertical.size()};
+
+        auto intermediary = arte::Image<T_pixelFormat>::makeUninitialized(
+                                {outputResolution.width(), (int)aInput.height()});
+
+        // Resample all the rows of the source
+        aExecution.forEachBand(aInput.height(), [&](int aFirstRow, int aEndRow)
+        {
+            for (std::size_t i = aFirstRow; i != (std::size_t)aEndRow; ++i)
+            {
+                const T_pixelFormat * inputRow = aInput.row(i);
+                T_pixelFormat * intermediaryRow = intermediary.row(i);
+                // For each pixel in the (intermediary) output row
+                for (std::size_t j = 0; j != (std::size_t)outputResolution.width(); ++j)
+                {
+                    T_pixelFormat accumulator{}; // assign zero
+                    for (const auto & tap : aHorizontal.taps(j))
+                    {
+                        accumulator += inputRow[tap.mSource] * tap.mWeight;
+                    }
+                    intermediaryRow[j] = accumulator;
+                }
+            }
+        });
+
+        auto output = arte::Image<T_pixelFormat>::makeUninitialized(outputResolution);
+
+        // Resample all the columns of the intermediary, one output row at a time
+        aExecution.forEachBand(outputResolution.height(), [&](int aFirstRow, int aEndRow)
+        {
+            for (std::size_t i = aFirstRow; i != (std::size_t)aEndRow; ++i)
+            {
+                T_pixelFormat * outputRow = output.row(i);
+                std::fill(outputRow, outputRow + outputResolution.width(), T_pixelFormat{}); // assign zero
+                for (const auto & tap : aVertical.taps(i))
+                {
+                    const T_pixelFormat * intermediaryRow = intermediary.row(tap.mSource);
+                    for (std::size_t j = 0; j != (std::size_t)outputResolution.width(); ++j)
+                    {
+                        outputRow[j] += intermediaryRow[j] * tap.mWeight;
+                    }
+                }
+            }
+        });
+
+        return output;
+    }
+
+
+} // namespace detail
+
+
+/// \brief Resample `aInput` to `aOutputResolution`, applying `aFilter` along each axis in turn.
+///
+/// The weights are precomputed once for each axis, see detail::resampleSeparable2D().
 // TODO this could be generalized to any type of sequence (in any dimension), thus moving to math
+template <class T_pixelFormat, class T_filter>
+Image<T_pixelFormat> resampleSeparable2D(ImageView<const T_pixelFormat> aInput,
+                                         math::Size<2, int> aOutputResolution,
+                                         T_filter aFilter,
+                                         const Execution & aExecution = {})
+{
+    return detail::resampleSeparable2D(
+        aInput,
+        detail::ResamplingAxis{aInput.width(), aOutputResolution.width(), aFilter},
+        detail::ResamplingAxis{aInput.height(), aOutputResolution.height(), aFilter},
+        aExecution);
+}
+
+
 template <class T_pixelFormat, class T_filter>
 Image<T_pixelFormat> resampleSeparable2D(const Image<T_pixelFormat> & aInput,
                                          math::Size<2, int> aOutputResolution,
-                                         T_filter aFilter)
+                                         T_filter aFilter,
+                                         const Execution & aExecution = {})
 {
-    const float r = aFilter.mRadius;
+    return resampleSeparable2D(aInput.view(), aOutputResolution, std::move(aFilter), aExecution);
+}
 
-    math::Vec<2, float> delta = 
-        math::Vec<2, float>{dimensions(aInput)}.cwDiv(static_cast<math::Vec<2, float>>(aOutputResolution));
 
-    auto intermediary = arte::Image<T_pixelFormat>::makeUninitialized(
-                            {aOutputResolution.width(), (int)aInput.height()});
+/// \brief Resample an image provided as successive bands of rows (from the top),
+/// producing each output row as soon as all the input rows it depends on were pushed.
+///
+/// Only the horizontally resampled input rows still required by the vertical filter are kept,
+/// so the memory is bounded by the filter support instead of by the image height.
+/// The results are identical to resampleSeparable2D().
+template <class T_pixelFormat>
+class BandResampler
+{
+public:
+    template <class T_filter>
+    BandResampler(math::Size<2, int> aInputResolution,
+                  math::Size<2, int> aOutputResolution,
+                  T_filter aFilter);
+
+    /// \brief Push the next rows of the input.
+    ///
+    /// Invokes `aSink(ImageView<const T_pixelFormat> aRows, int aFirstRow)` with the output rows
+    /// completed by this band, if any. The view is only valid during the call.
+    template <class F_sink>
+    void push(ImageView<const T_pixelFormat> aBand, F_sink && aSink);
+
+    /// \brief The index of the first output row not produced yet.
+    int nextOutputRow() const
+    { return mNextOutputRow; }
+
+    bool done() const
+    { return mNextOutputRow == (int)mVertical.size(); }
+
+private:
+    detail::ResamplingAxis mHorizontal;
+    detail::ResamplingAxis mVertical;
+    // For each output row, the last input row it depends on (non-decreasing).
+    std::vector<int> mLastSources;
+    math::Size<2, int> mInputResolution;
+    int mNextInputRow{0};
+    int mNextOutputRow{0};
+    // Horizontally resampled input rows, input row `i` being stored at row `i % mWindow.height()`.
+    Image<T_pixelFormat> mWindow;
+    // Reused storage for the output rows completed by a band.
+    Image<T_pixelFormat> mOutput;
+};
 
-    // With the convention that the image domain is (-0.5, Nx - 0.5) x (-0.5, Ny - 0.5)
-    float x0 = -0.5f + delta.x()/2;
-    float y0 = -0.5f + delta.y()/2;
 
-    // Resample all the rows of the source
-    for (std::size_t i = 0; i != (std::size_t)aInput.height(); ++i)
+template <class T_pixelFormat>
+template <class T_filter>
+BandResampler<T_pixelFormat>::BandResampler(math::Size<2, int> aInputResolution,
+                                            math::Size<2, int> aOutputResolution,
+                                            T_filter aFilter) :
+    mHorizontal{aInputResolution.width(), aOutputResolution.width(), aFilter},
+    mVertical{aInputResolution.height(), aOutputResolution.height(), aFilter},
+    mInputResolution{aInputResolution}
+{
+    // The window must hold all the input rows of any output row,
+    // which are completed as soon as their last input row is pushed.
+    int windowHeight = 1;
+    for (std::size_t i = 0; i != mVertical.size(); ++i)
+    {
+        auto [first, last] = std::ranges::minmax(mVertical.taps(i), {}, &detail::ResamplingAxis::Tap::mSource);
+        mLastSources.push_back(last.mSource);
+        windowHeight = std::max(windowHeight, last.mSource - first.mSource + 1);
+    }
+    mWindow = Image<T_pixelFormat>::makeUninitialized({aOutputResolution.width(), windowHeight});
+}
+
+
+template <class T_pixelFormat>
+template <class F_sink>
+void BandResampler<T_pixelFormat>::push(ImageView<const T_pixelFormat> aBand, F_sink && aSink)
+{
+    if (aBand.width() != mInputResolution.width()
+        || mNextInputRow + aBand.height() > mInputResolution.height())
+    {
+        throw std::out_of_range{"The band does not fit in the remaining input rows."};
+    }
+
+    const int endInputRow = mNextInputRow + aBand.height();
+    const int firstOutputRow = mNextOutputRow;
+    const int completedRows = static_cast<int>(
+        std::upper_bound(mLastSources.begin() + mNextOutputRow, mLastSources.end(), endInputRow - 1)
+        - (mLastSources.begin() + mNextOutputRow));
+    if (mOutput.height() < completedRows)
     {
-        // For each pixel in the (intermediary) output row
-        for (std::size_t j = 0; j != (std::size_t)aOutputResolution.width(); ++j)
+        mOutput = Image<T_pixelFormat>::makeUninitialized({(int)mHorizontal.size(), completedRows});
+    }
+
+    const std::size_t outputWidth = mHorizontal.size();
+    for (int bandRow = 0; bandRow != aBand.height(); ++bandRow, ++mNextInputRow)
+    {
+        const T_pixelFormat * inputRow = aBand.row(bandRow);
+        T_pixelFormat * windowRow = mWindow.row(mNextInputRow % mWindow.height());
+        for (std::size_t j = 0; j != outputWidth; ++j)
         {
-            intermediary[j][i] = T_pixelFormat{}; // assign zero
-            // x coordinate of the output pixel, expressed in the input grid
-            float x = x0 + j * delta.x();
-            // For each pixel **center** that falls within the radius of the filter
-            // (the filter being centered on x, i.e. the output pixel)
-
-            // The commented loop would sample black pixels on boundaries (dimming the edges)
-            // (GL_CLAMP_TO_BORDER with a black border)
-            //for (std::size_t k = (std::size_t)std::max<float>(std::ceil(x - r), 0);
-            //     k <= std::min<std::size_t>((std::size_t)std::floor(x + r), aInput.width() - 1);
-            //     ++k)
-            //{
-            //    intermediary[j][i] += aInput[k][i] * aFilter(x - k);
-            //}
-
-            // This Sample the edge color (GL_CLAMP_TO_EDGE)
-            for (int k = (int)std::ceil(x - r); k <= std::floor(x + r); ++k)
+            T_pixelFormat accumulator{}; // assign zero
+            for (const auto & tap : mHorizontal.taps(j))
             {
-                std::size_t column = std::clamp(k, 0, aInput.width() - 1);
-                intermediary[j][i] += aInput[column][i] * aFilter(x - k);
+                accumulator += inputRow[tap.mSource] * tap.mWeight;
             }
+            windowRow[j] = accumulator;
         }
+
+        for (; mNextOutputRow != (int)mVertical.size() && mLastSources[mNextOutputRow] == mNextInputRow;
+             ++mNextOutputRow)
+        {
+            T_pixelFormat * outputRow = mOutput.row(mNextOutputRow - firstOutputRow);
+            std::fill(outputRow, outputRow + outputWidth, T_pixelFormat{}); // assign zero
+            for (const auto & tap : mVertical.taps(mNextOutputRow))
+            {
+                const T_pixelFormat * intermediaryRow = mWindow.row(tap.mSource % mWindow.height());
+                for (std::size_t j = 0; j != outputWidth; ++j)
+                {
+                    outputRow[j] += intermediaryRow[j] * tap.mWeight;
+                }
+            }
+        }
+    }
+
+    if (completedRows != 0)
+    {
+        aSink(std::as_const(mOutput).view({{0, 0}, {(int)outputWidth, completedRows}}), firstOutputRow);
     }
+}
 
-    auto output = arte::Image<T_pixelFormat>::makeUninitialized(aOutputResolution);
 
-    // Resample all the columns of the intermediary
-    for (std::size_t j = 0; j != (std::size_t)aOutputResolution.width(); ++j)
+/// \brief Resample an 8-bit SDR image with integer arithmetic, without converting it to HDR.
+///
+/// The weights are quantized to Q14. The horizontal pass accumulates on 32 bits into a 16-bit
+/// intermediary keeping as many fractional bits as the filter gain allows (so the filter overshoots
+/// are not clamped between passes, as with the float path). The vertical pass accumulates
+/// on 32 bits, then rounds and clamps to 8 bits.
+/// The result is within 1 of `tonemap(resampleSeparable2D(to_hdr(aInput), ...))`,
+/// without the float copies of the input and of the intermediary.
+///
+/// \throw std::domain_error if the filter gain is too large for the fixed-point intermediaries.
+template <template<class> class TT_colorFormat, class T_filter>
+requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
+Image<TT_colorFormat<math::sdr::Value_t>> resampleSeparable2DFixedPoint(
+    ImageView<const TT_colorFormat<math::sdr::Value_t>> aInput,
+    math::Size<2, int> aOutputResolution,
+    T_filter aFilter,
+    const Execution & aExecution = {})
+{
+    using Pixel_t = TT_colorFormat<math::sdr::Value_t>;
+    using Axis_t = detail::FixedPointResamplingAxis;
+    constexpr int weightPrecision = Axis_t::gPrecision;
+    constexpr std::size_t channels = sizeof(Pixel_t);
+
+    const Axis_t horizontal{detail::ResamplingAxis{aInput.width(), aOutputResolution.width(), aFilter}};
+    const Axis_t vertical{detail::ResamplingAxis{aInput.height(), aOutputResolution.height(), aFilter}};
+
+    // Fractional bits of the intermediary values, as many as fit in 16 bits (up to 7, in excess already).
+    int intermediaryPrecision = 7;
+    while (intermediaryPrecision >= 0
+           && horizontal.gain() * 255.f * (1 << intermediaryPrecision) > (float)INT16_MAX)
     {
-        for (std::size_t i = 0; i != (std::size_t)aOutputResolution.height(); ++i)
+        --intermediaryPrecision;
+    }
+    // The vertical accumulation must fit in 32 bits.
+    if (intermediaryPrecision < 0
+        || vertical.gain() * (float)INT16_MAX * (1 << weightPrecision) > (float)INT32_MAX)
+    {
+        throw std::domain_error{"The filter gain is too large for fixed-point resampling."};
+    }
+
+    const int horizontalShift = weightPrecision - intermediaryPrecision;
+    const int verticalShift = weightPrecision + intermediaryPrecision;
+
+    // Tightly packed intermediary, with the channels of each pixel interleaved.
+    const std::size_t intermediaryLine = aOutputResolution.width() * channels;
+    std::vector<std::int16_t> intermediary(intermediaryLine * aInput.height());
+
+    // Resample all the rows of the source
+    aExecution.forEachBand(aInput.height(), [&](int aFirstRow, int aEndRow)
+    {
+        for (std::size_t i = aFirstRow; i != (std::size_t)aEndRow; ++i)
         {
-            output[j][i] = T_pixelFormat{}; // assign zero
-            float y = y0 + i * delta.y();
+            const auto * inputRow = reinterpret_cast<const std::uint8_t *>(aInput.row(i));
+            std::int16_t * intermediaryRow = intermediary.data() + i * intermediaryLine;
+            for (std::size_t j = 0; j != (std::size_t)aOutputResolution.width(); ++j)
+            {
+                std::int32_t accumulators[channels] = {};
+                for (const auto & tap : horizontal.taps(j))
+                {
+                    const std::uint8_t * source = inputRow + tap.mSource * channels;
+                    for (std::size_t c = 0; c != channels; ++c)
+                    {
+                        accumulators[c] += source[c] * tap.mWeight;
+                    }
+                }
+                for (std::size_t c = 0; c != channels; ++c)
+                {
+                    // Right shift of negative values is arithmetic since C++20, i.e. rounds toward -inf.
+                    intermediaryRow[j * channels + c] = static_cast<std::int16_t>(
+                        (accumulators[c] + (1 << (horizontalShift - 1))) >> horizontalShift);
+                }
+            }
+        }
+    });
 
-            //for (std::size_t k = (std::size_t)std::max<float>(std::ceil(y - r), 0);
-            //     k <= std::min<std::size_t>((std::size_t)std::floor(y + r), intermediary.height() - 1);
-            //     ++k)
-            //{
-            //    output[j][i] += intermediary[j][k] * aFilter(y - k);
-            //}
+    auto output = arte::Image<Pixel_t>::makeUninitialized(aOutputResolution);
 
-            for (int k = (int)std::ceil(y - r); k <= std::floor(y + r); ++k)
+    // Resample all the columns of the intermediary, one output row at a time
+    aExecution.forEachBand(aOutputResolution.height(), [&](int aFirstRow, int aEndRow)
+    {
+        std::vector<std::int32_t> accumulators(intermediaryLine);
+        for (std::size_t i = aFirstRow; i != (std::size_t)aEndRow; ++i)
+        {
+            std::fill(accumulators.begin(), accumulators.end(), 0);
+            for (const auto & tap : vertical.taps(i))
+            {
+                const std::int16_t * intermediaryRow = intermediary.data() + tap.mSource * intermediaryLine;
+                for (std::size_t k = 0; k != intermediaryLine; ++k)
+                {
+                    accumulators[k] += intermediaryRow[k] * tap.mWeight;
+                }
+            }
+
+            auto * outputRow = reinterpret_cast<std::uint8_t *>(output.row(i));
+            for (std::size_t k = 0; k != intermediaryLine; ++k)
             {
-                std::size_t row = std::clamp(k, 0, intermediary.height() - 1);
-                output[j][i] += intermediary[j][row] * aFilter(y - k);
+                outputRow[k] = static_cast<std::uint8_t>(
+                    std::clamp((accumulators[k] + (1 << (verticalShift - 1))) >> verticalShift, 0, 255));
             }
         }
-    }
+    });
 
     return output;
 }
 
 
+template <template<class> class TT_colorFormat, class T_filter>
+requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
+Image<TT_colorFormat<math::sdr::Value_t>> resampleSeparable2DFixedPoint(
+    const Image<TT_colorFormat<math::sdr::Value_t>> & aInput,
+    math::Size<2, int> aOutputResolution,
+    T_filter aFilter,
+    const Execution & aExecution = {})
+{
+    return resampleSeparable2DFixedPoint(aInput.view(), aOutputResolution, std::move(aFilter), aExecution);
+}
+
+
 template <class T_value = float>
 T_value gaussian(T_value x, T_value sigma, T_value scale)
 {
@@ -151,14 +557,25 @@ T_value catmullRom(T_value x, T_value scale = 1)
 }
 
 
-// TODO limit to sdr images
+/// \brief Resample an SDR image with a Catmull-Rom filter, directly on its 8-bit channels.
+template <class T_pixelFormat>
+Image<T_pixelFormat> resampleImage(ImageView<const T_pixelFormat> aInput,
+                                   math::Size<2, int> aOutputResolution,
+                                   const Execution & aExecution = {})
+{
+    return resampleSeparable2DFixedPoint(aInput,
+                                         aOutputResolution,
+                                         Filter{.mFilterFunc = [](float x){return catmullRom(x);}, .mRadius = 2.},
+                                         aExecution);
+}
+
+
 template <class T_pixelFormat>
 Image<T_pixelFormat> resampleImage(const Image<T_pixelFormat> & aInput,
-                                   math::Size<2, int> aOutputResolution)
+                                   math::Size<2, int> aOutputResolution,
+                                   const Execution & aExecution = {})
 {
-    return tonemap(resampleSeparable2D(to_hdr(aInput),
-                                       aOutputResolution,
-                                       Filter{.mFilterFunc = [](float x){return catmullRom(x);}, .mRadius = 2.}));
+    return resampleImage(aInput.view(), aOutputResolution, aExecution);
 }
 
 
@@ -0,0 +1,76 @@
+#include "ImageLoader.h"
+
+
+namespace ad {
+namespace arte {
+
+
+namespace detail {
+
+
+void DecodingBudget::submit(std::size_t aBytes, std::function<void()> aDecode)
+{
+    std::lock_guard lock{mMutex};
+    mPending.push_back({aBytes, std::move(aDecode)});
+    dispatchPending();
+}
+
+
+void DecodingBudget::release(std::size_t aBytes)
+{
+    std::lock_guard lock{mMutex};
+    mInFlightBytes -= aBytes;
+    dispatchPending();
+}
+
+
+void DecodingBudget::abandon()
+{
+    std::deque<Pending> abandoned;
+    {
+        std::lock_guard lock{mMutex};
+        mPool = nullptr;
+        abandoned.swap(mPending);
+    }
+    // Destroying the decodes outside of the lock breaks their promises.
+}
+
+
+void DecodingBudget::dispatchPending()
+{
+    // In request order. When nothing else is in flight, an image larger than the budget is admitted anyway.
+    while (mPool != nullptr
+           && !mPending.empty()
+           && (mInFlightBytes == 0 || mInFlightBytes + mPending.front().mBytes <= mMaxBytes))
+    {
+        mInFlightBytes += mPending.front().mBytes;
+        mPool->push(std::move(mPending.front().mDecode));
+        mPending.pop_front();
+    }
+}
+
+
+} // namespace detail
+
+
+ImageLoader::ImageLoader(std::size_t aMaxInFlightBytes) :
+    mOwnedPool{std::make_unique<ThreadPool>()},
+    mBudget{std::make_shared<detail::DecodingBudget>(aMaxInFlightBytes, *mOwnedPool)}
+{}
+
+
+ImageLoader::ImageLoader(ThreadPool & aPool, std::size_t aMaxInFlightBytes) :
+    mBudget{std::make_shared<detail::DecodingBudget>(aMaxInFlightBytes, aPool)}
+{}
+
+
+ImageLoader::~ImageLoader()
+{
+    // The decodes already dispatched are completed by the pool (joined after this body for an owned pool),
+    // the images they produce no longer dispatch anything when they are taken.
+    mBudget->abandon();
+}
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,294 @@
+#pragma once
+
+#include "Image.h"
+#include "ThreadPool.h"
+
+#include <platform/Filesystem.h>
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+
+
+namespace detail {
+
+    /// \brief The bytes of the rasters in flight for an ImageLoader, and the loads waiting for them.
+    ///
+    /// Shared by the loader, its queued decodes, and the decoded images not yet taken.
+    class DecodingBudget
+    {
+    public:
+        DecodingBudget(std::size_t aMaxBytes, ThreadPool & aPool) :
+            mMaxBytes{aMaxBytes},
+            mPool{&aPool}
+        {}
+
+        /// \brief Queue `aDecode`, pushing it to the pool as soon as `aBytes` fit in the budget.
+        ///
+        /// The bytes are counted from the dispatch, and must be returned via `release()`.
+        void submit(std::size_t aBytes, std::function<void()> aDecode);
+
+        void release(std::size_t aBytes);
+
+        /// \brief Stop dispatching, the loads still waiting for budget are dropped.
+        void abandon();
+
+        const std::size_t mMaxBytes;
+
+    private:
+        struct Pending
+        {
+            std::size_t mBytes;
+            std::function<void()> mDecode;
+        };
+
+        /// \attention `mMutex` must be held.
+        void dispatchPending();
+
+        std::size_t mInFlightBytes{0};
+        std::deque<Pending> mPending;
+        ThreadPool * mPool;
+        std::mutex mMutex;
+    };
+
+
+    /// \brief Returns its bytes to a DecodingBudget on destruction.
+    class BudgetTicket
+    {
+    public:
+        BudgetTicket() = default;
+
+        BudgetTicket(std::shared_ptr<DecodingBudget> aBudget, std::size_t aBytes) :
+            mBudget{std::move(aBudget)},
+            mBytes{aBytes}
+        {}
+
+        ~BudgetTicket()
+        { reset(); }
+
+        BudgetTicket(BudgetTicket && aRhs) noexcept :
+            mBudget{std::move(aRhs.mBudget)},
+            mBytes{aRhs.mBytes}
+        {}
+
+        BudgetTicket & operator=(BudgetTicket && aRhs) noexcept
+        {
+            reset();
+            mBudget = std::move(aRhs.mBudget);
+            mBytes = aRhs.mBytes;
+            return *this;
+        }
+
+        void reset()
+        {
+            if (mBudget)
+            {
+                mBudget->release(mBytes);
+                mBudget.reset();
+            }
+        }
+
+    private:
+        std::shared_ptr<DecodingBudget> mBudget;
+        std::size_t mBytes{0};
+    };
+
+} // namespace detail
+
+
+/// \brief An image decoded by an ImageLoader, which counts in the loader budget until it is taken.
+template <class T_pixelFormat>
+class LoadedImage
+{
+public:
+    LoadedImage(Image<T_pixelFormat> aImage, detail::BudgetTicket aTicket) :
+        mImage{std::move(aImage)},
+        mTicket{std::move(aTicket)}
+    {}
+
+    /// \brief Move the image out, returning its bytes to the loader budget.
+    Image<T_pixelFormat> take()
+    {
+        Image<T_pixelFormat> result = std::move(mImage);
+        mTicket.reset();
+        return result;
+    }
+
+    const Image<T_pixelFormat> & image() const
+    { return mImage; }
+
+private:
+    Image<T_pixelFormat> mImage;
+    detail::BudgetTicket mTicket;
+};
+
+
+/// \brief Decodes images concurrently on the workers of a ThreadPool, providing them through futures.
+///
+/// The sum of the raster sizes of the images in flight is capped. An image is in flight from the start
+/// of its decode until it is taken from its LoadedImage (or the LoadedImage is destroyed), so the decoded
+/// images waiting in their futures are counted.
+/// The raster size is known from probing the image header when the load is requested.
+/// Loads which do not fit in the budget wait in the loader, in request order, without occupying a worker.
+/// An image larger than the complete budget is loaded alone.
+///
+/// \attention Since a load can wait for earlier images to be taken, the futures should be consumed in
+/// request order (or the earlier images taken) before waiting on later futures.
+class ImageLoader
+{
+public:
+    static constexpr std::size_t gDefaultMaxInFlightBytes = 512/*MB*/ * 1024 * 1024;
+
+    /// \brief Decode on a pool owned by the loader, with one worker per hardware thread.
+    explicit ImageLoader(std::size_t aMaxInFlightBytes = gDefaultMaxInFlightBytes);
+
+    /// \brief Decode on the workers of `aPool`, which must outlive the loader and the pending loads.
+    explicit ImageLoader(ThreadPool & aPool, std::size_t aMaxInFlightBytes = gDefaultMaxInFlightBytes);
+
+    /// \brief The loads still waiting for budget are abandoned, their futures throw std::future_error.
+    ~ImageLoader();
+
+    ImageLoader(const ImageLoader &) = delete;
+    ImageLoader & operator=(const ImageLoader &) = delete;
+
+    /// \brief Queue the decoding of `aImageFile`, its format being deduced from the extension.
+    template <class T_pixelFormat>
+    std::future<LoadedImage<T_pixelFormat>> load(filesystem::path aImageFile,
+                                                 ImageOrientation aOrientation = ImageOrientation::Unchanged);
+
+    /// \brief Queue the decoding of the image in `aIn`, its format being detected from the content.
+    /// \attention `aIn` must be seekable, and outlive the load.
+    template <class T_pixelFormat>
+    std::future<LoadedImage<T_pixelFormat>> load(std::istream & aIn,
+                                                 ImageOrientation aOrientation = ImageOrientation::Unchanged);
+
+    /// \brief Queue the decoding of each image file in `aImageFiles`.
+    /// \return The futures, in the order of `aImageFiles`.
+    template <class T_pixelFormat, std::ranges::input_range T_range>
+    std::vector<std::future<LoadedImage<T_pixelFormat>>> loadAll(
+        const T_range & aImageFiles,
+        ImageOrientation aOrientation = ImageOrientation::Unchanged);
+
+    std::size_t maxInFlightBytes() const
+    { return mBudget->mMaxBytes; }
+
+private:
+    /// \brief Probe the image with `aProbe` on the calling thread, then submit its decode by `aDecode`
+    /// (invoked with the probe) to the budget.
+    template <class T_pixelFormat, class F_probe, class F_decode>
+    std::future<LoadedImage<T_pixelFormat>> submit(F_probe && aProbe, F_decode aDecode);
+
+    // Computed in std::size_t, the int area() overflows for the large images the budget is about.
+    template <class T_pixelFormat>
+    static std::size_t rasterSize(const ImageProbe & aProbe)
+    {
+        return static_cast<std::size_t>(aProbe.mDimensions.width())
+               * static_cast<std::size_t>(aProbe.mDimensions.height())
+               * sizeof(T_pixelFormat);
+    }
+
+    // Declared first, the budget dispatches to it.
+    std::unique_ptr<ThreadPool> mOwnedPool;
+    std::shared_ptr<detail::DecodingBudget> mBudget;
+};
+
+
+//
+// Implementations
+//
+template <class T_pixelFormat, class F_probe, class F_decode>
+std::future<LoadedImage<T_pixelFormat>> ImageLoader::submit(F_probe && aProbe, F_decode aDecode)
+{
+    // std::function requires a copyable callable, which a promise is not.
+    auto promise = std::make_shared<std::promise<LoadedImage<T_pixelFormat>>>();
+    std::future<LoadedImage<T_pixelFormat>> result = promise->get_future();
+
+    ImageProbe probe;
+    try
+    {
+        probe = aProbe();
+    }
+    catch (...)
+    {
+        promise->set_exception(std::current_exception());
+        return result;
+    }
+
+    const std::size_t bytes = rasterSize<T_pixelFormat>(probe);
+    mBudget->submit(bytes, [budget = mBudget, bytes, promise, probe, decode = std::move(aDecode)]()
+    {
+        // Adopts the bytes counted when this decode was dispatched.
+        detail::BudgetTicket ticket{budget, bytes};
+        try
+        {
+            promise->set_value(LoadedImage<T_pixelFormat>{decode(probe), std::move(ticket)});
+        }
+        catch (...)
+        {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return result;
+}
+
+
+template <class T_pixelFormat>
+std::future<LoadedImage<T_pixelFormat>> ImageLoader::load(filesystem::path aImageFile,
+                                                          ImageOrientation aOrientation)
+{
+    return submit<T_pixelFormat>(
+        [&aImageFile]()
+        {
+            return probeImage(aImageFile);
+        },
+        [imageFile = aImageFile, aOrientation](const ImageProbe &)
+        {
+            return Image<T_pixelFormat>::LoadFile(imageFile, aOrientation);
+        });
+}
+
+
+template <class T_pixelFormat>
+std::future<LoadedImage<T_pixelFormat>> ImageLoader::load(std::istream & aIn, ImageOrientation aOrientation)
+{
+    return submit<T_pixelFormat>(
+        [&aIn]()
+        {
+            const std::streampos start = aIn.tellg();
+            const ImageProbe probe = probeImage(aIn);
+            aIn.clear();
+            aIn.seekg(start);
+            return probe;
+        },
+        [&aIn, aOrientation](const ImageProbe & aProbe)
+        {
+            return Image<T_pixelFormat>::Read(aProbe.mFormat, aIn, aOrientation);
+        });
+}
+
+
+template <class T_pixelFormat, std::ranges::input_range T_range>
+std::vector<std::future<LoadedImage<T_pixelFormat>>> ImageLoader::loadAll(const T_range & aImageFiles,
+                                                                          ImageOrientation aOrientation)
+{
+    std::vector<std::future<LoadedImage<T_pixelFormat>>> result;
+    for (const auto & imageFile : aImageFiles)
+    {
+        result.push_back(load<T_pixelFormat>(filesystem::path{imageFile}, aOrientation));
+    }
+    return result;
+}
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,224 @@
+#include "ImageStream.h"
+
+#include "detail/ImageFormats/Netpbm.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+
+namespace ad {
+namespace arte {
+
+
+namespace {
+
+
+    /// \brief True if `aFormat` is the Netpbm format storing pixels of type `T_pixelFormat`,
+    /// in which case the rows can be streamed.
+    template <class T_pixelFormat>
+    bool isStreamable(ImageFormat aFormat)
+    {
+        if constexpr (detail::has_netpbm_format_v<T_pixelFormat>)
+        {
+            switch (detail::pixel_format_trait<T_pixelFormat>::value)
+            {
+            case detail::NetpbmFormat::Pgm:
+                return aFormat == ImageFormat::Pgm;
+            case detail::NetpbmFormat::Ppm:
+                return aFormat == ImageFormat::Ppm;
+            }
+        }
+        return false;
+    }
+
+
+    template <class T_pixelFormat>
+    using NetpbmOf = detail::Netpbm<detail::pixel_format_trait<T_pixelFormat>::value>;
+
+
+} // anonymous namespace
+
+
+//
+// BandReader
+//
+template <class T_pixelFormat>
+BandReader<T_pixelFormat>::BandReader(std::istream & aIn, ImageFormat aFormat) :
+    mIn{&aIn},
+    mFormat{aFormat}
+{
+    readHeader();
+}
+
+
+template <class T_pixelFormat>
+BandReader<T_pixelFormat>::BandReader(const filesystem::path & aImageFile) :
+    mOwnedStream{std::make_unique<std::ifstream>(aImageFile.string(),
+                                                 std::ios_base::in | std::ios_base::binary)},
+    mIn{mOwnedStream.get()},
+    mFormat{from_extension(aImageFile.extension())}
+{
+    if (!*mOwnedStream)
+    {
+        throw std::runtime_error{"Cannot open image file '" + aImageFile.string() + "' for reading."};
+    }
+    readHeader();
+}
+
+
+template <class T_pixelFormat>
+void BandReader<T_pixelFormat>::readHeader()
+{
+    if constexpr (detail::has_netpbm_format_v<T_pixelFormat>)
+    {
+        if (isStreamable<T_pixelFormat>(mFormat))
+        {
+            mDimensions = NetpbmOf<T_pixelFormat>::ReadHeader(*mIn);
+            return;
+        }
+    }
+
+    mBuffer = Image<T_pixelFormat>::Read(mFormat, *mIn);
+    mDimensions = mBuffer.dimensions();
+}
+
+
+template <class T_pixelFormat>
+ImageView<const T_pixelFormat> BandReader<T_pixelFormat>::read(int aMaxRows)
+{
+    if (aMaxRows <= 0)
+    {
+        throw std::invalid_argument{"Bands must have a strictly positive number of rows, not "
+                                    + std::to_string(aMaxRows) + "."};
+    }
+
+    const int rows = std::min(aMaxRows, mDimensions.height() - mNextRow);
+    const int firstRow = mNextRow;
+    mNextRow += rows;
+
+    if constexpr (detail::has_netpbm_format_v<T_pixelFormat>)
+    {
+        if (isStreamable<T_pixelFormat>(mFormat))
+        {
+            using Netpbm = NetpbmOf<T_pixelFormat>;
+
+            // The band buffer is reused, only growing when larger bands are requested.
+            if (mBuffer.height() < rows)
+            {
+                mBuffer = Image<T_pixelFormat>::makeUninitialized({mDimensions.width(), rows});
+            }
+            Netpbm::ReadVerticalDefault(*mIn,
+                                        rows * mBuffer.size_bytes_line(),
+                                        reinterpret_cast<unsigned char *>(mBuffer.data()));
+
+            if (done() && (mIn->peek(), !mIn->eof()))
+            {
+                throw std::runtime_error("Invalid " + detail::to_string(detail::pixel_format_trait<T_pixelFormat>::value)
+                                         + " content: trailing data");
+            }
+            return mBuffer.view({{0, 0}, {mDimensions.width(), rows}});
+        }
+    }
+
+    return mBuffer.view({{0, firstRow}, {mDimensions.width(), rows}});
+}
+
+
+//
+// BandWriter
+//
+template <class T_pixelFormat>
+BandWriter<T_pixelFormat>::BandWriter(std::ostream & aOut,
+                                      ImageFormat aFormat,
+                                      math::Size<2, int> aDimensions) :
+    mOut{&aOut},
+    mFormat{aFormat},
+    mDimensions{aDimensions}
+{
+    writeHeader();
+}
+
+
+template <class T_pixelFormat>
+BandWriter<T_pixelFormat>::BandWriter(const filesystem::path & aImageFile,
+                                      math::Size<2, int> aDimensions) :
+    mOwnedStream{std::make_unique<std::ofstream>(aImageFile.string(),
+                                                 std::ios_base::out | std::ios_base::binary)},
+    mOut{mOwnedStream.get()},
+    mFormat{from_extension(aImageFile.extension())},
+    mDimensions{aDimensions}
+{
+    if (!*mOwnedStream)
+    {
+        throw std::runtime_error{"Cannot open image file '" + aImageFile.string() + "' for writing."};
+    }
+    writeHeader();
+}
+
+
+template <class T_pixelFormat>
+void BandWriter<T_pixelFormat>::writeHeader()
+{
+    if constexpr (detail::has_netpbm_format_v<T_pixelFormat>)
+    {
+        if (isStreamable<T_pixelFormat>(mFormat))
+        {
+            if (!mOut->good())
+            {
+                throw std::runtime_error("Output stream is not valid for writing");
+            }
+            *mOut << NetpbmOf<T_pixelFormat>::MakeHeader(mDimensions);
+            return;
+        }
+    }
+
+    mAssembled = Image<T_pixelFormat>::makeUninitialized(mDimensions);
+}
+
+
+template <class T_pixelFormat>
+void BandWriter<T_pixelFormat>::write(ImageView<const T_pixelFormat> aBand)
+{
+    if (aBand.width() != mDimensions.width() || mNextRow + aBand.height() > mDimensions.height())
+    {
+        throw std::out_of_range{"The band does not fit in the remaining rows of the written image."};
+    }
+    const int firstRow = mNextRow;
+    mNextRow += aBand.height();
+
+    if constexpr (detail::has_netpbm_format_v<T_pixelFormat>)
+    {
+        if (isStreamable<T_pixelFormat>(mFormat))
+        {
+            NetpbmOf<T_pixelFormat>::WriteVerticalDefault(*mOut, aBand);
+            if (done())
+            {
+                mOut->flush();
+            }
+            return;
+        }
+    }
+
+    copyPixels(aBand, mAssembled.view({{0, firstRow}, aBand.dimensions()}));
+    if (done())
+    {
+        mAssembled.write(mFormat, *mOut);
+        // The assembled image is not needed anymore.
+        mAssembled = Image<T_pixelFormat>{};
+        mOut->flush();
+    }
+}
+
+
+template class BandReader<math::sdr::Rgb>;
+template class BandReader<math::sdr::Rgba>;
+template class BandReader<math::sdr::Grayscale>;
+
+template class BandWriter<math::sdr::Rgb>;
+template class BandWriter<math::sdr::Rgba>;
+template class BandWriter<math::sdr::Grayscale>;
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Image.h"
+#include "ImageView.h"
+
+#include <platform/Filesystem.h>
+
+#include <math/Color.h>
+
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief Reads an image as successive horizontal bands of rows, from the top of the image.
+///
+/// For Netpbm formats, the rows are read from the stream as they are requested,
+/// so only the current band is ever held in memory.
+/// \attention stb_image does not offer incremental decoding,
+/// so the other formats are decoded at once, and the bands are views into the decoded image.
+template <class T_pixelFormat>
+class BandReader
+{
+public:
+    using pixel_format_t = T_pixelFormat;
+
+    /// \brief Read from `aIn`, which must outlive the reader.
+    BandReader(std::istream & aIn, ImageFormat aFormat);
+
+    /// \brief Read the file `aImageFile`, its format being deduced from the extension.
+    explicit BandReader(const filesystem::path & aImageFile);
+
+    math::Size<2, int> dimensions() const
+    { return mDimensions; }
+
+    /// \brief The index of the first row of the next band.
+    int nextRow() const
+    { return mNextRow; }
+
+    bool done() const
+    { return mNextRow == mDimensions.height(); }
+
+    /// \brief Read the next band, of at most `aMaxRows` rows.
+    /// \return A view valid until the next call, which is empty once all rows were read.
+    /// \throw std::invalid_argument if `aMaxRows` is not strictly positive.
+    ImageView<const pixel_format_t> read(int aMaxRows);
+
+private:
+    void readHeader();
+
+    std::unique_ptr<std::ifstream> mOwnedStream;
+    std::istream * mIn;
+    ImageFormat mFormat;
+    math::Size<2, int> mDimensions{0, 0};
+    int mNextRow{0};
+    // Either the current band (Netpbm), or the complete decoded image (other formats).
+    Image<pixel_format_t> mBuffer;
+};
+
+
+/// \brief Writes an image provided as successive horizontal bands of rows, from the top of the image.
+///
+/// For Netpbm formats, each band is written to the stream immediately.
+/// \attention stb_image_write requires the complete image,
+/// so the bands of other formats are assembled in memory and written when the last row is provided.
+template <class T_pixelFormat>
+class BandWriter
+{
+public:
+    using pixel_format_t = T_pixelFormat;
+
+    /// \brief Write to `aOut`, which must outlive the writer.
+    BandWriter(std::ostream & aOut, ImageFormat aFormat, math::Size<2, int> aDimensions);
+
+    /// \brief Write the file `aImageFile`, its format being deduced from the extension.
+    BandWriter(const filesystem::path & aImageFile, math::Size<2, int> aDimensions);
+
+    math::Size<2, int> dimensions() const
+    { return mDimensions; }
+
+    int nextRow() const
+    { return mNextRow; }
+
+    bool done() const
+    { return mNextRow == mDimensions.height(); }
+
+    /// \brief Write the rows of `aBand` following the previously written rows.
+    /// \throw std::out_of_range if this would write past the last row.
+    void write(ImageView<const pixel_format_t> aBand);
+
+private:
+    void writeHeader();
+
+    std::unique_ptr<std::ofstream> mOwnedStream;
+    std::ostream * mOut;
+    ImageFormat mFormat;
+    math::Size<2, int> mDimensions;
+    int mNextRow{0};
+    // Only used for non Netpbm formats.
+    Image<pixel_format_t> mAssembled;
+};
+
+
+/// \brief Invoke `aBandCallback(ImageView<const T_pixelFormat> aBand, int aFirstRow)`
+/// on each successive band of at most `aBandRows` rows read from `aReader`.
+/// \throw std::invalid_argument if `aBandRows` is not strictly positive.
+template <class T_pixelFormat, class F_bandCallback>
+void readBands(BandReader<T_pixelFormat> & aReader, int aBandRows, F_bandCallback && aBandCallback)
+{
+    // Otherwise, the reader would never advance.
+    if (aBandRows <= 0)
+    {
+        throw std::invalid_argument{"Bands must have a strictly positive number of rows, not "
+                                    + std::to_string(aBandRows) + "."};
+    }
+
+    while (!aReader.done())
+    {
+        const int firstRow = aReader.nextRow();
+        aBandCallback(aReader.read(aBandRows), firstRow);
+    }
+}
+
+
+using BandReaderRgb = BandReader<math::sdr::Rgb>;
+using BandWriterRgb = BandWriter<math::sdr::Rgb>;
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <math/Rectangle.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief Non-owning view over a rectangle of pixels, whose rows are separated by an arbitrary stride.
+///
+/// The stride is expressed in bytes, so a view can address any sub-rectangle of a raster
+/// (as well as rasters whose rows are padded).
+/// `T_pixel` can be const qualified, providing a read-only view.
+///
+/// \attention As for `std::span`, the view does not extend the lifetime of the viewed raster.
+template <class T_pixel>
+class ImageView
+{
+    using byte_t = std::conditional_t<std::is_const_v<T_pixel>, const std::byte, std::byte>;
+
+    template <class> friend class ImageView;
+
+public:
+    using pixel_format_t = std::remove_const_t<T_pixel>;
+    static constexpr std::size_t pixel_size_v = sizeof(pixel_format_t);
+
+    // alias useful in generic programming situations
+    using value_type = pixel_format_t;
+
+    ImageView() = default;
+
+    ImageView(T_pixel * aData, math::Size<2, int> aDimensions, std::size_t aStrideBytes) :
+        mData{reinterpret_cast<byte_t *>(aData)},
+        mDimensions{aDimensions},
+        mStride{aStrideBytes}
+    {
+        assert(mStride >= size_bytes_line());
+    }
+
+    /// \brief View over a tightly packed raster.
+    ImageView(T_pixel * aData, math::Size<2, int> aDimensions) :
+        ImageView{aData, aDimensions, aDimensions.width() * pixel_size_v}
+    {}
+
+    /// \brief Implicit conversion from a mutable view to a read-only view.
+    template <class T_other>
+    requires (std::is_const_v<T_pixel> && std::is_same_v<const T_other, T_pixel>)
+    /*implicit*/ ImageView(const ImageView<T_other> & aMutable) :
+        mData{aMutable.mData},
+        mDimensions{aMutable.mDimensions},
+        mStride{aMutable.mStride}
+    {}
+
+    T_pixel * data() const
+    { return reinterpret_cast<T_pixel *>(mData); }
+
+    T_pixel * row(std::size_t aRow) const
+    { return reinterpret_cast<T_pixel *>(mData + aRow * mStride); }
+
+    T_pixel & at(std::size_t aColumn, std::size_t aRow) const
+    { return row(aRow)[aColumn]; }
+
+    template <class T_integer>
+    T_pixel & at(math::Position<2, T_integer> aPosition) const
+    { return at(aPosition.x(), aPosition.y()); }
+
+    explicit operator byte_t * () const
+    { return mData; }
+
+    int width() const
+    { return mDimensions.width(); }
+
+    int height() const
+    { return mDimensions.height(); }
+
+    math::Size<2, int> dimensions() const
+    { return mDimensions; }
+
+    bool empty() const
+    { return mDimensions.area() == 0; }
+
+    /// \brief Distance in bytes between the start of two consecutive rows.
+    std::size_t stride_bytes() const
+    { return mStride; }
+
+    /// \brief The number of bytes actually occupied by pixels on each row.
+    std::size_t size_bytes_line() const
+    { return mDimensions.width() * pixel_size_v; }
+
+    /// \brief True if there is no gap between consecutive rows,
+    /// i.e. the pixels can be iterated as a single array.
+    bool isContiguous() const
+    { return mStride == size_bytes_line(); }
+
+    /// \brief Return a view on the sub-rectangle `aZone` of this view, without copying any pixel.
+    ImageView crop(const math::Rectangle<int> & aZone) const
+    {
+        assert(aZone.x() >= 0 && aZone.y() >= 0
+               && aZone.x() + aZone.width() <= width()
+               && aZone.y() + aZone.height() <= height());
+        return ImageView{&at(aZone.x(), aZone.y()), aZone.dimension(), mStride};
+    }
+
+private:
+    byte_t * mData{nullptr};
+    math::Size<2, int> mDimensions{0, 0};
+    std::size_t mStride{0};
+};
+
+
+// Convenience definition as a free function, for the implicit "Sequence" type trait
+template <class T_pixel>
+math::Size<2, int> dimensions(const ImageView<T_pixel> & aView)
+{ return aView.dimensions(); }
+
+
+/// \brief Copy all the pixels from `aSource` into `aDestination`, row by row.
+/// \attention Both views must have the same dimensions.
+template <class T_pixel>
+void copyPixels(ImageView<const T_pixel> aSource, ImageView<T_pixel> aDestination)
+{
+    assert(aSource.dimensions() == aDestination.dimensions());
+
+    if (aSource.isContiguous() && aDestination.isContiguous())
+    {
+        std::copy(aSource.data(), aSource.data() + aSource.dimensions().area(), aDestination.data());
+    }
+    else
+    {
+        for (int row = 0; row != aSource.height(); ++row)
+        {
+            std::copy(aSource.row(row), aSource.row(row) + aSource.width(), aDestination.row(row));
+        }
+    }
+}
+
+
+} // namespace arte
+} // namespace ad
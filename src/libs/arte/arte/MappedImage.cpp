@@ -0,0 +1,113 @@
+#include "MappedImage.h"
+
+#include "detail/ImageFormats/Netpbm.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+
+namespace ad {
+namespace arte {
+
+
+namespace {
+
+
+    template <class T_pixelFormat>
+    using NetpbmOf = detail::Netpbm<detail::pixel_format_trait<T_pixelFormat>::value>;
+
+
+    template <class T_pixelFormat>
+    void copyRows(ImageView<const T_pixelFormat> aSource,
+                  ImageView<T_pixelFormat> aDestination,
+                  ImageOrientation aOrientation)
+    {
+        switch (aOrientation)
+        {
+        case ImageOrientation::Unchanged:
+            copyPixels(aSource, aDestination);
+            break;
+        case ImageOrientation::InvertVerticalAxis:
+            for (int row = 0; row != aSource.height(); ++row)
+            {
+                const T_pixelFormat * source = aSource.row(aSource.height() - 1 - row);
+                std::copy(source, source + aSource.width(), aDestination.row(row));
+            }
+            break;
+        default:
+            throw std::runtime_error("Unhandled orientation on mapped image copy.");
+        }
+    }
+
+
+} // anonymous namespace
+
+
+template <class T_pixelFormat>
+MappedImage<T_pixelFormat> MappedImage<T_pixelFormat>::Open(const filesystem::path & aImageFile)
+{
+    using Netpbm = NetpbmOf<T_pixelFormat>;
+
+    detail::MappedFile file = detail::MappedFile::Open(aImageFile);
+    auto header = Netpbm::ParseHeader({file.data(), file.size_bytes()});
+
+    const std::size_t expectedSize =
+        header.mRasterOffset + Netpbm::RasterSize(header.mDimensions);
+    if (file.size_bytes() != expectedSize)
+    {
+        throw std::runtime_error("Invalid " + detail::to_string(detail::pixel_format_trait<T_pixelFormat>::value)
+                                 + " content: "
+                                 + (file.size_bytes() < expectedSize ? "truncated content" : "trailing data"));
+    }
+
+    return {std::move(file), header.mDimensions, header.mRasterOffset};
+}
+
+
+template <class T_pixelFormat>
+MappedImage<T_pixelFormat> MappedImage<T_pixelFormat>::Create(const filesystem::path & aImageFile,
+                                                              math::Size<2, int> aDimensions)
+{
+    using Netpbm = NetpbmOf<T_pixelFormat>;
+
+    const std::string header = Netpbm::MakeHeader(aDimensions);
+
+    detail::MappedFile file = detail::MappedFile::Create(
+        aImageFile,
+        header.size() + Netpbm::RasterSize(aDimensions));
+    std::transform(header.begin(), header.end(), file.data(),
+                   [](char aCharacter){ return static_cast<std::byte>(aCharacter); });
+
+    return {std::move(file), aDimensions, header.size()};
+}
+
+
+template <class T_pixelFormat>
+Image<T_pixelFormat> MappedImage<T_pixelFormat>::toImage(ImageOrientation aOrientation) const
+{
+    auto result = Image<T_pixelFormat>::makeUninitialized(mDimensions);
+    copyRows(view(), result.view(), aOrientation);
+    return result;
+}
+
+
+template <class T_pixelFormat>
+void saveMapped(ImageView<const T_pixelFormat> aImage,
+                const filesystem::path & aDestination,
+                ImageOrientation aOrientation)
+{
+    auto destination = MappedImage<T_pixelFormat>::Create(aDestination, aImage.dimensions());
+    copyRows(aImage, destination.view(), aOrientation);
+}
+
+
+template class MappedImage<math::sdr::Rgb>;
+template class MappedImage<math::sdr::Grayscale>;
+
+template void saveMapped(ImageView<const math::sdr::Rgb>, const filesystem::path &, ImageOrientation);
+template void saveMapped(ImageView<const math::sdr::Grayscale>, const filesystem::path &, ImageOrientation);
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Image.h"
+#include "ImageView.h"
+
+#include "detail/MappedFile.h"
+
+#include <platform/Filesystem.h>
+
+#include <math/Color.h>
+
+#include <cassert>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief A Netpbm image file (PPM for Rgb, PGM for Grayscale) mapped in memory.
+///
+/// The raster is accessed directly in the mapping, without being copied through a stream.
+/// Pages are only read from disk when first accessed, which makes it suitable to process
+/// images larger than the available memory.
+///
+/// \note Netpbm rows are tightly packed, and stored from the top of the image.
+template <class T_pixelFormat>
+class MappedImage
+{
+public:
+    using pixel_format_t = T_pixelFormat;
+
+    MappedImage() = default;
+
+    /// \brief Map the existing image file `aImageFile` for reading.
+    static MappedImage Open(const filesystem::path & aImageFile);
+
+    /// \brief Create the image file `aImageFile` with dimensions `aDimensions`,
+    /// its pixels being written through view().
+    ///
+    /// The file is sized up front, and the header written immediately.
+    static MappedImage Create(const filesystem::path & aImageFile, math::Size<2, int> aDimensions);
+
+    math::Size<2, int> dimensions() const
+    { return mDimensions; }
+
+    int width() const
+    { return mDimensions.width(); }
+
+    int height() const
+    { return mDimensions.height(); }
+
+    /// \attention Only available on images obtained via Create().
+    ImageView<pixel_format_t> view()
+    {
+        assert(mFile.isWritable());
+        return {raster(), mDimensions};
+    }
+
+    ImageView<const pixel_format_t> view() const
+    { return {raster(), mDimensions}; }
+
+    /*implicit*/ operator ImageView<const pixel_format_t> () const
+    { return view(); }
+
+    /// \brief Copy the pixels into an Image, in a single pass even when the vertical axis is inverted.
+    Image<pixel_format_t> toImage(ImageOrientation aOrientation = ImageOrientation::Unchanged) const;
+
+    /// \brief Write the modified pixels back to the file, which otherwise happens at the OS' discretion.
+    void flush()
+    { mFile.flush(); }
+
+private:
+    MappedImage(detail::MappedFile aFile, math::Size<2, int> aDimensions, std::size_t aRasterOffset) :
+        mFile{std::move(aFile)},
+        mDimensions{aDimensions},
+        mRasterOffset{aRasterOffset}
+    {}
+
+    pixel_format_t * raster() const
+    { return reinterpret_cast<pixel_format_t *>(mFile.data() + mRasterOffset); }
+
+    detail::MappedFile mFile;
+    math::Size<2, int> mDimensions{0, 0};
+    std::size_t mRasterOffset{0};
+};
+
+
+/// \brief Write `aImage` to the Netpbm file `aDestination` through a memory mapping.
+template <class T_pixelFormat>
+void saveMapped(ImageView<const T_pixelFormat> aImage,
+                const filesystem::path & aDestination,
+                ImageOrientation aOrientation = ImageOrientation::Unchanged);
+
+
+using MappedImageRgb = MappedImage<math::sdr::Rgb>;
+using MappedImageGrayscale = MappedImage<math::sdr::Grayscale>;
+
+
+} // namespace arte
+} // namespace ad
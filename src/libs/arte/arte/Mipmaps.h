@@ -0,0 +1,296 @@
+#pragma once
+
+#include "Execution.h"
+#include "Image.h"
+#include "ImageConvolution.h"
+#include "ImageView.h"
+
+#include "detail/PixelKernels.h"
+#include "detail/Raster.h"
+
+#include <math/Rectangle.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief Number of levels in a complete mipmap chain, the last level being 1x1.
+inline int countCompleteMipmaps(math::Size<2, int> aResolution)
+{
+    // floor(log2(max dimension)) + 1
+    return static_cast<int>(
+        std::bit_width(static_cast<unsigned int>(std::max(aResolution.width(), aResolution.height()))));
+}
+
+
+/// \brief Resolution of mipmap `aLevel`, following the OpenGL rule of flooring each division.
+inline constexpr math::Size<2, int> getMipmapSize(math::Size<2, int> aFullResolution, unsigned int aLevel)
+{
+    return {
+        std::max(1, aFullResolution.width() >> aLevel),
+        std::max(1, aFullResolution.height() >> aLevel),
+    };
+}
+
+
+/// \brief The filter used to compute a mipmap level from the previous one.
+enum class MipmapFilter
+{
+    Box,        // Average of the covered area, as usually done by the GL drivers.
+    CatmullRom, // Sharper, with small overshoots.
+    Gaussian,   // Softer.
+};
+
+
+/// \brief How the color channels of the pixels are encoded. Alpha is always linear.
+enum class ColorEncoding
+{
+    Linear,
+    Srgb,
+};
+
+
+/// \brief All the levels of a mipmap chain, stored in a single allocation.
+///
+/// Each level is tightly packed, and starts at a multiple of gRasterAlignment.
+template <class T_pixelFormat>
+class MipChain
+{
+public:
+    using pixel_format_t = T_pixelFormat;
+
+    MipChain() = default;
+
+    /// \brief Allocate (uninitialized) storage for `aLevelCount` levels, by default a complete chain.
+    explicit MipChain(math::Size<2, int> aBaseResolution, int aLevelCount = 0);
+
+    int levelCount() const
+    { return static_cast<int>(mOffsets.size()) - 1; }
+
+    /// \brief Resolution of the level 0.
+    math::Size<2, int> dimensions() const
+    { return mDimensions; }
+
+    ImageView<T_pixelFormat> level(int aLevel)
+    { return {levelData(aLevel), getMipmapSize(mDimensions, aLevel)}; }
+
+    ImageView<const T_pixelFormat> level(int aLevel) const
+    { return {levelData(aLevel), getMipmapSize(mDimensions, aLevel)}; }
+
+    /// \brief The size of the single allocation holding all levels.
+    std::size_t size_bytes() const
+    { return mOffsets.empty() ? 0 : mOffsets.back(); }
+
+private:
+    T_pixelFormat * levelData(int aLevel) const
+    {
+        assert(aLevel >= 0 && aLevel < levelCount());
+        return reinterpret_cast<T_pixelFormat *>(mRaster.get() + mOffsets[aLevel]);
+    }
+
+    math::Size<2, int> mDimensions{0, 0};
+    // Byte offset of each level in the raster, followed by the total size.
+    std::vector<std::size_t> mOffsets;
+    detail::Raster mRaster;
+};
+
+
+/// \brief Compute all the levels of the mipmap chain for `aBase`, each from the previous one.
+///
+/// The levels are computed from linear values in floating point, then quantized.
+/// With ColorEncoding::Srgb, the color channels are decoded before filtering,
+/// and encoded back after, so the averaging is perceptually correct (i.e. details do not darken).
+template <template<class> class TT_colorFormat>
+requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
+MipChain<TT_colorFormat<math::sdr::Value_t>>
+buildMipChain(ImageView<const TT_colorFormat<math::sdr::Value_t>> aBase,
+              MipmapFilter aFilter = MipmapFilter::Box,
+              ColorEncoding aEncoding = ColorEncoding::Srgb,
+              const Execution & aExecution = {});
+
+template <template<class> class TT_colorFormat>
+requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
+MipChain<TT_colorFormat<math::sdr::Value_t>>
+buildMipChain(const Image<TT_colorFormat<math::sdr::Value_t>> & aBase,
+              MipmapFilter aFilter = MipmapFilter::Box,
+              ColorEncoding aEncoding = ColorEncoding::Srgb,
+              const Execution & aExecution = {})
+{ return buildMipChain(aBase.view(), aFilter, aEncoding, aExecution); }
+
+
+//
+// Implementations
+//
+template <class T_pixelFormat>
+MipChain<T_pixelFormat>::MipChain(math::Size<2, int> aBaseResolution, int aLevelCount) :
+    mDimensions{aBaseResolution}
+{
+    if (aLevelCount == 0)
+    {
+        aLevelCount = countCompleteMipmaps(aBaseResolution);
+    }
+
+    std::size_t offset = 0;
+    for (int level = 0; level != aLevelCount; ++level)
+    {
+        mOffsets.push_back(offset);
+        offset += detail::computeStride(getMipmapSize(mDimensions, level).area() * sizeof(T_pixelFormat),
+                                        gRasterAlignment);
+    }
+    mOffsets.push_back(offset);
+    mRaster = detail::allocateRaster(offset);
+}
+
+
+namespace detail {
+
+
+    /// \brief The filter, at the scale of the destination level,
+    /// and with its radius expressed in destination pixels.
+    inline Filter getUnitMipmapFilter(MipmapFilter aFilter)
+    {
+        switch (aFilter)
+        {
+            case MipmapFilter::Box:
+                // The boundary is included with half weight, so a covered area exactly ending
+                // on a source pixel center gives it the right contribution.
+                return Filter{
+                    .mFilterFunc = [](float x)
+                    {
+                        float xp = std::abs(x);
+                        return xp < 0.5f ? 1.f : (xp == 0.5f ? 0.5f : 0.f);
+                    },
+                    .mRadius = 0.5f,
+                };
+            case MipmapFilter::CatmullRom:
+                return Filter{.mFilterFunc = [](float x){ return catmullRom(x); }, .mRadius = 2.f};
+            case MipmapFilter::Gaussian:
+                return Filter{.mFilterFunc = [](float x){ return gaussian(x, 0.5f, 1.f); }, .mRadius = 1.5f};
+        }
+        throw std::invalid_argument{"Unhandled mipmap filter."};
+    }
+
+
+    /// \brief Weights to downsample an axis from `aInputSize` to `aOutputSize`,
+    /// stretching `aUnitFilter` by the downsampling ratio.
+    inline ResamplingAxis makeMipmapAxis(int aInputSize, int aOutputSize, const Filter & aUnitFilter)
+    {
+        const float ratio = (float)aInputSize / (float)aOutputSize;
+        Filter scaled{
+            .mFilterFunc = [ratio, unit = aUnitFilter.mFilterFunc](float x) { return unit(x / ratio); },
+            .mRadius = aUnitFilter.mRadius * ratio,
+        };
+        ResamplingAxis axis{aInputSize, aOutputSize, scaled};
+        axis.normalize();
+        return axis;
+    }
+
+
+    template <class T_sdrPixel, class T_linearPixel>
+    void decodeRow(const T_sdrPixel * aSource, T_linearPixel * aDestination, int aWidth, ColorEncoding aEncoding)
+    {
+        constexpr std::size_t channels = sizeof(T_sdrPixel);
+        const auto * source = reinterpret_cast<const std::uint8_t *>(aSource);
+        auto * destination = reinterpret_cast<float *>(aDestination);
+
+        kernels::unormToFloat(source, destination, aWidth * channels);
+        if (aEncoding == ColorEncoding::Srgb)
+        {
+            for (std::size_t i = 0; i != aWidth * channels; ++i)
+            {
+                // The alpha channel, if present, is the fourth.
+                if (channels != 4 || i % 4 != 3)
+                {
+                    destination[i] = kernels::decodeSRGB(source[i]);
+                }
+            }
+        }
+    }
+
+
+    template <class T_linearPixel, class T_sdrPixel>
+    void encodeRow(const T_linearPixel * aSource, T_sdrPixel * aDestination, int aWidth, ColorEncoding aEncoding)
+    {
+        constexpr std::size_t channels = sizeof(T_sdrPixel);
+        const auto * source = reinterpret_cast<const float *>(aSource);
+        auto * destination = reinterpret_cast<std::uint8_t *>(aDestination);
+
+        if (aEncoding == ColorEncoding::Srgb)
+        {
+            kernels::encodeSRGB(source, destination, aWidth * channels);
+            if constexpr (channels == 4)
+            {
+                for (std::size_t alpha = 3; alpha < aWidth * channels; alpha += 4)
+                {
+                    kernels::floatToUnorm(source + alpha, destination + alpha, 1);
+                }
+            }
+        }
+        else
+        {
+            kernels::floatToUnorm(source, destination, aWidth * channels);
+        }
+    }
+
+
+} // namespace detail
+
+
+template <template<class> class TT_colorFormat>
+requires math::is_color_v<TT_colorFormat<math::sdr::Value_t>>
+MipChain<TT_colorFormat<math::sdr::Value_t>>
+buildMipChain(ImageView<const TT_colorFormat<math::sdr::Value_t>> aBase,
+              MipmapFilter aFilter,
+              ColorEncoding aEncoding,
+              const Execution & aExecution)
+{
+    using SdrFormat = TT_colorFormat<math::sdr::Value_t>;
+    using LinearFormat = TT_colorFormat<float>;
+    static_assert(sizeof(LinearFormat) == sizeof(SdrFormat) * sizeof(float));
+
+    MipChain<SdrFormat> chain{aBase.dimensions()};
+    copyPixels(aBase, chain.level(0));
+
+    auto linear = Image<LinearFormat>::makeUninitialized(aBase.dimensions());
+    aExecution.forEachBand(aBase.height(), [&](int aFirstRow, int aEndRow)
+    {
+        for (int row = aFirstRow; row != aEndRow; ++row)
+        {
+            detail::decodeRow(aBase.row(row), linear.row(row), aBase.width(), aEncoding);
+        }
+    });
+
+    const Filter unitFilter = detail::getUnitMipmapFilter(aFilter);
+    for (int level = 1; level != chain.levelCount(); ++level)
+    {
+        ImageView<SdrFormat> destination = chain.level(level);
+        // Each level is filtered from the unquantized previous level.
+        linear = detail::resampleSeparable2D<LinearFormat>(
+            linear.view(),
+            detail::makeMipmapAxis(linear.width(), destination.width(), unitFilter),
+            detail::makeMipmapAxis(linear.height(), destination.height(), unitFilter),
+            aExecution);
+
+        aExecution.forEachBand(destination.height(), [&](int aFirstRow, int aEndRow)
+        {
+            for (int row = aFirstRow; row != aEndRow; ++row)
+            {
+                detail::encodeRow(linear.row(row), destination.row(row), destination.width(), aEncoding);
+            }
+        });
+    }
+
+    return chain;
+}
+
+
+} // namespace arte
+} // namespace ad
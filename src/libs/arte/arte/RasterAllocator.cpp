@@ -0,0 +1,188 @@
+#include "RasterAllocator.h"
+
+#include "detail/Raster.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+
+namespace ad {
+namespace arte {
+
+
+namespace {
+
+
+    thread_local RasterAllocator * gCurrentAllocator = nullptr;
+
+
+} // anonymous namespace
+
+
+//
+// HeapRasterAllocator
+//
+unsigned char * HeapRasterAllocator::allocate(std::size_t aSizeBytes)
+{
+    auto raster = static_cast<unsigned char *>(
+        ::operator new[](aSizeBytes, std::align_val_t{gRasterAlignment}));
+
+    ++mAllocations;
+    const std::size_t inUse = (mBytesInUse += aSizeBytes);
+    std::size_t highWater = mHighWaterBytes.load();
+    while (inUse > highWater && !mHighWaterBytes.compare_exchange_weak(highWater, inUse))
+    {}
+
+    return raster;
+}
+
+
+void HeapRasterAllocator::deallocate(unsigned char * aRaster, std::size_t aSizeBytes) noexcept
+{
+    mBytesInUse -= aSizeBytes;
+    ::operator delete[](aRaster, std::align_val_t{gRasterAlignment});
+}
+
+
+RasterAllocationStats HeapRasterAllocator::stats() const
+{
+    return {
+        .mAllocations = mAllocations,
+        .mHeapAllocations = mAllocations,
+        .mBytesInUse = mBytesInUse,
+        .mHighWaterBytes = mHighWaterBytes,
+    };
+}
+
+
+//
+// RasterPool
+//
+RasterPool::RasterPool(std::size_t aMaxCachedBytes, RasterAllocator & aUpstream) :
+    mMaxCachedBytes{aMaxCachedBytes},
+    mUpstream{aUpstream}
+{}
+
+
+RasterPool::~RasterPool()
+{
+    assert(mStats.mBytesInUse == 0 && "The pool must outlive the rasters it allocated.");
+    release();
+}
+
+
+unsigned char * RasterPool::allocate(std::size_t aSizeBytes)
+{
+    {
+        std::lock_guard lock{mMutex};
+        ++mStats.mAllocations;
+        mStats.mBytesInUse += aSizeBytes;
+        mStats.mHighWaterBytes = std::max(mStats.mHighWaterBytes, mStats.mBytesInUse);
+
+        if (auto found = mFreeRasters.find(aSizeBytes);
+            found != mFreeRasters.end() && !found->second.empty())
+        {
+            unsigned char * raster = found->second.back();
+            found->second.pop_back();
+            mStats.mCachedBytes -= aSizeBytes;
+            return raster;
+        }
+        ++mStats.mHeapAllocations;
+    }
+
+    // The upstream allocation happens outside of the lock.
+    try
+    {
+        return mUpstream.allocate(aSizeBytes);
+    }
+    catch (...)
+    {
+        std::lock_guard lock{mMutex};
+        mStats.mBytesInUse -= aSizeBytes;
+        throw;
+    }
+}
+
+
+void RasterPool::deallocate(unsigned char * aRaster, std::size_t aSizeBytes) noexcept
+{
+    {
+        std::lock_guard lock{mMutex};
+        mStats.mBytesInUse -= aSizeBytes;
+        if (mStats.mCachedBytes + aSizeBytes <= mMaxCachedBytes)
+        {
+            try
+            {
+                mFreeRasters[aSizeBytes].push_back(aRaster);
+                mStats.mCachedBytes += aSizeBytes;
+                return;
+            }
+            catch (const std::bad_alloc &)
+            {
+                // Could not grow the bin, the raster is returned upstream.
+            }
+        }
+    }
+    mUpstream.deallocate(aRaster, aSizeBytes);
+}
+
+
+RasterAllocationStats RasterPool::stats() const
+{
+    std::lock_guard lock{mMutex};
+    return mStats;
+}
+
+
+void RasterPool::release()
+{
+    decltype(mFreeRasters) freeRasters;
+    {
+        std::lock_guard lock{mMutex};
+        freeRasters.swap(mFreeRasters);
+        mStats.mCachedBytes = 0;
+    }
+
+    for (const auto & [sizeBytes, rasters] : freeRasters)
+    {
+        for (unsigned char * raster : rasters)
+        {
+            mUpstream.deallocate(raster, sizeBytes);
+        }
+    }
+}
+
+
+//
+// Current allocator
+//
+RasterAllocator & defaultRasterAllocator()
+{
+    // Never destroyed, so the rasters of static images can be released during static destruction.
+    static HeapRasterAllocator * gHeapAllocator = new HeapRasterAllocator;
+    return *gHeapAllocator;
+}
+
+
+RasterAllocator & currentRasterAllocator()
+{
+    return gCurrentAllocator != nullptr ? *gCurrentAllocator : defaultRasterAllocator();
+}
+
+
+ScopedRasterAllocator::ScopedRasterAllocator(RasterAllocator & aAllocator) :
+    mPrevious{gCurrentAllocator}
+{
+    gCurrentAllocator = &aAllocator;
+}
+
+
+ScopedRasterAllocator::~ScopedRasterAllocator()
+{
+    gCurrentAllocator = mPrevious;
+}
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,131 @@
+#pragma once
+
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief Counters reported by a RasterAllocator, to assess the allocation churn.
+struct RasterAllocationStats
+{
+    /// \brief Rasters requested from the allocator.
+    std::size_t mAllocations{0};
+    /// \brief Among the requested rasters, those that were allocated from the heap (i.e. not recycled).
+    std::size_t mHeapAllocations{0};
+    /// \brief Bytes of the rasters currently handed out.
+    std::size_t mBytesInUse{0};
+    /// \brief The maximum value reached by mBytesInUse.
+    std::size_t mHighWaterBytes{0};
+    /// \brief Bytes of the rasters kept for recycling.
+    std::size_t mCachedBytes{0};
+};
+
+
+/// \brief Provides the rasters of Image (and MipChain), aligned to gRasterAlignment.
+///
+/// Implementations must be thread safe.
+/// \attention An allocator must outlive all the rasters it allocated.
+class RasterAllocator
+{
+public:
+    virtual ~RasterAllocator() = default;
+
+    virtual unsigned char * allocate(std::size_t aSizeBytes) = 0;
+    /// \param aSizeBytes The size that was requested when allocating `aRaster`.
+    virtual void deallocate(unsigned char * aRaster, std::size_t aSizeBytes) noexcept = 0;
+
+    virtual RasterAllocationStats stats() const = 0;
+};
+
+
+/// \brief Allocates each raster from the heap, and frees it on deallocation.
+class HeapRasterAllocator : public RasterAllocator
+{
+public:
+    unsigned char * allocate(std::size_t aSizeBytes) override;
+    void deallocate(unsigned char * aRaster, std::size_t aSizeBytes) noexcept override;
+
+    RasterAllocationStats stats() const override;
+
+private:
+    std::atomic<std::size_t> mAllocations{0};
+    std::atomic<std::size_t> mBytesInUse{0};
+    std::atomic<std::size_t> mHighWaterBytes{0};
+};
+
+
+/// \brief The process-wide HeapRasterAllocator.
+RasterAllocator & defaultRasterAllocator();
+
+
+/// \brief Keeps the deallocated rasters, to return them when a raster of the same size is requested.
+///
+/// Intended for batch processing, where the same few image sizes are requested repeatedly:
+/// once the first job completed, the following jobs are mostly served without heap allocations.
+/// The cached rasters are returned to the upstream allocator on destruction (so a pool scoped to a job
+/// behaves as an arena), or when calling release().
+class RasterPool : public RasterAllocator
+{
+public:
+    /// \param aMaxCachedBytes Deallocated rasters which would make the cache exceed this size
+    /// are returned to `aUpstream` instead.
+    explicit RasterPool(std::size_t aMaxCachedBytes = std::numeric_limits<std::size_t>::max(),
+                        RasterAllocator & aUpstream = defaultRasterAllocator());
+
+    ~RasterPool() override;
+
+    RasterPool(const RasterPool &) = delete;
+    RasterPool & operator=(const RasterPool &) = delete;
+
+    unsigned char * allocate(std::size_t aSizeBytes) override;
+    void deallocate(unsigned char * aRaster, std::size_t aSizeBytes) noexcept override;
+
+    RasterAllocationStats stats() const override;
+
+    /// \brief Return all the cached rasters to the upstream allocator.
+    void release();
+
+private:
+    const std::size_t mMaxCachedBytes;
+    RasterAllocator & mUpstream;
+    mutable std::mutex mMutex;
+    // The free rasters, by size in bytes.
+    std::unordered_map<std::size_t, std::vector<unsigned char *>> mFreeRasters;
+    RasterAllocationStats mStats;
+};
+
+
+/// \brief The allocator used by the calling thread for new rasters,
+/// i.e. by Image::makeUninitialized() and all the functions returning a new Image.
+///
+/// It is the defaultRasterAllocator(), unless replaced by a ScopedRasterAllocator.
+RasterAllocator & currentRasterAllocator();
+
+
+/// \brief Make `aAllocator` the current allocator of the calling thread for the lifetime of the instance.
+///
+/// \note The tasks executed by other threads (e.g. the ImageLoader workers) are not affected.
+class ScopedRasterAllocator
+{
+public:
+    explicit ScopedRasterAllocator(RasterAllocator & aAllocator);
+    ~ScopedRasterAllocator();
+
+    ScopedRasterAllocator(const ScopedRasterAllocator &) = delete;
+    ScopedRasterAllocator & operator=(const ScopedRasterAllocator &) = delete;
+
+private:
+    RasterAllocator * mPrevious;
+};
+
+
+} // namespace arte
+} // namespace ad
@@ -1,51 +1,385 @@
 #include "SpriteSheet.h"
 
 #include "detail/Json.h"
+#include "detail/MappedFile.h"
+#include "detail/PixelKernels.h"
+#include "detail/SpriteSheetCache.h"
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <math/Range.h>
+#include <optional>
 #include <sstream>
+#include <string_view>
 
 namespace ad {
 namespace arte {
 
-AnimationSpriteSheet AnimationSpriteSheet::LoadAseFile(const filesystem::path & aJsonData)
+
+SpriteArea getVisibleBounds(ImageView<const math::sdr::Rgba> aImage)
 {
-    std::ifstream jsonInput{aJsonData.string()};
-    Json data;
-    jsonInput >> data;
+    namespace kernels = detail::kernels;
+
+    const auto width = static_cast<std::size_t>(aImage.width());
+    auto rowBytes = [&](int aRow)
+    {
+        return reinterpret_cast<const std::uint8_t *>(aImage.row(aRow));
+    };
+
+    int bottom = 0;
+    while (bottom != aImage.height() && kernels::findFirstVisible(rowBytes(bottom), width) == width)
+    {
+        ++bottom;
+    }
+    if (bottom == aImage.height())
+    {
+        return SpriteArea{{0, 0}, {0, 0}};
+    }
+
+    int top = aImage.height();
+    while (kernels::findVisibleEnd(rowBytes(top - 1), width) == 0)
+    {
+        --top;
+    }
+
+    // Each row only has to be scanned outside of the horizontal extent found so far.
+    std::size_t left = width;
+    std::size_t right = 0;
+    for (int row = bottom; row != top; ++row)
+    {
+        const std::uint8_t * bytes = rowBytes(row);
+        left = std::min(left, kernels::findFirstVisible(bytes, left));
+        right += kernels::findVisibleEnd(bytes + 4 * right, width - right);
+    }
+
+    return SpriteArea{
+        {static_cast<int>(left), bottom},
+        {static_cast<int>(right - left), top - bottom},
+    };
+}
+
+
+namespace {
+
+
+    std::size_t alignUp(std::size_t aOffset, std::size_t aAlignment)
+    {
+        return (aOffset + aAlignment - 1) / aAlignment * aAlignment;
+    }
+
+
+    /// \brief Test if the sections described by `aHeader` are ordered, and exactly cover a file of `aFileSize`.
+    ///
+    /// Each offset and size is compared to the file size before being summed, so a corrupted header
+    /// cannot overflow the computations.
+    bool isConsistent(const detail::sheetcache::Header & aHeader, std::size_t aFileSize)
+    {
+        namespace cache = detail::sheetcache;
+
+        auto fits = [aFileSize](std::uint64_t aOffset, std::uint64_t aSize)
+        {
+            return aOffset <= aFileSize && aSize <= aFileSize - aOffset;
+        };
+
+        const std::uint64_t framesSize = std::uint64_t{aHeader.mFrameCount} * sizeof(cache::Frame);
+        if (aHeader.mWidth < 0 || aHeader.mHeight < 0
+            || aHeader.mFramesOffset < sizeof(cache::Header)
+            || !fits(aHeader.mFramesOffset, framesSize)
+            || aHeader.mFramesOffset + framesSize > aHeader.mStringsOffset
+            || !fits(aHeader.mStringsOffset, aHeader.mStringsSize)
+            || aHeader.mStringsOffset + aHeader.mStringsSize > aHeader.mRasterOffset
+            || !fits(aHeader.mRasterOffset, 0))
+        {
+            return false;
+        }
+
+        // Both dimensions are below 2^31, the pixel count cannot overflow.
+        const std::uint64_t pixelCount = std::uint64_t(aHeader.mWidth) * std::uint64_t(aHeader.mHeight);
+        const std::uint64_t rasterSize = aFileSize - aHeader.mRasterOffset;
+        return rasterSize % sizeof(math::sdr::Rgba) == 0 && pixelCount == rasterSize / sizeof(math::sdr::Rgba);
+    }
 
-    const filesystem::path imagePath{data.at("meta").at("image").get<std::string>()};
-    AnimationSpriteSheet spriteSheet{aJsonData.stem().string(),
-                                     aJsonData.parent_path() / imagePath};
-    spriteSheet.mScale = std::stof(data.at("meta").at("scale").get<std::string>());
-
-    // Frames
-    for (auto frameJson : data.at("frames")) {
-        SpriteArea area{
-            {frameJson.at("frame").at("x").get<int>(),
-             frameJson.at("frame").at("y").get<int>()},
-            {frameJson.at("frame").at("w").get<int>(),
-             frameJson.at("frame").at("h").get<int>()},
+
+    /// \brief Test if `aArea` lies within an image of `aWidth` x `aHeight`.
+    bool isWithin(const SpriteArea & aArea, std::int32_t aWidth, std::int32_t aHeight)
+    {
+        return aArea.x() >= 0 && aArea.y() >= 0 && aArea.width() >= 0 && aArea.height() >= 0
+            && std::int64_t{aArea.x()} + aArea.width() <= aWidth
+            && std::int64_t{aArea.y()} + aArea.height() <= aHeight;
+    }
+
+
+} // anonymous namespace
+
+
+template <class T_frame>
+bool SpriteSheet_base<T_frame>::readCache(const filesystem::path & aCacheFile, const filesystem::path & aDataFile)
+{
+    namespace cache = detail::sheetcache;
+
+    if (!filesystem::exists(aCacheFile) || filesystem::file_size(aCacheFile) < sizeof(cache::Header))
+    {
+        return false;
+    }
+
+    detail::MappedFile file = detail::MappedFile::Open(aCacheFile);
+    cache::Header header;
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    // A corrupted or truncated cache is not an error: it is rebuilt from the sources.
+    if (header.mMagic != cache::gMagic
+        || header.mVersion != cache::gVersion
+        || !isConsistent(header, file.size_bytes()))
+    {
+        return false;
+    }
+
+    const char * strings = reinterpret_cast<const char *>(file.data() + header.mStringsOffset);
+    auto getString = [&](cache::StringRef aString) -> std::optional<std::string_view>
+    {
+        if (std::uint64_t{aString.mOffset} + aString.mSize > header.mStringsSize)
+        {
+            return std::nullopt;
+        }
+        return std::string_view{strings + aString.mOffset, aString.mSize};
+    };
+
+    const std::optional<std::string_view> imagePath = getString(header.mImagePath);
+    if (!imagePath)
+    {
+        return false;
+    }
+    const filesystem::path imageFile = aDataFile.parent_path() / *imagePath;
+    if (!filesystem::exists(imageFile)
+        || !(header.mDataStamp == cache::getSourceStamp(aDataFile))
+        || !(header.mImageStamp == cache::getSourceStamp(imageFile)))
+    {
+        return false;
+    }
+
+    std::vector<Frame> frames;
+    frames.reserve(header.mFrameCount);
+    for (std::uint32_t frameId = 0; frameId != header.mFrameCount; ++frameId)
+    {
+        cache::Frame cached;
+        std::memcpy(&cached,
+                    file.data() + header.mFramesOffset + frameId * sizeof(cache::Frame),
+                    sizeof(cached));
+
+        const std::optional<std::string_view> name = getString(cached.mName);
+        const SpriteArea area{{cached.mArea[0], cached.mArea[1]}, {cached.mArea[2], cached.mArea[3]}};
+        if (!name || !isWithin(area, header.mWidth, header.mHeight))
+        {
+            return false;
+        }
+        const FrameTrim trim{
+            .offset = {cached.mTrimOffset[0], cached.mTrimOffset[1]},
+            .sourceSize = {cached.mSourceSize[0], cached.mSourceSize[1]},
         };
-        spriteSheet.mFrames.push_back(
-            {{frameJson.at("filename").get<std::string>(), area},
-             frameJson.at("duration").get<Duration_t>()});
+        if constexpr (requires(const Frame & aFrame) { aFrame.duration; })
+        {
+            frames.push_back({{std::string{*name}, area, trim}, cached.mDuration});
+        }
+        else
+        {
+            frames.push_back({std::string{*name}, area, trim});
+        }
+    }
 
-        spriteSheet.mTotalDuration += spriteSheet.mFrames.back().duration;
+    // The rows are copied once from the mapping, since the image rows might be aligned.
+    auto image = ImageRgba::makeUninitialized({header.mWidth, header.mHeight});
+    const std::size_t rowSize = header.mWidth * sizeof(math::sdr::Rgba);
+    for (int row = 0; row != header.mHeight; ++row)
+    {
+        std::memcpy(image.row(row), file.data() + header.mRasterOffset + row * rowSize, rowSize);
     }
 
-    return spriteSheet;
+    mScale = header.mScale;
+    mFrames = std::move(frames);
+    setImage(std::move(image));
+    return true;
 }
 
-TileSheet TileSheet::LoadMetaFile(const filesystem::path & aJsonData)
+
+template <class T_frame>
+void SpriteSheet_base<T_frame>::writeCache(const filesystem::path & aCacheFile,
+                                           const filesystem::path & aDataFile,
+                                           const filesystem::path & aImageFile) const
+{
+    namespace cache = detail::sheetcache;
+
+    std::string strings;
+    auto addString = [&](std::string_view aString)
+    {
+        cache::StringRef result{static_cast<std::uint32_t>(strings.size()),
+                                static_cast<std::uint32_t>(aString.size())};
+        strings += aString;
+        return result;
+    };
+
+    cache::Header header{
+        .mMagic = cache::gMagic,
+        .mVersion = cache::gVersion,
+        .mFrameCount = static_cast<std::uint32_t>(mFrames.size()),
+        .mDataStamp = cache::getSourceStamp(aDataFile),
+        .mImageStamp = cache::getSourceStamp(aImageFile),
+        .mScale = mScale,
+        .mWidth = image().width(),
+        .mHeight = image().height(),
+        .mImagePath = addString(aImageFile.lexically_relative(aDataFile.parent_path()).generic_string()),
+    };
+
+    std::vector<cache::Frame> frames;
+    frames.reserve(mFrames.size());
+    for (const Frame & frame : mFrames)
+    {
+        cache::Frame & cached = frames.emplace_back(cache::Frame{
+            .mName = addString(frame.name),
+            .mArea = {frame.area.x(), frame.area.y(), frame.area.width(), frame.area.height()},
+            .mTrimOffset = {frame.trim.offset.x(), frame.trim.offset.y()},
+            .mSourceSize = {frame.trim.sourceSize.width(), frame.trim.sourceSize.height()},
+            .mDuration = 0.f,
+        });
+        if constexpr (requires(const Frame & aFrame) { aFrame.duration; })
+        {
+            cached.mDuration = static_cast<float>(frame.duration);
+        }
+    }
+
+    header.mFramesOffset = alignUp(sizeof(cache::Header), alignof(cache::Frame));
+    header.mStringsOffset = header.mFramesOffset + frames.size() * sizeof(cache::Frame);
+    header.mStringsSize = strings.size();
+    header.mRasterOffset = alignUp(header.mStringsOffset + header.mStringsSize, 16);
+    const std::size_t rowSize = header.mWidth * sizeof(math::sdr::Rgba);
+
+    if (aCacheFile.has_parent_path())
+    {
+        filesystem::create_directories(aCacheFile.parent_path());
+    }
+
+    // Written aside then renamed, so an interrupted write never leaves a truncated cache.
+    filesystem::path temporary = aCacheFile;
+    temporary += ".tmp";
+    {
+        detail::MappedFile file =
+            detail::MappedFile::Create(temporary, header.mRasterOffset + rowSize * header.mHeight);
+        std::memcpy(file.data(), &header, sizeof(header));
+        std::memcpy(file.data() + header.mFramesOffset, frames.data(), frames.size() * sizeof(cache::Frame));
+        std::memcpy(file.data() + header.mStringsOffset, strings.data(), strings.size());
+        for (int row = 0; row != header.mHeight; ++row)
+        {
+            std::memcpy(file.data() + header.mRasterOffset + row * rowSize, image().row(row), rowSize);
+        }
+        file.flush();
+    }
+    filesystem::rename(temporary, aCacheFile);
+}
+
+
+std::pair<AnimationSpriteSheet, filesystem::path>
+AnimationSpriteSheet::ParseAseFile(const filesystem::path & aJsonData)
+{
+    AnimationSpriteSheet spriteSheet{aJsonData.stem().string()};
+
+    // Each frame is read as soon as it is parsed, the "frames" array is never materialized.
+    std::ifstream jsonInput{aJsonData.string()};
+    Json data = detail::parseConsumingElements(
+        jsonInput,
+        [&spriteSheet](std::string_view aCollection, const Json & aFrameJson) -> bool
+        {
+            if (aCollection != "frames")
+            {
+                return false;
+            }
+
+            const Json & frame = aFrameJson.at("frame");
+            SpriteArea area{
+                {frame.at("x").get<int>(), frame.at("y").get<int>()},
+                {frame.at("w").get<int>(), frame.at("h").get<int>()},
+            };
+            // Frames exported trimmed by Aseprite record their placement in the untrimmed frame.
+            FrameTrim trim{.sourceSize = area.dimension()};
+            if (aFrameJson.value("trimmed", false))
+            {
+                const Json & placement = aFrameJson.at("spriteSourceSize");
+                const Json & sourceSize = aFrameJson.at("sourceSize");
+                trim.sourceSize = {sourceSize.at("w").get<int>(), sourceSize.at("h").get<int>()};
+                // The sheet image is loaded with its vertical axis inverted, the offset is from the bottom.
+                trim.offset = {placement.at("x").get<int>(),
+                               trim.sourceSize.height() - placement.at("y").get<int>() - placement.at("h").get<int>()};
+            }
+
+            spriteSheet.mFrames.push_back(
+                {{aFrameJson.at("filename").get<std::string>(), area, trim},
+                 aFrameJson.at("duration").get<Duration_t>()});
+
+            spriteSheet.mTotalDuration += spriteSheet.mFrames.back().duration;
+            return true;
+        });
+
+    const Json & meta = data.at("meta");
+    const filesystem::path imagePath{meta.at("image").get<std::string>()};
+    spriteSheet.mScale = std::stof(meta.at("scale").get<std::string>());
+
+    return {std::move(spriteSheet), aJsonData.parent_path() / imagePath};
+}
+
+
+AnimationSpriteSheet AnimationSpriteSheet::LoadAseFile(const filesystem::path & aJsonData)
+{
+    auto [spriteSheet, imagePath] = ParseAseFile(aJsonData);
+    spriteSheet.setImage(ImageRgba::LoadFile(imagePath, gSheetOrientation));
+    spriteSheet.trimFrames();
+    return std::move(spriteSheet);
+}
+
+
+std::future<AnimationSpriteSheet> AnimationSpriteSheet::LoadAseFile(const filesystem::path & aJsonData,
+                                                                    ImageLoader & aLoader)
+{
+    auto [spriteSheet, imagePath] = ParseAseFile(aJsonData);
+    // Deferred, so no worker is blocked while the image is decoding.
+    return std::async(std::launch::deferred,
+                      [spriteSheet = std::move(spriteSheet),
+                       image = aLoader.load<math::sdr::Rgba>(imagePath, gSheetOrientation)]() mutable
+                      {
+                          spriteSheet.setImage(image.get().take());
+                          spriteSheet.trimFrames();
+                          return std::move(spriteSheet);
+                      });
+}
+
+
+AnimationSpriteSheet AnimationSpriteSheet::LoadAseFileCached(const filesystem::path & aJsonData,
+                                                             const filesystem::path & aCacheFile)
+{
+    AnimationSpriteSheet cached{aJsonData.stem().string()};
+    if (cached.readCache(aCacheFile, aJsonData))
+    {
+        for (const Frame & frame : cached.mFrames)
+        {
+            cached.mTotalDuration += frame.duration;
+        }
+        return cached;
+    }
+
+    auto [spriteSheet, imagePath] = ParseAseFile(aJsonData);
+    spriteSheet.setImage(ImageRgba::LoadFile(imagePath, gSheetOrientation));
+    spriteSheet.trimFrames();
+    spriteSheet.writeCache(aCacheFile, aJsonData, imagePath);
+    return std::move(spriteSheet);
+}
+
+
+std::pair<TileSheet, filesystem::path> TileSheet::ParseMetaFile(const filesystem::path & aJsonData)
 {
     std::ifstream jsonInput{aJsonData.string()};
     Json data;
     jsonInput >> data;
 
     const filesystem::path imagePath{data.at("file").get<std::string>()};
-    TileSheet spriteSheet{aJsonData.stem().string(), aJsonData.parent_path() / imagePath};
+    TileSheet spriteSheet{aJsonData.stem().string()};
     spriteSheet.mScale = data.at("scale").get<float>();
 
     const std::string prefix = data["set"]["prefix"];
@@ -66,8 +400,45 @@ TileSheet TileSheet::LoadMetaFile(const filesystem::path & aJsonData)
                  {startPosition + tileOffset.cwMul({column, row}), dimension}});
         }
     }
-    return spriteSheet;
+    return {std::move(spriteSheet), aJsonData.parent_path() / imagePath};
 }
 
+
+TileSheet TileSheet::LoadMetaFile(const filesystem::path & aJsonData)
+{
+    auto [spriteSheet, imagePath] = ParseMetaFile(aJsonData);
+    spriteSheet.setImage(ImageRgba::LoadFile(imagePath, gSheetOrientation));
+    return std::move(spriteSheet);
+}
+
+
+std::future<TileSheet> TileSheet::LoadMetaFile(const filesystem::path & aJsonData, ImageLoader & aLoader)
+{
+    auto [spriteSheet, imagePath] = ParseMetaFile(aJsonData);
+    // Deferred, so no worker is blocked while the image is decoding.
+    return std::async(std::launch::deferred,
+                      [spriteSheet = std::move(spriteSheet),
+                       image = aLoader.load<math::sdr::Rgba>(imagePath, gSheetOrientation)]() mutable
+                      {
+                          spriteSheet.setImage(image.get().take());
+                          return std::move(spriteSheet);
+                      });
+}
+
+TileSheet TileSheet::LoadMetaFileCached(const filesystem::path & aJsonData, const filesystem::path & aCacheFile)
+{
+    TileSheet cached{aJsonData.stem().string()};
+    if (cached.readCache(aCacheFile, aJsonData))
+    {
+        return cached;
+    }
+
+    auto [spriteSheet, imagePath] = ParseMetaFile(aJsonData);
+    spriteSheet.setImage(ImageRgba::LoadFile(imagePath, gSheetOrientation));
+    spriteSheet.writeCache(aCacheFile, aJsonData, imagePath);
+    return std::move(spriteSheet);
+}
+
+
 } // namespace arte
 } // namespace ad
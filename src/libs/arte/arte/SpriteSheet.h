@@ -2,12 +2,16 @@
 
 
 #include "Image.h"
+#include "ImageLoader.h"
 
 #include <platform/Filesystem.h>
 
 #include <math/Rectangle.h>
 
+#include <future>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 
@@ -18,6 +22,16 @@ namespace arte {
 using SpriteArea = math::Rectangle<int>;
 
 
+/// \brief Placement of a frame area within the untrimmed frame, once its transparent borders are trimmed.
+struct FrameTrim
+{
+    /// \brief Offset of the trimmed area from the bottom left corner of the untrimmed frame.
+    math::Vec<2, int> offset{0, 0};
+    /// \brief Dimensions of the untrimmed frame.
+    math::Size<2, int> sourceSize{0, 0};
+};
+
+
 template <class T_area>
 struct Frame_base
 {
@@ -27,9 +41,17 @@ struct Frame_base
 
     std::string name;
     T_area area;
+    // Defaults to the untrimmed frame.
+    FrameTrim trim{.sourceSize = area.dimension()};
 };
 
 
+/// \brief Return the smallest rectangle of `aImage` containing all its visible pixels (i.e. with a non-zero alpha).
+///
+/// The image is scanned with the vectorized kernels, a fully transparent image giving an empty rectangle.
+SpriteArea getVisibleBounds(ImageView<const math::sdr::Rgba> aImage);
+
+
 template <class T_area, class T_duration>
 struct AnimationFrame : public Frame_base<T_area>
 {
@@ -54,7 +76,13 @@ public:
     std::size_t frameCount() const
     { return mFrames.size(); }
 
-    const ImageRgba image() const
+    const ImageRgba & image() const
+    { return *mSheet; }
+
+    /// \brief The sheet image is immutable, and shared by the copies of this sprite sheet.
+    ///
+    /// Copying a sprite sheet (or holding its image after the sheet is destroyed) does not copy the pixels.
+    const std::shared_ptr<const ImageRgba> & sharedImage() const
     { return mSheet; }
 
     const_iterator cbegin() const
@@ -63,12 +91,39 @@ public:
     const_iterator cend() const
     { return mFrames.end(); }
 
+    /// \brief Shrink the area of each frame to its visible pixels, accumulating the offset in the frame `trim`.
+    ///
+    /// This saves texture memory and fill-rate, without visual change for renderers applying the trim
+    /// (e.g. graphics::Spriting).
+    void trimFrames();
+
 protected:
     SpriteSheet_base(std::string aName, const filesystem::path & aSheetImage);
 
+    /// \brief Construct without the sheet image, which is assigned once decoded.
+    explicit SpriteSheet_base(std::string aName);
+
+    /// \brief The orientation the sheet images are loaded with.
+    static constexpr ImageOrientation gSheetOrientation = ImageOrientation::InvertVerticalAxis;
+
+    /// \brief Load the scale, frames and image from the binary cache `aCacheFile`, without any parsing
+    /// or decoding.
+    /// \return false (leaving the sheet unchanged) if the cache is missing, invalid, or outdated
+    /// relative to the data file `aDataFile` or to the image it was built from.
+    bool readCache(const filesystem::path & aCacheFile, const filesystem::path & aDataFile);
+
+    /// \brief Write the scale, frames and image to the binary cache `aCacheFile`, stamped with the
+    /// state of the source files `aDataFile` and `aImageFile`.
+    void writeCache(const filesystem::path & aCacheFile,
+                    const filesystem::path & aDataFile,
+                    const filesystem::path & aImageFile) const;
+
+    void setImage(ImageRgba aSheet)
+    { mSheet = std::make_shared<const ImageRgba>(std::move(aSheet)); }
+
     std::string mName;
     float mScale{1};
-    ImageRgba mSheet;
+    std::shared_ptr<const ImageRgba> mSheet;
     std::vector<Frame> mFrames;
 };
 
@@ -82,6 +137,17 @@ class TileSheet : public BASE
 
 public:
     static TileSheet LoadMetaFile(const filesystem::path & aJsonData);
+
+    /// \brief Parse the metadata immediately, while the sheet image is decoded by `aLoader`.
+    static std::future<TileSheet> LoadMetaFile(const filesystem::path & aJsonData, ImageLoader & aLoader);
+
+    /// \brief Load from the binary cache `aCacheFile` if it is up to date with the sources,
+    /// otherwise load from the sources and (re)write the cache.
+    static TileSheet LoadMetaFileCached(const filesystem::path & aJsonData, const filesystem::path & aCacheFile);
+
+private:
+    /// \brief Return the sheet without its image, and the path to the image.
+    static std::pair<TileSheet, filesystem::path> ParseMetaFile(const filesystem::path & aJsonData);
 };
 
 
@@ -96,12 +162,27 @@ class AnimationSpriteSheet : public BASE
 public:
     using Duration_t = decltype(Frame::duration);
 
+    /// \note The loaded frames are trimmed (see `trimFrames()`).
     static AnimationSpriteSheet LoadAseFile(const filesystem::path & aJsonData);
 
+    /// \brief Parse the metadata immediately, while the sheet image is decoded by `aLoader`.
+    static std::future<AnimationSpriteSheet> LoadAseFile(const filesystem::path & aJsonData,
+                                                         ImageLoader & aLoader);
+
+    /// \brief Load from the binary cache `aCacheFile` if it is up to date with the sources,
+    /// otherwise load from the sources and (re)write the cache.
+    ///
+    /// The cached frames are already trimmed, the Ase file and its image are not read at all.
+    static AnimationSpriteSheet LoadAseFileCached(const filesystem::path & aJsonData,
+                                                  const filesystem::path & aCacheFile);
+
     Duration_t totalDuration() const
     { return mTotalDuration; }
 
 private:
+    /// \brief Return the sheet without its image, and the path to the image.
+    static std::pair<AnimationSpriteSheet, filesystem::path> ParseAseFile(const filesystem::path & aJsonData);
+
     Duration_t mTotalDuration{0};
 };
 #undef BASE
@@ -113,9 +194,29 @@ private:
 template <class T_frame>
 SpriteSheet_base<T_frame>::SpriteSheet_base(std::string aName, const filesystem::path & aSheetImage) :
     mName{std::move(aName)},
-    mSheet{ImageRgba::LoadFile(aSheetImage, ImageOrientation::InvertVerticalAxis)}
+    mSheet{std::make_shared<const ImageRgba>(ImageRgba::LoadFile(aSheetImage, gSheetOrientation))}
+{}
+
+
+template <class T_frame>
+SpriteSheet_base<T_frame>::SpriteSheet_base(std::string aName) :
+    mName{std::move(aName)},
+    mSheet{std::make_shared<const ImageRgba>()}
 {}
 
 
+template <class T_frame>
+void SpriteSheet_base<T_frame>::trimFrames()
+{
+    for (Frame & frame : mFrames)
+    {
+        const SpriteArea visible = getVisibleBounds(image().view(frame.area));
+        const math::Vec<2, int> offset = visible.origin().template as<math::Vec>();
+        frame.area = SpriteArea{frame.area.origin() + offset, visible.dimension()};
+        frame.trim.offset += offset;
+    }
+}
+
+
 } // namespace arte
 } // namespace ad
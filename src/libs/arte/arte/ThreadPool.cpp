@@ -0,0 +1,63 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+
+namespace ad {
+namespace arte {
+
+
+ThreadPool::ThreadPool(std::size_t aThreadCount)
+{
+    mWorkers.reserve(aThreadCount);
+    for (std::size_t i = 0; i != aThreadCount; ++i)
+    {
+        mWorkers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock{mMutex};
+        mStopping = true;
+    }
+    mCondition.notify_all();
+    for (std::thread & worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+
+std::size_t ThreadPool::defaultThreadCount()
+{
+    // hardware_concurrency() is allowed to return 0 when it cannot be determined.
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+void ThreadPool::work()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{mMutex};
+            mCondition.wait(lock, [this](){ return mStopping || !mTasks.empty(); });
+            if (mTasks.empty())
+            {
+                // Only reached when stopping, after all the queued tasks were taken.
+                return;
+            }
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+        task();
+    }
+}
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,75 @@
+#pragma once
+
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief A fixed set of worker threads, executing the tasks pushed to a shared queue in order.
+///
+/// The destructor completes all the tasks already queued before joining the workers.
+class ThreadPool
+{
+public:
+    /// \brief Start `aThreadCount` workers, defaulting to the number of hardware threads.
+    explicit ThreadPool(std::size_t aThreadCount = defaultThreadCount());
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    /// \brief Queue `aTask` for execution by a worker.
+    /// \return A future to the result of the task (which also transports exceptions).
+    template <class F_task>
+    std::future<std::invoke_result_t<std::decay_t<F_task>>> push(F_task && aTask);
+
+    std::size_t size() const
+    { return mWorkers.size(); }
+
+    static std::size_t defaultThreadCount();
+
+private:
+    void work();
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<std::function<void()>> mTasks;
+    bool mStopping{false};
+    std::vector<std::thread> mWorkers;
+};
+
+
+//
+// Implementations
+//
+template <class F_task>
+std::future<std::invoke_result_t<std::decay_t<F_task>>> ThreadPool::push(F_task && aTask)
+{
+    using Result_t = std::invoke_result_t<std::decay_t<F_task>>;
+
+    // std::function requires a copyable callable, which a packaged_task is not.
+    auto task = std::make_shared<std::packaged_task<Result_t()>>(std::forward<F_task>(aTask));
+    std::future<Result_t> result = task->get_future();
+    {
+        std::lock_guard lock{mMutex};
+        mTasks.emplace_back([task](){ (*task)(); });
+    }
+    mCondition.notify_one();
+    return result;
+}
+
+
+} // namespace arte
+} // namespace ad
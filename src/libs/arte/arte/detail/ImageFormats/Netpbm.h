@@ -4,6 +4,11 @@
 
 #include <math/Color.h>
 
+#include <charconv>
+#include <cctype>
+#include <span>
+#include <string>
+
 
 static constexpr std::size_t gChunkSize = 256/*kB*/ * 1024/*B*/;
 
@@ -34,7 +39,7 @@ namespace detail {
         }
     };
 
-    std::string to_string(NetpbmFormat aFormat)
+    inline std::string to_string(NetpbmFormat aFormat)
     {
         switch(aFormat)
         {
@@ -63,12 +68,37 @@ namespace detail {
     { using pixel_type = Rgb; };
 
 
+    /// \brief The Netpbm format storing pixels of type `T_pixel`, if any.
+    template <class T_pixel>
+    struct pixel_format_trait
+    {};
+
+    template <>
+    struct pixel_format_trait<Grayscale>
+    { static constexpr NetpbmFormat value = NetpbmFormat::Pgm; };
+
+    template <>
+    struct pixel_format_trait<Rgb>
+    { static constexpr NetpbmFormat value = NetpbmFormat::Ppm; };
+
+    template <class T_pixel>
+    constexpr bool has_netpbm_format_v = requires { pixel_format_trait<T_pixel>::value; };
+
+
     template <NetpbmFormat N_format>
     struct Netpbm
     {
         static constexpr const char * magic = magicNumber(N_format);
         using pixel_type = typename format_trait<N_format>::pixel_type;
 
+        /// \brief Size in bytes of the raster, computed in std::size_t so large images do not overflow.
+        static std::size_t RasterSize(math::Size<2, int> aDimensions)
+        {
+            return static_cast<std::size_t>(aDimensions.width())
+                   * static_cast<std::size_t>(aDimensions.height())
+                   * sizeof(pixel_type);
+        }
+
         //
         // Read
         //
@@ -86,7 +116,7 @@ namespace detail {
 
             if (width <= 0 || height <= 0)
             {
-                throw std::runtime_error("Invalid PPM dimensions");
+                throw std::runtime_error("Invalid " + to_string(N_format) + " dimensions");
             }
             if (maxValue != 255)
             {
@@ -100,11 +130,63 @@ namespace detail {
             return {width, height};
         }
 
+        struct Header
+        {
+            math::Size<2, int> mDimensions;
+            /// \brief Offset of the first raster byte from the start of the content.
+            std::size_t mRasterOffset;
+        };
+
+        /// \brief Parse the header at the beginning of `aContent`, which is typically a mapped file.
+        static Header ParseHeader(std::span<const std::byte> aContent)
+        {
+            const char * const begin = reinterpret_cast<const char *>(aContent.data());
+            const char * const end = begin + aContent.size();
+
+            if (aContent.size() < 2 || begin[0] != magic[0] || begin[1] != magic[1])
+            {
+                throw std::runtime_error("Invalid header for " + to_string(N_format) + " content");
+            }
+
+            const char * current = begin + 2;
+            auto readValue = [&current, end]()
+            {
+                while (current != end && std::isspace(static_cast<unsigned char>(*current)))
+                {
+                    ++current;
+                }
+                int value{-1};
+                current = std::from_chars(current, end, value).ptr;
+                return value;
+            };
+
+            int width = readValue();
+            int height = readValue();
+            int maxValue = readValue();
+
+            if (width <= 0 || height <= 0)
+            {
+                throw std::runtime_error("Invalid " + to_string(N_format) + " dimensions");
+            }
+            if (maxValue != 255)
+            {
+                throw std::runtime_error("Unhandled " + to_string(N_format) + " maximum value of "
+                                         + std::to_string(maxValue));
+            }
+            if (current == end)
+            {
+                throw std::runtime_error("Invalid " + to_string(N_format) + " content: truncated content");
+            }
+
+            // skip the one byte appearing after max value and before raster data
+            return {{width, height}, static_cast<std::size_t>(current + 1 - begin)};
+        }
+
         static Image<pixel_type> Read(std::istream & aIn, ImageOrientation aOrientation)
         {
             auto dimensions = ReadHeader(aIn);
 
-            std::size_t remainingBytes = dimensions.area() * sizeof(pixel_type);
+            std::size_t remainingBytes = RasterSize(dimensions);
             auto data = std::make_unique<unsigned char[]>(remainingBytes);
             unsigned char * currentDestination = data.get();
 
@@ -178,8 +260,15 @@ namespace detail {
         //
         // Write
         //
+        static std::string MakeHeader(math::Size<2, int> aDimensions)
+        {
+            return std::string{magic} + '\n'
+                + std::to_string(aDimensions.width()) + ' ' + std::to_string(aDimensions.height()) + '\n'
+                + "255\n";
+        }
+
         static void Write(std::ostream & aOut,
-                          const Image<pixel_type> & aImage,
+                          ImageView<const pixel_type> aImage,
                           ImageOrientation aOrientation)
         {
             if(!aOut.good())
@@ -187,10 +276,7 @@ namespace detail {
                 throw std::runtime_error("Output stream is not valid for writing");
             }
 
-            aOut << magic << '\n'
-                << aImage.width() << ' ' << aImage.height() << '\n'
-                << "255\n"
-                ;
+            aOut << MakeHeader(aImage.dimensions());
 
             switch (aOrientation)
             {
@@ -205,9 +291,19 @@ namespace detail {
             }
         }
 
-        static void WriteVerticalDefault(std::ostream & aOut, const Image<pixel_type> & aImage)
+        static void WriteVerticalDefault(std::ostream & aOut, ImageView<const pixel_type> aImage)
         {
-            std::size_t remainingBytes = aImage.size_bytes();
+            if (!aImage.isContiguous())
+            {
+                // Rows are not consecutive in memory, they have to be written one by one.
+                for (int currentLine = 0; currentLine != aImage.height(); ++currentLine)
+                {
+                    WriteLine(aOut, aImage, currentLine);
+                }
+                return;
+            }
+
+            std::size_t remainingBytes = aImage.size_bytes_line() * aImage.height();
             const char * currentSource = reinterpret_cast<const char *>(aImage.data());
 
             while (remainingBytes)
@@ -223,25 +319,29 @@ namespace detail {
             }
         }
 
-        static void WriteVerticalInverted(std::ostream & aOut, const Image<pixel_type> & aImage)
+        static void WriteVerticalInverted(std::ostream & aOut, ImageView<const pixel_type> aImage)
         {
             for (int currentLine = aImage.height() - 1; currentLine >= 0; --currentLine)
             {
-                std::size_t remainingLineBytes = aImage.size_bytes_line();
-                const char * currentSource = 
-                    reinterpret_cast<const char *>(aImage.data() + currentLine * aImage.width());
+                WriteLine(aOut, aImage, currentLine);
+            }
+        }
 
-                while (remainingLineBytes)
+        static void WriteLine(std::ostream & aOut, ImageView<const pixel_type> aImage, int aLine)
+        {
+            std::size_t remainingLineBytes = aImage.size_bytes_line();
+            const char * currentSource = reinterpret_cast<const char *>(aImage.row(aLine));
+
+            while (remainingLineBytes)
+            {
+                std::size_t writeSize = std::min(remainingLineBytes, gChunkSize);
+                if (!aOut.write(currentSource, writeSize).good())
                 {
-                    std::size_t writeSize = std::min(remainingLineBytes, gChunkSize);
-                    if (!aOut.write(currentSource, writeSize).good())
-                    {
-                        throw std::runtime_error("Error writing "+ to_string(N_format)
-                                                 + " pixel data to stream");
-                    }
-                    remainingLineBytes -= writeSize;
-                    currentSource += writeSize;
+                    throw std::runtime_error("Error writing "+ to_string(N_format)
+                                             + " pixel data to stream");
                 }
+                remainingLineBytes -= writeSize;
+                currentSource += writeSize;
             }
         }
     };
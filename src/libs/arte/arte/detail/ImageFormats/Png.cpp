@@ -0,0 +1,351 @@
+#include "Png.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+namespace {
+
+
+    constexpr std::array<unsigned char, 8> gSignature{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    constexpr std::size_t gWindowSize = 32 * 1024;
+
+
+    enum Filter : unsigned char
+    {
+        None = 0,
+        Sub = 1,
+        Up = 2,
+        Average = 3,
+        Paeth = 4,
+    };
+
+
+    int colorType(int aChannels)
+    {
+        switch (aChannels)
+        {
+        case 1:
+            return 0;
+        case 3:
+            return 2;
+        case 4:
+            return 6;
+        default:
+            throw std::domain_error{"Unsupported channel count for PNG: " + std::to_string(aChannels)};
+        }
+    }
+
+
+    void appendBigEndian(std::vector<unsigned char> & aBuffer, std::uint32_t aValue)
+    {
+        aBuffer.push_back((unsigned char)(aValue >> 24));
+        aBuffer.push_back((unsigned char)(aValue >> 16));
+        aBuffer.push_back((unsigned char)(aValue >> 8));
+        aBuffer.push_back((unsigned char)aValue);
+    }
+
+
+    void writeChunk(std::ostream & aOut, const char (&aType)[5], const unsigned char * aData, std::size_t aSize)
+    {
+        std::vector<unsigned char> header;
+        appendBigEndian(header, (std::uint32_t)aSize);
+        header.insert(header.end(), aType, aType + 4);
+
+        uLong crc = crc32(0, header.data() + 4, 4);
+        // crc32() takes a uInt length, which might be narrower than the chunk.
+        for (std::size_t offset = 0; offset != aSize;)
+        {
+            const uInt length = (uInt)std::min<std::size_t>(aSize - offset, 1u << 30);
+            crc = crc32(crc, aData + offset, length);
+            offset += length;
+        }
+
+        std::vector<unsigned char> footer;
+        appendBigEndian(footer, (std::uint32_t)crc);
+
+        aOut.write(reinterpret_cast<const char *>(header.data()), header.size());
+        aOut.write(reinterpret_cast<const char *>(aData), aSize);
+        aOut.write(reinterpret_cast<const char *>(footer.data()), footer.size());
+        if (!aOut.good())
+        {
+            throw std::runtime_error("Error writing PNG data to stream");
+        }
+    }
+
+
+    unsigned char paethPredictor(int a, int b, int c)
+    {
+        const int p = a + b - c;
+        const int pa = std::abs(p - a);
+        const int pb = std::abs(p - b);
+        const int pc = std::abs(p - c);
+        if (pa <= pb && pa <= pc)
+        {
+            return (unsigned char)a;
+        }
+        return (unsigned char)(pb <= pc ? b : c);
+    }
+
+
+    /// \brief Write the filter type then the filtered bytes of `aRow` to `aDestination`.
+    /// \param aPrevious The previous row in the encoded order, nullptr for the first row.
+    void filterRow(Filter aFilter,
+                   const unsigned char * aRow,
+                   const unsigned char * aPrevious,
+                   std::size_t aRowBytes,
+                   int aChannels,
+                   unsigned char * aDestination)
+    {
+        *aDestination++ = aFilter;
+        for (std::size_t i = 0; i != aRowBytes; ++i)
+        {
+            const int left = i >= (std::size_t)aChannels ? aRow[i - aChannels] : 0;
+            const int up = aPrevious ? aPrevious[i] : 0;
+            const int upLeft = (aPrevious && i >= (std::size_t)aChannels) ? aPrevious[i - aChannels] : 0;
+
+            unsigned char predicted = 0;
+            switch (aFilter)
+            {
+            case None:
+                break;
+            case Sub:
+                predicted = (unsigned char)left;
+                break;
+            case Up:
+                predicted = (unsigned char)up;
+                break;
+            case Average:
+                predicted = (unsigned char)((left + up) / 2);
+                break;
+            case Paeth:
+                predicted = paethPredictor(left, up, upLeft);
+                break;
+            }
+            aDestination[i] = (unsigned char)(aRow[i] - predicted);
+        }
+    }
+
+
+    /// \brief Filter `aRow` with the filter minimizing the sum of absolute (signed) filtered values,
+    /// the heuristic recommended by the PNG specification.
+    void filterRowAdaptive(const unsigned char * aRow,
+                           const unsigned char * aPrevious,
+                           std::size_t aRowBytes,
+                           int aChannels,
+                           unsigned char * aDestination,
+                           std::vector<unsigned char> & aScratch)
+    {
+        aScratch.resize(aRowBytes + 1);
+
+        auto cost = [aRowBytes](const unsigned char * aFiltered)
+        {
+            std::size_t sum = 0;
+            for (std::size_t i = 1; i != aRowBytes + 1; ++i)
+            {
+                sum += std::abs((int)(signed char)aFiltered[i]);
+            }
+            return sum;
+        };
+
+        filterRow(None, aRow, aPrevious, aRowBytes, aChannels, aDestination);
+        std::size_t bestCost = cost(aDestination);
+        for (Filter filter : {Sub, Up, Average, Paeth})
+        {
+            filterRow(filter, aRow, aPrevious, aRowBytes, aChannels, aScratch.data());
+            if (std::size_t candidate = cost(aScratch.data()); candidate < bestCost)
+            {
+                bestCost = candidate;
+                std::copy(aScratch.begin(), aScratch.end(), aDestination);
+            }
+        }
+    }
+
+
+    struct DeflatedChunk
+    {
+        std::vector<unsigned char> mData;
+        uLong mAdler;
+        std::size_t mInputSize;
+    };
+
+
+    /// \brief Deflate `aInput` as a raw deflate block sequence, using `aDictionary` as the preceding data.
+    /// \param aLast If false, the output ends on a byte boundary without a final block,
+    /// so the following chunk can be appended to it.
+    DeflatedChunk deflateChunk(const unsigned char * aInput, std::size_t aSize,
+                               const unsigned char * aDictionary, std::size_t aDictionarySize,
+                               int aLevel, bool aLast)
+    {
+        z_stream stream{};
+        // Negative window bits: raw deflate, the zlib wrapper is written once around all chunks.
+        if (deflateInit2(&stream, aLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            throw std::runtime_error{"Cannot initialize the PNG compressor."};
+        }
+
+        DeflatedChunk result{.mAdler = adler32(1, aInput, (uInt)aSize), .mInputSize = aSize};
+        if (aDictionarySize != 0)
+        {
+            deflateSetDictionary(&stream, aDictionary, (uInt)aDictionarySize);
+        }
+
+        result.mData.resize(deflateBound(&stream, (uLong)aSize) + 16);
+        stream.next_in = const_cast<Bytef *>(aInput);
+        stream.avail_in = (uInt)aSize;
+        stream.next_out = result.mData.data();
+        stream.avail_out = (uInt)result.mData.size();
+
+        const int status = deflate(&stream, aLast ? Z_FINISH : Z_SYNC_FLUSH);
+        result.mData.resize(result.mData.size() - stream.avail_out);
+        deflateEnd(&stream);
+
+        if (status != (aLast ? Z_STREAM_END : Z_OK) || stream.avail_in != 0)
+        {
+            throw std::runtime_error{"Error compressing PNG data."};
+        }
+        return result;
+    }
+
+
+    unsigned char zlibLevelFlag(int aLevel)
+    {
+        // FLEVEL bits, such that the header is a multiple of 31 (see RFC 1950).
+        if (aLevel <= 1)
+        {
+            return 0x01;
+        }
+        else if (aLevel <= 5)
+        {
+            return 0x5E;
+        }
+        else if (aLevel == 6)
+        {
+            return 0x9C;
+        }
+        return 0xDA;
+    }
+
+
+} // anonymous namespace
+
+
+void Png::WriteRaster(std::ostream & aOut,
+                      math::Size<2, int> aDimensions,
+                      int aChannels,
+                      const unsigned char * aFirstRow,
+                      std::ptrdiff_t aStride,
+                      const EncodingOptions & aOptions)
+{
+    if (!aOut.good())
+    {
+        throw std::runtime_error("Output stream is not valid for writing");
+    }
+    if (aDimensions.width() <= 0 || aDimensions.height() <= 0)
+    {
+        throw std::runtime_error("Cannot write an empty image as PNG");
+    }
+    const int level = std::clamp(aOptions.mCompressionLevel, 0, 9);
+
+    const std::size_t rowBytes = (std::size_t)aDimensions.width() * aChannels;
+    const std::size_t filteredRowBytes = rowBytes + 1;
+    auto sourceRow = [&](int aRow)
+    {
+        return aFirstRow + aRow * aStride;
+    };
+
+    //
+    // Filtering, each row only depends on the source rows.
+    //
+    std::vector<unsigned char> filtered(filteredRowBytes * aDimensions.height());
+    aOptions.mExecution.forEachBand(aDimensions.height(), [&](int aFirstBandRow, int aEndRow)
+    {
+        std::vector<unsigned char> scratch;
+        for (int row = aFirstBandRow; row != aEndRow; ++row)
+        {
+            unsigned char * destination = filtered.data() + row * filteredRowBytes;
+            const unsigned char * previous = row > 0 ? sourceRow(row - 1) : nullptr;
+            if (level == 0)
+            {
+                // Storing without compression, filtering would not make the output smaller.
+                filterRow(None, sourceRow(row), previous, rowBytes, aChannels, destination);
+            }
+            else
+            {
+                filterRowAdaptive(sourceRow(row), previous, rowBytes, aChannels, destination, scratch);
+            }
+        }
+    });
+
+    //
+    // Deflating, each chunk only depends on the filtered data.
+    //
+    const std::size_t chunkBytes = std::max(gChunkBytes, filteredRowBytes);
+    const int chunkCount = (int)((filtered.size() + chunkBytes - 1) / chunkBytes);
+    std::vector<DeflatedChunk> chunks(chunkCount);
+
+    // Each chunk is a separate "row", so chunks are distributed by the execution.
+    aOptions.mExecution.forEachBand(chunkCount, [&](int aFirstChunk, int aEndChunk)
+    {
+        for (int chunk = aFirstChunk; chunk != aEndChunk; ++chunk)
+        {
+            const std::size_t begin = chunk * chunkBytes;
+            const std::size_t end = std::min(filtered.size(), begin + chunkBytes);
+            const std::size_t dictionarySize = std::min(begin, gWindowSize);
+            chunks[chunk] = deflateChunk(filtered.data() + begin, end - begin,
+                                         filtered.data() + begin - dictionarySize, dictionarySize,
+                                         level, chunk == chunkCount - 1);
+        }
+    });
+
+    //
+    // Output
+    //
+    aOut.write(reinterpret_cast<const char *>(gSignature.data()), gSignature.size());
+
+    std::vector<unsigned char> header;
+    appendBigEndian(header, aDimensions.width());
+    appendBigEndian(header, aDimensions.height());
+    header.insert(header.end(), {
+        8, // bit depth
+        (unsigned char)colorType(aChannels),
+        0, // deflate compression
+        0, // adaptive filtering
+        0, // no interlace
+    });
+    writeChunk(aOut, "IHDR", header.data(), header.size());
+
+    // The zlib stream is spread over IDAT chunks, one per deflated chunk.
+    const std::array<unsigned char, 2> zlibHeader{0x78, zlibLevelFlag(level)};
+    writeChunk(aOut, "IDAT", zlibHeader.data(), zlibHeader.size());
+
+    uLong adler = adler32(0, nullptr, 0);
+    for (const DeflatedChunk & chunk : chunks)
+    {
+        writeChunk(aOut, "IDAT", chunk.mData.data(), chunk.mData.size());
+        adler = adler32_combine(adler, chunk.mAdler, (z_off_t)chunk.mInputSize);
+    }
+
+    std::vector<unsigned char> zlibFooter;
+    appendBigEndian(zlibFooter, (std::uint32_t)adler);
+    writeChunk(aOut, "IDAT", zlibFooter.data(), zlibFooter.size());
+
+    writeChunk(aOut, "IEND", nullptr, 0);
+}
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../../Image.h"
+
+#include <math/Color.h>
+
+#include <cstddef>
+#include <ostream>
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+/// \brief PNG encoder compressing chunks of rows concurrently, with zlib.
+///
+/// The rows are first filtered (each row independently choosing its filter),
+/// then the filtered data is split in chunks deflated in parallel, as done by pigz:
+/// each chunk is primed with the 32 kB of data preceding it, and all but the last end on a byte boundary,
+/// so their concatenation is a single valid deflate stream.
+struct Png
+{
+    /// \brief Rows are accumulated in chunks of at least this many filtered bytes before deflating.
+    static constexpr std::size_t gChunkBytes = 256/*kB*/ * 1024/*B*/;
+
+    template <class T_pixel>
+    static void Write(std::ostream & aOut,
+                      ImageView<const T_pixel> aImage,
+                      ImageOrientation aOrientation,
+                      const EncodingOptions & aOptions)
+    {
+        const bool inverted = (aOrientation == ImageOrientation::InvertVerticalAxis);
+        const auto * firstRow = reinterpret_cast<const unsigned char *>(
+            aImage.row(inverted ? aImage.height() - 1 : 0));
+        const std::ptrdiff_t stride = inverted ? -(std::ptrdiff_t)aImage.stride_bytes() : aImage.stride_bytes();
+
+        WriteRaster(aOut, aImage.dimensions(), sizeof(T_pixel), firstRow, stride, aOptions);
+    }
+
+    /// \param aChannels The number of 8-bit channels per pixel, 1 (gray), 3 (RGB) or 4 (RGBA).
+    /// \param aStride Offset in bytes from a row to the next row to encode, which can be negative.
+    static void WriteRaster(std::ostream & aOut,
+                            math::Size<2, int> aDimensions,
+                            int aChannels,
+                            const unsigned char * aFirstRow,
+                            std::ptrdiff_t aStride,
+                            const EncodingOptions & aOptions);
+};
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,362 @@
+#pragma once
+
+#include "../../Image.h"
+
+#include <math/Color.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+/// \brief Codec for the "Quite OK Image" format, a fast lossless format supporting an alpha channel.
+///
+/// see: https://qoiformat.org/qoi-specification.pdf
+/// The pixels are encoded as a single pass of simple operations (runs, index in a table of recently seen
+/// pixels, small differences to the previous pixel), so both directions are much faster than PNG.
+struct Qoi
+{
+    static constexpr std::array<char, 4> magic{'q', 'o', 'i', 'f'};
+    static constexpr std::size_t gHeaderSize = 14;
+    static constexpr std::array<unsigned char, 8> gEndMarker{0, 0, 0, 0, 0, 0, 0, 1};
+    /// \brief Reference decoders refuse larger images, to protect against malformed headers.
+    static constexpr std::size_t gMaxPixels = 400'000'000;
+    static constexpr std::size_t gFlushSize = 256/*kB*/ * 1024/*B*/;
+
+    static constexpr unsigned char gOpIndex = 0x00;
+    static constexpr unsigned char gOpDiff  = 0x40;
+    static constexpr unsigned char gOpLuma  = 0x80;
+    static constexpr unsigned char gOpRun   = 0xC0;
+    static constexpr unsigned char gOpRgb   = 0xFE;
+    static constexpr unsigned char gOpRgba  = 0xFF;
+    static constexpr unsigned char gMask2   = 0xC0;
+
+    struct Header
+    {
+        math::Size<2, int> mDimensions;
+        int mChannels;
+    };
+
+    /// \brief The pixels are accessed as consecutive 8-bit channels, in RGB(A) order.
+    template <class T_pixel>
+    static constexpr int channels_v = sizeof(T_pixel);
+
+    // The decoding state is a RGBA pixel, whatever the number of channels.
+    struct Pixel
+    {
+        bool operator==(const Pixel &) const = default;
+
+        unsigned char r{0}, g{0}, b{0}, a{255};
+    };
+
+    static int hash(Pixel aPixel)
+    { return (aPixel.r * 3 + aPixel.g * 5 + aPixel.b * 7 + aPixel.a * 11) % 64; }
+
+
+    //
+    // Read
+    //
+    static Header ParseHeader(const unsigned char * aBytes)
+    {
+        if (!std::equal(magic.begin(), magic.end(), aBytes))
+        {
+            throw std::runtime_error("Invalid header for QOI content");
+        }
+
+        auto readBigEndian = [](const unsigned char * aValue) -> std::uint32_t
+        {
+            return (std::uint32_t{aValue[0]} << 24) | (std::uint32_t{aValue[1]} << 16)
+                 | (std::uint32_t{aValue[2]} << 8) | std::uint32_t{aValue[3]};
+        };
+        const std::uint32_t width = readBigEndian(aBytes + 4);
+        const std::uint32_t height = readBigEndian(aBytes + 8);
+        const int channels = aBytes[12];
+
+        if (width == 0 || height == 0 || height > gMaxPixels / width)
+        {
+            throw std::runtime_error("Invalid QOI dimensions");
+        }
+        if (channels != 3 && channels != 4)
+        {
+            throw std::runtime_error("Invalid QOI channel count: " + std::to_string(channels));
+        }
+        return {{(int)width, (int)height}, channels};
+    }
+
+    static Header ReadHeader(std::istream & aIn)
+    {
+        std::array<unsigned char, gHeaderSize> header;
+        if (!aIn.read(reinterpret_cast<char *>(header.data()), header.size()))
+        {
+            throw std::runtime_error("Invalid QOI content: truncated header");
+        }
+        return ParseHeader(header.data());
+    }
+
+    static std::vector<unsigned char> ReadContent(std::istream & aIn)
+    {
+        std::vector<unsigned char> content;
+        const std::streampos start = aIn.tellg();
+        if (start != std::streampos{-1} && aIn.seekg(0, std::ios_base::end))
+        {
+            content.resize(static_cast<std::size_t>(aIn.tellg() - start));
+            aIn.seekg(start);
+            if (!aIn.read(reinterpret_cast<char *>(content.data()), content.size()))
+            {
+                throw std::runtime_error("Invalid QOI content: read error");
+            }
+        }
+        else
+        {
+            // Not seekable, the content size is unknown.
+            aIn.clear();
+            content.assign(std::istreambuf_iterator<char>{aIn}, std::istreambuf_iterator<char>{});
+        }
+        return content;
+    }
+
+    template <class T_pixel>
+    static Image<T_pixel> Read(std::istream & aIn, ImageOrientation aOrientation)
+    {
+        // The operations have variable lengths, the complete content is read before decoding.
+        const std::vector<unsigned char> content = ReadContent(aIn);
+        if (content.size() < gHeaderSize + gEndMarker.size())
+        {
+            throw std::runtime_error("Invalid QOI content: truncated content");
+        }
+        return Decode<T_pixel>(content.data(), content.size(), aOrientation);
+    }
+
+    template <class T_pixel>
+    static Image<T_pixel> Decode(const unsigned char * aContent, std::size_t aSize, ImageOrientation aOrientation)
+    {
+        constexpr int N_channels = channels_v<T_pixel>;
+
+        const Header header = ParseHeader(aContent);
+        const math::Size<2, int> dimensions = header.mDimensions;
+        auto image = Image<T_pixel>::makeUninitialized(dimensions);
+
+        const unsigned char * current = aContent + gHeaderSize;
+        // No operation is longer than the end marker, so it is enough to test the operation start.
+        const unsigned char * const end = aContent + aSize - gEndMarker.size();
+
+        // The specification starts all the index channels at 0, unlike the previous pixel which is opaque.
+        std::array<Pixel, 64> index;
+        index.fill(Pixel{0, 0, 0, 0});
+        Pixel pixel;
+        int run = 0;
+
+        for (int line = 0; line != dimensions.height(); ++line)
+        {
+            const int row = (aOrientation == ImageOrientation::InvertVerticalAxis) ?
+                dimensions.height() - 1 - line : line;
+            unsigned char * destination = reinterpret_cast<unsigned char *>(image.row(row));
+            unsigned char * const rowEnd = destination + dimensions.width() * N_channels;
+
+            for (; destination != rowEnd; destination += N_channels)
+            {
+                if (run > 0)
+                {
+                    --run;
+                }
+                else
+                {
+                    if (current >= end)
+                    {
+                        throw std::runtime_error("Invalid QOI content: truncated content");
+                    }
+
+                    const unsigned char op = *current++;
+                    if (op == gOpRgb)
+                    {
+                        pixel.r = current[0];
+                        pixel.g = current[1];
+                        pixel.b = current[2];
+                        current += 3;
+                    }
+                    else if (op == gOpRgba)
+                    {
+                        pixel.r = current[0];
+                        pixel.g = current[1];
+                        pixel.b = current[2];
+                        pixel.a = current[3];
+                        current += 4;
+                    }
+                    else
+                    {
+                        switch (op & gMask2)
+                        {
+                        case gOpIndex:
+                            pixel = index[op];
+                            break;
+                        case gOpDiff:
+                            pixel.r += ((op >> 4) & 0x03) - 2;
+                            pixel.g += ((op >> 2) & 0x03) - 2;
+                            pixel.b += (op & 0x03) - 2;
+                            break;
+                        case gOpLuma:
+                        {
+                            const unsigned char second = *current++;
+                            const int greenDiff = (op & 0x3F) - 32;
+                            pixel.r += greenDiff - 8 + ((second >> 4) & 0x0F);
+                            pixel.g += greenDiff;
+                            pixel.b += greenDiff - 8 + (second & 0x0F);
+                            break;
+                        }
+                        case gOpRun:
+                            run = (op & 0x3F);
+                            break;
+                        }
+                    }
+                    index[hash(pixel)] = pixel;
+                }
+
+                std::memcpy(destination, &pixel, N_channels);
+            }
+        }
+
+        return image;
+    }
+
+
+    //
+    // Write
+    //
+    template <class T_pixel>
+    static void Write(std::ostream & aOut, ImageView<const T_pixel> aImage, ImageOrientation aOrientation)
+    {
+        constexpr int N_channels = channels_v<T_pixel>;
+
+        if(!aOut.good())
+        {
+            throw std::runtime_error("Output stream is not valid for writing");
+        }
+
+        // Each pixel is encoded in at most N_channels + 1 bytes, the buffer is flushed line by line.
+        const std::size_t maxLineBytes = aImage.width() * (N_channels + 1);
+        std::vector<unsigned char> buffer;
+        buffer.reserve(std::max(gFlushSize, maxLineBytes) + maxLineBytes);
+
+        auto writeBigEndian = [&buffer](std::uint32_t aValue)
+        {
+            buffer.push_back((unsigned char)(aValue >> 24));
+            buffer.push_back((unsigned char)(aValue >> 16));
+            buffer.push_back((unsigned char)(aValue >> 8));
+            buffer.push_back((unsigned char)aValue);
+        };
+        auto flush = [&aOut, &buffer]()
+        {
+            if (!aOut.write(reinterpret_cast<const char *>(buffer.data()), buffer.size()).good())
+            {
+                throw std::runtime_error("Error writing QOI data to stream");
+            }
+            buffer.clear();
+        };
+
+        buffer.insert(buffer.end(), magic.begin(), magic.end());
+        writeBigEndian(aImage.width());
+        writeBigEndian(aImage.height());
+        buffer.push_back(N_channels);
+        buffer.push_back(0); // sRGB with linear alpha
+
+        // Must start as the decoders index, with all channels at 0 (see Decode()).
+        std::array<Pixel, 64> index;
+        index.fill(Pixel{0, 0, 0, 0});
+        Pixel previous;
+        int run = 0;
+
+        for (int line = 0; line != aImage.height(); ++line)
+        {
+            const int row = (aOrientation == ImageOrientation::InvertVerticalAxis) ?
+                aImage.height() - 1 - line : line;
+            const unsigned char * source = reinterpret_cast<const unsigned char *>(aImage.row(row));
+            const unsigned char * const rowEnd = source + aImage.width() * N_channels;
+
+            for (; source != rowEnd; source += N_channels)
+            {
+                Pixel pixel;
+                std::memcpy(&pixel, source, N_channels);
+
+                if (pixel == previous)
+                {
+                    if (++run == 62)
+                    {
+                        buffer.push_back(gOpRun | (run - 1));
+                        run = 0;
+                    }
+                    continue;
+                }
+
+                if (run > 0)
+                {
+                    buffer.push_back(gOpRun | (run - 1));
+                    run = 0;
+                }
+
+                const int hashed = hash(pixel);
+                if (index[hashed] == pixel)
+                {
+                    buffer.push_back(gOpIndex | hashed);
+                }
+                else
+                {
+                    index[hashed] = pixel;
+
+                    if (pixel.a == previous.a)
+                    {
+                        const signed char dr = pixel.r - previous.r;
+                        const signed char dg = pixel.g - previous.g;
+                        const signed char db = pixel.b - previous.b;
+                        const signed char drdg = dr - dg;
+                        const signed char dbdg = db - dg;
+
+                        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                        {
+                            buffer.push_back(gOpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                        }
+                        else if (dg >= -32 && dg <= 31 && drdg >= -8 && drdg <= 7 && dbdg >= -8 && dbdg <= 7)
+                        {
+                            buffer.push_back(gOpLuma | (dg + 32));
+                            buffer.push_back((drdg + 8) << 4 | (dbdg + 8));
+                        }
+                        else
+                        {
+                            buffer.insert(buffer.end(), {gOpRgb, pixel.r, pixel.g, pixel.b});
+                        }
+                    }
+                    else
+                    {
+                        buffer.insert(buffer.end(), {gOpRgba, pixel.r, pixel.g, pixel.b, pixel.a});
+                    }
+                }
+                previous = pixel;
+            }
+
+            if (buffer.size() >= gFlushSize)
+            {
+                flush();
+            }
+        }
+
+        if (run > 0)
+        {
+            buffer.push_back(gOpRun | (run - 1));
+        }
+        buffer.insert(buffer.end(), gEndMarker.begin(), gEndMarker.end());
+        flush();
+    }
+};
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
@@ -91,7 +91,8 @@ struct StbImageFormats
     template <class T_pixel>
     static Image<T_pixel> Read(std::istream & aIn, ImageOrientation aOrientation)
     {
-        stbi_set_flip_vertically_on_load(aOrientation == ImageOrientation::InvertVerticalAxis);
+        // The thread local setting, so concurrent decodes (e.g. from ImageLoader) do not interfere.
+        stbi_set_flip_vertically_on_load_thread(aOrientation == ImageOrientation::InvertVerticalAxis);
 
         math::Size<2, int> dimension = math::Size<2, int>::Zero();
         int channelsInFile;
@@ -120,6 +121,19 @@ struct StbImageFormats
     };
     
 
+    /// \brief Read the dimensions and the channel count from the header of the image in `aIn`.
+    static math::Size<2, int> ReadInfo(std::istream & aIn, int & aChannels)
+    {
+        math::Size<2, int> dimensions = math::Size<2, int>::Zero();
+        if (stbi_info_from_callbacks(&streamCallbacks, &aIn,
+                                     &dimensions.width(), &dimensions.height(), &aChannels) == 0)
+        {
+            throw std::runtime_error{std::string{"Cannot read image header: "} + stbi_failure_reason()};
+        }
+        return dimensions;
+    }
+
+
     static void WriteCallback(void * aContext, void * aData, int aSize)
     {
         std::ostream * aOut = reinterpret_cast<std::ostream *>(aContext);
@@ -132,10 +146,17 @@ struct StbImageFormats
 
     template <class T_pixel>
     static void Write(std::ostream & aOut,
-                      const Image<T_pixel> & aImage,
+                      ImageView<const T_pixel> aImage,
                       ImageFormat aFormat,
                       ImageOrientation aOrientation)
     {
+        // Only the PNG writer accepts a row stride, other formats require contiguous pixels.
+        if (aFormat != ImageFormat::Png && !aImage.isContiguous())
+        {
+            const Image<T_pixel> contiguous{aImage};
+            return Write(aOut, contiguous.view(), aFormat, aOrientation);
+        }
+
         stbi_flip_vertically_on_write(aOrientation == ImageOrientation::InvertVerticalAxis);
 
         switch(aFormat)
@@ -145,18 +166,20 @@ struct StbImageFormats
                                    aImage.width(), aImage.height(),
                                    stbi_traits<T_pixel>::channels,
                                    aImage.data());
+            break;
         case ImageFormat::Jpg:
             stbi_write_jpg_to_func(&WriteCallback, &aOut,
                                    aImage.width(), aImage.height(),
                                    stbi_traits<T_pixel>::channels,
                                    aImage.data(),
                                    gJpegQuality);
+            break;
         case ImageFormat::Png:
             stbi_write_png_to_func(&WriteCallback, &aOut,
                                    aImage.width(), aImage.height(),
                                    stbi_traits<T_pixel>::channels,
                                    aImage.data(),
-                                   (int)aImage.size_bytes_line());
+                                   (int)aImage.stride_bytes());
             break;
         default:
             throw std::runtime_error{"STB does not write format: " + to_string(aFormat)};
@@ -164,9 +187,15 @@ struct StbImageFormats
     };
 
     static void WriteHdr(std::ostream & aOut,
-                         const Image<math::hdr::Rgb_f> & aImage,
+                         ImageView<const math::hdr::Rgb_f> aImage,
                          ImageOrientation aOrientation)
     {
+        if (!aImage.isContiguous())
+        {
+            const Image<math::hdr::Rgb_f> contiguous{aImage};
+            return WriteHdr(aOut, contiguous.view(), aOrientation);
+        }
+
         stbi_flip_vertically_on_write(aOrientation == ImageOrientation::InvertVerticalAxis);
 
         stbi_write_hdr_to_func(&WriteCallback, &aOut,
@@ -2,4 +2,47 @@
 
 #include <nlohmann/json.hpp>
 
-using Json = nlohmann::json;
\ No newline at end of file
+#include <istream>
+#include <string>
+#include <string_view>
+
+using Json = nlohmann::json;
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+/// \brief Parse the JSON document from `aInput`, passing each object element of its top-level
+/// collections (arrays or objects) to `aOnElement` as soon as this element is complete.
+///
+/// `aOnElement(std::string_view aCollectionKey, const Json & aElement) -> bool` returns true when it consumed
+/// the element, which is then discarded: the DOM never holds more than one element of the consumed collections.
+/// This relies on nlohmann's callback parser, itself implemented over its SAX interface.
+/// \return The document without the consumed elements (their collections remain, empty).
+template <class F_onElement>
+Json parseConsumingElements(std::istream & aInput, F_onElement && aOnElement)
+{
+    std::string collection;
+    return Json::parse(
+        aInput,
+        [&collection, &aOnElement](int aDepth, Json::parse_event_t aEvent, Json & aParsed) -> bool
+        {
+            if (aDepth == 1 && aEvent == Json::parse_event_t::key)
+            {
+                collection = aParsed.get_ref<const std::string &>();
+            }
+            else if (aDepth == 2 && aEvent == Json::parse_event_t::object_end)
+            {
+                // Returning false discards the element from its collection.
+                return !aOnElement(std::string_view{collection}, static_cast<const Json &>(aParsed));
+            }
+            return true;
+        });
+}
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,266 @@
+#include "MappedFile.h"
+
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+namespace {
+
+
+#if defined(_WIN32)
+
+    [[noreturn]] void throwLastError(const std::string & aWhat, const filesystem::path & aFile)
+    {
+        throw std::system_error{static_cast<int>(::GetLastError()), std::system_category(),
+                                aWhat + " '" + aFile.string() + "'"};
+    }
+
+
+    /// \brief Closes the handle when going out of scope.
+    /// The mapped view remains valid after both the file and mapping handles are closed.
+    struct HandleGuard
+    {
+        ~HandleGuard()
+        {
+            if (mHandle != nullptr && mHandle != INVALID_HANDLE_VALUE)
+            {
+                ::CloseHandle(mHandle);
+            }
+        }
+
+        HANDLE mHandle;
+    };
+
+
+    std::byte * mapView(HANDLE aFile, std::size_t aSize, MappedFile::Access aAccess,
+                        const filesystem::path & aPath)
+    {
+        const bool write = (aAccess == MappedFile::Access::ReadWrite);
+        const auto size = static_cast<unsigned long long>(aSize);
+        // Mapping a size larger than the file extends it.
+        HandleGuard mapping{::CreateFileMappingW(aFile, nullptr,
+                                                 write ? PAGE_READWRITE : PAGE_READONLY,
+                                                 static_cast<DWORD>(size >> 32),
+                                                 static_cast<DWORD>(size & 0xFFFFFFFF),
+                                                 nullptr)};
+        if (mapping.mHandle == nullptr)
+        {
+            throwLastError("Cannot create file mapping for", aPath);
+        }
+
+        void * view = ::MapViewOfFile(mapping.mHandle, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, aSize);
+        if (view == nullptr)
+        {
+            throwLastError("Cannot map view of", aPath);
+        }
+        return static_cast<std::byte *>(view);
+    }
+
+#else
+
+    [[noreturn]] void throwErrno(const std::string & aWhat, const filesystem::path & aFile)
+    {
+        throw std::system_error{errno, std::generic_category(), aWhat + " '" + aFile.string() + "'"};
+    }
+
+
+    /// \brief Closes the file descriptor when going out of scope.
+    /// The mapping remains valid after the descriptor is closed.
+    struct DescriptorGuard
+    {
+        ~DescriptorGuard()
+        {
+            if (mDescriptor != -1)
+            {
+                ::close(mDescriptor);
+            }
+        }
+
+        int mDescriptor;
+    };
+
+
+    std::byte * mapView(int aDescriptor, std::size_t aSize, MappedFile::Access aAccess,
+                        const filesystem::path & aPath)
+    {
+        const int protection =
+            (aAccess == MappedFile::Access::ReadWrite) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void * view = ::mmap(nullptr, aSize, protection, MAP_SHARED, aDescriptor, 0);
+        if (view == MAP_FAILED)
+        {
+            throwErrno("Cannot map", aPath);
+        }
+        // The usual access pattern is a single pass over the rows.
+        ::madvise(view, aSize, MADV_SEQUENTIAL);
+        return static_cast<std::byte *>(view);
+    }
+
+#endif
+
+
+} // anonymous namespace
+
+
+MappedFile MappedFile::Open(const filesystem::path & aFile, Access aAccess)
+{
+    const bool write = (aAccess == Access::ReadWrite);
+
+#if defined(_WIN32)
+    HandleGuard file{::CreateFileW(aFile.c_str(),
+                                   write ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                                   FILE_SHARE_READ,
+                                   nullptr,
+                                   OPEN_EXISTING,
+                                   FILE_FLAG_SEQUENTIAL_SCAN,
+                                   nullptr)};
+    if (file.mHandle == INVALID_HANDLE_VALUE)
+    {
+        throwLastError("Cannot open", aFile);
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!::GetFileSizeEx(file.mHandle, &fileSize))
+    {
+        throwLastError("Cannot get the size of", aFile);
+    }
+    const auto size = static_cast<std::size_t>(fileSize.QuadPart);
+    // Empty files cannot be mapped.
+    return size == 0 ? MappedFile{nullptr, 0, aAccess}
+                     : MappedFile{mapView(file.mHandle, size, aAccess, aFile), size, aAccess};
+#else
+    DescriptorGuard file{::open(aFile.c_str(), write ? O_RDWR : O_RDONLY)};
+    if (file.mDescriptor == -1)
+    {
+        throwErrno("Cannot open", aFile);
+    }
+
+    struct stat status;
+    if (::fstat(file.mDescriptor, &status) == -1)
+    {
+        throwErrno("Cannot get the size of", aFile);
+    }
+    const auto size = static_cast<std::size_t>(status.st_size);
+    // Empty files cannot be mapped.
+    return size == 0 ? MappedFile{nullptr, 0, aAccess}
+                     : MappedFile{mapView(file.mDescriptor, size, aAccess, aFile), size, aAccess};
+#endif
+}
+
+
+MappedFile MappedFile::Create(const filesystem::path & aFile, std::size_t aSizeBytes)
+{
+#if defined(_WIN32)
+    HandleGuard file{::CreateFileW(aFile.c_str(),
+                                   GENERIC_READ | GENERIC_WRITE,
+                                   0,
+                                   nullptr,
+                                   CREATE_ALWAYS,
+                                   FILE_ATTRIBUTE_NORMAL,
+                                   nullptr)};
+    if (file.mHandle == INVALID_HANDLE_VALUE)
+    {
+        throwLastError("Cannot create", aFile);
+    }
+    return aSizeBytes == 0 ?
+        MappedFile{nullptr, 0, Access::ReadWrite}
+        : MappedFile{mapView(file.mHandle, aSizeBytes, Access::ReadWrite, aFile), aSizeBytes, Access::ReadWrite};
+#else
+    DescriptorGuard file{::open(aFile.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666)};
+    if (file.mDescriptor == -1)
+    {
+        throwErrno("Cannot create", aFile);
+    }
+    if (::ftruncate(file.mDescriptor, static_cast<off_t>(aSizeBytes)) == -1)
+    {
+        throwErrno("Cannot resize", aFile);
+    }
+    return aSizeBytes == 0 ?
+        MappedFile{nullptr, 0, Access::ReadWrite}
+        : MappedFile{mapView(file.mDescriptor, aSizeBytes, Access::ReadWrite, aFile), aSizeBytes, Access::ReadWrite};
+#endif
+}
+
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+
+MappedFile::MappedFile(MappedFile && aRhs) noexcept :
+    mData{std::exchange(aRhs.mData, nullptr)},
+    mSize{std::exchange(aRhs.mSize, 0)},
+    mAccess{aRhs.mAccess}
+{}
+
+
+MappedFile & MappedFile::operator=(MappedFile && aRhs) noexcept
+{
+    if (this != &aRhs)
+    {
+        unmap();
+        mData = std::exchange(aRhs.mData, nullptr);
+        mSize = std::exchange(aRhs.mSize, 0);
+        mAccess = aRhs.mAccess;
+    }
+    return *this;
+}
+
+
+void MappedFile::flush()
+{
+    if (mData == nullptr)
+    {
+        return;
+    }
+
+#if defined(_WIN32)
+    if (!::FlushViewOfFile(mData, mSize))
+    {
+        throw std::system_error{static_cast<int>(::GetLastError()), std::system_category(),
+                                "Cannot flush mapped file"};
+    }
+#else
+    if (::msync(mData, mSize, MS_SYNC) == -1)
+    {
+        throw std::system_error{errno, std::generic_category(), "Cannot flush mapped file"};
+    }
+#endif
+}
+
+
+void MappedFile::unmap()
+{
+    if (mData != nullptr)
+    {
+#if defined(_WIN32)
+        ::UnmapViewOfFile(mData);
+#else
+        ::munmap(mData, mSize);
+#endif
+        mData = nullptr;
+        mSize = 0;
+    }
+}
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,72 @@
+#pragma once
+
+
+#include <platform/Filesystem.h>
+
+#include <cstddef>
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+/// \brief Maps the content of a file in the address space of the process.
+///
+/// The mapping remains valid until the MappedFile is destroyed, independently of the file handle.
+class MappedFile
+{
+public:
+    enum class Access
+    {
+        Read,
+        ReadWrite,
+    };
+
+    MappedFile() = default;
+
+    /// \brief Map the complete existing file `aFile`.
+    static MappedFile Open(const filesystem::path & aFile, Access aAccess = Access::Read);
+
+    /// \brief Create `aFile` (truncating it if it exists) with a size of `aSizeBytes`,
+    /// and map it for writing.
+    static MappedFile Create(const filesystem::path & aFile, std::size_t aSizeBytes);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile && aRhs) noexcept;
+    MappedFile & operator=(MappedFile && aRhs) noexcept;
+
+    std::byte * data() const
+    { return mData; }
+
+    std::size_t size_bytes() const
+    { return mSize; }
+
+    bool isWritable() const
+    { return mAccess == Access::ReadWrite; }
+
+    /// \brief Write back the modified pages to the file, blocking until it is done.
+    void flush();
+
+private:
+    MappedFile(std::byte * aData, std::size_t aSize, Access aAccess) :
+        mData{aData},
+        mSize{aSize},
+        mAccess{aAccess}
+    {}
+
+    void unmap();
+
+    std::byte * mData{nullptr};
+    std::size_t mSize{0};
+    Access mAccess{Access::Read};
+};
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,836 @@
+#include "PixelKernels.h"
+
+#include "../HalfFloat.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   define ARTE_KERNELS_X86
+#   include <immintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   endif
+#endif
+
+// MSVC lets any function use any intrinsic, GCC and Clang require the target to be explicit.
+#if defined(_MSC_VER) && !defined(__clang__)
+#   define ARTE_TARGET(isa)
+#else
+#   define ARTE_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+namespace kernels {
+
+
+namespace {
+
+
+    //
+    // Scalar implementations
+    // They also handle the tails which do not fill a complete vector.
+    //
+    void averageRgbToGray_scalar(const std::uint8_t * aRgb, std::uint8_t * aGray, std::size_t aCount)
+    {
+        for (std::size_t pixel = 0; pixel != aCount; ++pixel, aRgb += 3)
+        {
+            aGray[pixel] = static_cast<std::uint8_t>((aRgb[0] + aRgb[1] + aRgb[2]) / 3);
+        }
+    }
+
+
+    void unormToFloat_scalar(const std::uint8_t * aSource, float * aDestination, std::size_t aCount)
+    {
+        for (std::size_t i = 0; i != aCount; ++i)
+        {
+            aDestination[i] = aSource[i] / 255.f;
+        }
+    }
+
+
+    // Written so NaN maps to 0, like the vector versions.
+    float clampUnit(float aValue)
+    {
+        return aValue > 0.f ? std::min(aValue, 1.f) : 0.f;
+    }
+
+
+    void floatToUnorm_scalar(const float * aSource, std::uint8_t * aDestination, std::size_t aCount)
+    {
+        for (std::size_t i = 0; i != aCount; ++i)
+        {
+            aDestination[i] = static_cast<std::uint8_t>(clampUnit(aSource[i]) * 255.f + 0.5f);
+        }
+    }
+
+
+    // Linear segment of the sRGB transfer function.
+    constexpr float gSRGBThreshold = 0.0031308f;
+    constexpr float gSRGBSlope = 12.92f;
+    // Coefficients of the approximation of `1.055 * c^(1/2.4) - 0.055`,
+    // with s1 = sqrt(c), s2 = sqrt(s1), s3 = sqrt(s2).
+    constexpr float gSRGBS1 = 0.662002687f;
+    constexpr float gSRGBS2 = 0.684122060f;
+    constexpr float gSRGBS3 = -0.323583601f;
+    constexpr float gSRGBC = -0.0225411470f;
+
+
+    void encodeSRGB_scalar(const float * aLinear, std::uint8_t * aEncoded, std::size_t aCount)
+    {
+        for (std::size_t i = 0; i != aCount; ++i)
+        {
+            float c = clampUnit(aLinear[i]);
+            float encoded;
+            if (c <= gSRGBThreshold)
+            {
+                encoded = gSRGBSlope * c;
+            }
+            else
+            {
+                float s1 = std::sqrt(c);
+                float s2 = std::sqrt(s1);
+                float s3 = std::sqrt(s2);
+                encoded = std::min(gSRGBS1 * s1 + gSRGBS2 * s2 + gSRGBS3 * s3 + gSRGBC * c, 1.f);
+            }
+            aEncoded[i] = static_cast<std::uint8_t>(encoded * 255.f + 0.5f);
+        }
+    }
+
+
+    void floatToHalf_scalar(const float * aSource, std::uint16_t * aDestination, std::size_t aCount)
+    {
+        for (std::size_t i = 0; i != aCount; ++i)
+        {
+            aDestination[i] = toHalfBits(aSource[i]);
+        }
+    }
+
+
+    void halfToFloat_scalar(const std::uint16_t * aSource, float * aDestination, std::size_t aCount)
+    {
+        for (std::size_t i = 0; i != aCount; ++i)
+        {
+            aDestination[i] = fromHalfBits(aSource[i]);
+        }
+    }
+
+
+    std::uint32_t selectPaletteIndices_scalar(const std::uint8_t * aBlock,
+                                              const std::uint8_t * aPalette,
+                                              int aPaletteSize,
+                                              std::uint8_t * aIndices)
+    {
+        std::uint32_t total = 0;
+        for (int pixel = 0; pixel != 16; ++pixel, aBlock += 4)
+        {
+            std::uint32_t best = std::numeric_limits<std::uint32_t>::max();
+            for (int entry = 0; entry != aPaletteSize; ++entry)
+            {
+                const std::uint8_t * color = aPalette + entry * 4;
+                std::uint32_t distance = 0;
+                for (int channel = 0; channel != 4; ++channel)
+                {
+                    const int difference = aBlock[channel] - color[channel];
+                    distance += difference * difference;
+                }
+                if (distance < best)
+                {
+                    best = distance;
+                    aIndices[pixel] = static_cast<std::uint8_t>(entry);
+                }
+            }
+            total += best;
+        }
+        return total;
+    }
+
+
+    std::size_t findFirstVisible_scalar(const std::uint8_t * aRgba, std::size_t aCount)
+    {
+        std::size_t i = 0;
+        while (i != aCount && aRgba[4 * i + 3] == 0)
+        {
+            ++i;
+        }
+        return i;
+    }
+
+
+    std::size_t findVisibleEnd_scalar(const std::uint8_t * aRgba, std::size_t aCount)
+    {
+        std::size_t end = aCount;
+        while (end != 0 && aRgba[4 * (end - 1) + 3] == 0)
+        {
+            --end;
+        }
+        return end;
+    }
+
+
+#if defined(ARTE_KERNELS_X86)
+
+    //
+    // SSE implementations
+    //
+
+    // Mask for _mm_shuffle_epi8, gathering the values of `aChannel` found in the 16-bytes `aBlock`
+    // out of 48 bytes of packed RGB pixels, to their pixel index.
+    constexpr std::array<char, 16> makeDeinterleaveMask(int aChannel, int aBlock)
+    {
+        std::array<char, 16> mask{};
+        for (int pixel = 0; pixel != 16; ++pixel)
+        {
+            int source = pixel * 3 + aChannel - aBlock * 16;
+            mask[pixel] = (source >= 0 && source < 16) ? static_cast<char>(source) : char{-128};
+        }
+        return mask;
+    }
+
+    constexpr std::array<std::array<std::array<char, 16>, 3>, 3> gDeinterleaveMasks{{
+        {makeDeinterleaveMask(0, 0), makeDeinterleaveMask(0, 1), makeDeinterleaveMask(0, 2)},
+        {makeDeinterleaveMask(1, 0), makeDeinterleaveMask(1, 1), makeDeinterleaveMask(1, 2)},
+        {makeDeinterleaveMask(2, 0), makeDeinterleaveMask(2, 1), makeDeinterleaveMask(2, 2)},
+    }};
+
+
+    ARTE_TARGET("ssse3")
+    __m128i gatherChannel(int aChannel, __m128i aBlock0, __m128i aBlock1, __m128i aBlock2)
+    {
+        const auto & masks = gDeinterleaveMasks[aChannel];
+        __m128i mask0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(masks[0].data()));
+        __m128i mask1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(masks[1].data()));
+        __m128i mask2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(masks[2].data()));
+        return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(aBlock0, mask0),
+                                         _mm_shuffle_epi8(aBlock1, mask1)),
+                            _mm_shuffle_epi8(aBlock2, mask2));
+    }
+
+
+    // Integer division by 3 of 16-bit lanes holding at most 765, as (x * 43691) >> 17.
+    ARTE_TARGET("ssse3")
+    __m128i divideBy3(__m128i aSum)
+    {
+        return _mm_srli_epi16(_mm_mulhi_epu16(aSum, _mm_set1_epi16(static_cast<short>(43691))), 1);
+    }
+
+
+    ARTE_TARGET("ssse3")
+    void averageRgbToGray_sse(const std::uint8_t * aRgb, std::uint8_t * aGray, std::size_t aCount)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        std::size_t pixel = 0;
+        for (; pixel + 16 <= aCount; pixel += 16, aRgb += 48)
+        {
+            __m128i block0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aRgb));
+            __m128i block1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aRgb + 16));
+            __m128i block2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aRgb + 32));
+
+            __m128i r = gatherChannel(0, block0, block1, block2);
+            __m128i g = gatherChannel(1, block0, block1, block2);
+            __m128i b = gatherChannel(2, block0, block1, block2);
+
+            __m128i sumLow = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(r, zero),
+                                                         _mm_unpacklo_epi8(g, zero)),
+                                           _mm_unpacklo_epi8(b, zero));
+            __m128i sumHigh = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(r, zero),
+                                                          _mm_unpackhi_epi8(g, zero)),
+                                            _mm_unpackhi_epi8(b, zero));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(aGray + pixel),
+                             _mm_packus_epi16(divideBy3(sumLow), divideBy3(sumHigh)));
+        }
+        averageRgbToGray_scalar(aRgb, aGray + pixel, aCount - pixel);
+    }
+
+
+    ARTE_TARGET("ssse3")
+    void unormToFloat_sse(const std::uint8_t * aSource, float * aDestination, std::size_t aCount)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 max = _mm_set1_ps(255.f);
+        std::size_t i = 0;
+        for (; i + 16 <= aCount; i += 16)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aSource + i));
+            __m128i words[2] = {_mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero)};
+            for (int half = 0; half != 2; ++half)
+            {
+                __m128i low = _mm_unpacklo_epi16(words[half], zero);
+                __m128i high = _mm_unpackhi_epi16(words[half], zero);
+                // Division (instead of multiplying by the reciprocal) gives the exact same results as the scalar code
+                _mm_storeu_ps(aDestination + i + half * 8, _mm_div_ps(_mm_cvtepi32_ps(low), max));
+                _mm_storeu_ps(aDestination + i + half * 8 + 4, _mm_div_ps(_mm_cvtepi32_ps(high), max));
+            }
+        }
+        unormToFloat_scalar(aSource + i, aDestination + i, aCount - i);
+    }
+
+
+    // Store 16 rounded integers in [0, 255], held by 4 vectors, as 16 bytes.
+    ARTE_TARGET("ssse3")
+    void storeUnorm(std::uint8_t * aDestination, __m128 a0, __m128 a1, __m128 a2, __m128 a3)
+    {
+        const __m128 half = _mm_set1_ps(0.5f);
+        __m128i low = _mm_packs_epi32(_mm_cvttps_epi32(_mm_add_ps(a0, half)),
+                                      _mm_cvttps_epi32(_mm_add_ps(a1, half)));
+        __m128i high = _mm_packs_epi32(_mm_cvttps_epi32(_mm_add_ps(a2, half)),
+                                       _mm_cvttps_epi32(_mm_add_ps(a3, half)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(aDestination), _mm_packus_epi16(low, high));
+    }
+
+
+    ARTE_TARGET("ssse3")
+    __m128 clampUnit_sse(__m128 aValue)
+    {
+        // The zero is the second operand, so NaN is mapped to it.
+        return _mm_min_ps(_mm_max_ps(aValue, _mm_setzero_ps()), _mm_set1_ps(1.f));
+    }
+
+
+    ARTE_TARGET("ssse3")
+    void floatToUnorm_sse(const float * aSource, std::uint8_t * aDestination, std::size_t aCount)
+    {
+        const __m128 max = _mm_set1_ps(255.f);
+        std::size_t i = 0;
+        for (; i + 16 <= aCount; i += 16)
+        {
+            __m128 scaled[4];
+            for (int quarter = 0; quarter != 4; ++quarter)
+            {
+                scaled[quarter] = _mm_mul_ps(clampUnit_sse(_mm_loadu_ps(aSource + i + quarter * 4)), max);
+            }
+            storeUnorm(aDestination + i, scaled[0], scaled[1], scaled[2], scaled[3]);
+        }
+        floatToUnorm_scalar(aSource + i, aDestination + i, aCount - i);
+    }
+
+
+    ARTE_TARGET("ssse3")
+    __m128 encodeSRGB_sse(__m128 aLinear)
+    {
+        __m128 c = clampUnit_sse(aLinear);
+        __m128 s1 = _mm_sqrt_ps(c);
+        __m128 s2 = _mm_sqrt_ps(s1);
+        __m128 s3 = _mm_sqrt_ps(s2);
+        __m128 curve = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_set1_ps(gSRGBS1), s1), _mm_mul_ps(_mm_set1_ps(gSRGBS2), s2)),
+            _mm_add_ps(_mm_mul_ps(_mm_set1_ps(gSRGBS3), s3), _mm_mul_ps(_mm_set1_ps(gSRGBC), c)));
+        curve = _mm_min_ps(curve, _mm_set1_ps(1.f));
+        __m128 linear = _mm_mul_ps(_mm_set1_ps(gSRGBSlope), c);
+        __m128 isLinear = _mm_cmple_ps(c, _mm_set1_ps(gSRGBThreshold));
+        return _mm_or_ps(_mm_and_ps(isLinear, linear), _mm_andnot_ps(isLinear, curve));
+    }
+
+
+    ARTE_TARGET("ssse3")
+    void encodeSRGB_sse(const float * aLinear, std::uint8_t * aEncoded, std::size_t aCount)
+    {
+        const __m128 max = _mm_set1_ps(255.f);
+        std::size_t i = 0;
+        for (; i + 16 <= aCount; i += 16)
+        {
+            __m128 scaled[4];
+            for (int quarter = 0; quarter != 4; ++quarter)
+            {
+                scaled[quarter] = _mm_mul_ps(encodeSRGB_sse(_mm_loadu_ps(aLinear + i + quarter * 4)), max);
+            }
+            storeUnorm(aEncoded + i, scaled[0], scaled[1], scaled[2], scaled[3]);
+        }
+        encodeSRGB_scalar(aLinear + i, aEncoded + i, aCount - i);
+    }
+
+
+    //
+    // AVX2 implementations
+    //
+
+    ARTE_TARGET("avx2")
+    void unormToFloat_avx2(const std::uint8_t * aSource, float * aDestination, std::size_t aCount)
+    {
+        const __m256 max = _mm256_set1_ps(255.f);
+        std::size_t i = 0;
+        for (; i + 16 <= aCount; i += 16)
+        {
+            __m256i low = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(aSource + i)));
+            __m256i high = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(aSource + i + 8)));
+            _mm256_storeu_ps(aDestination + i, _mm256_div_ps(_mm256_cvtepi32_ps(low), max));
+            _mm256_storeu_ps(aDestination + i + 8, _mm256_div_ps(_mm256_cvtepi32_ps(high), max));
+        }
+        unormToFloat_scalar(aSource + i, aDestination + i, aCount - i);
+    }
+
+
+    // Store 32 rounded integers in [0, 255], held by 4 vectors, as 32 bytes.
+    ARTE_TARGET("avx2")
+    void storeUnorm(std::uint8_t * aDestination, __m256 a0, __m256 a1, __m256 a2, __m256 a3)
+    {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        // Packing operates within each 128-bit lane, the final permutation restores the order.
+        __m256i low = _mm256_packs_epi32(_mm256_cvttps_epi32(_mm256_add_ps(a0, half)),
+                                         _mm256_cvttps_epi32(_mm256_add_ps(a1, half)));
+        __m256i high = _mm256_packs_epi32(_mm256_cvttps_epi32(_mm256_add_ps(a2, half)),
+                                          _mm256_cvttps_epi32(_mm256_add_ps(a3, half)));
+        __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(low, high),
+                                                    _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(aDestination), bytes);
+    }
+
+
+    ARTE_TARGET("avx2")
+    __m256 clampUnit_avx2(__m256 aValue)
+    {
+        return _mm256_min_ps(_mm256_max_ps(aValue, _mm256_setzero_ps()), _mm256_set1_ps(1.f));
+    }
+
+
+    ARTE_TARGET("avx2")
+    void floatToUnorm_avx2(const float * aSource, std::uint8_t * aDestination, std::size_t aCount)
+    {
+        const __m256 max = _mm256_set1_ps(255.f);
+        std::size_t i = 0;
+        for (; i + 32 <= aCount; i += 32)
+        {
+            __m256 scaled[4];
+            for (int quarter = 0; quarter != 4; ++quarter)
+            {
+                scaled[quarter] = _mm256_mul_ps(clampUnit_avx2(_mm256_loadu_ps(aSource + i + quarter * 8)), max);
+            }
+            storeUnorm(aDestination + i, scaled[0], scaled[1], scaled[2], scaled[3]);
+        }
+        floatToUnorm_scalar(aSource + i, aDestination + i, aCount - i);
+    }
+
+
+    ARTE_TARGET("avx2")
+    __m256 encodeSRGB_avx2(__m256 aLinear)
+    {
+        __m256 c = clampUnit_avx2(aLinear);
+        __m256 s1 = _mm256_sqrt_ps(c);
+        __m256 s2 = _mm256_sqrt_ps(s1);
+        __m256 s3 = _mm256_sqrt_ps(s2);
+        __m256 curve = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(gSRGBS1), s1), _mm256_mul_ps(_mm256_set1_ps(gSRGBS2), s2)),
+            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(gSRGBS3), s3), _mm256_mul_ps(_mm256_set1_ps(gSRGBC), c)));
+        curve = _mm256_min_ps(curve, _mm256_set1_ps(1.f));
+        __m256 linear = _mm256_mul_ps(_mm256_set1_ps(gSRGBSlope), c);
+        return _mm256_blendv_ps(curve, linear, _mm256_cmp_ps(c, _mm256_set1_ps(gSRGBThreshold), _CMP_LE_OQ));
+    }
+
+
+    ARTE_TARGET("avx2")
+    void encodeSRGB_avx2(const float * aLinear, std::uint8_t * aEncoded, std::size_t aCount)
+    {
+        const __m256 max = _mm256_set1_ps(255.f);
+        std::size_t i = 0;
+        for (; i + 32 <= aCount; i += 32)
+        {
+            __m256 scaled[4];
+            for (int quarter = 0; quarter != 4; ++quarter)
+            {
+                scaled[quarter] = _mm256_mul_ps(encodeSRGB_avx2(_mm256_loadu_ps(aLinear + i + quarter * 8)), max);
+            }
+            storeUnorm(aEncoded + i, scaled[0], scaled[1], scaled[2], scaled[3]);
+        }
+        encodeSRGB_scalar(aLinear + i, aEncoded + i, aCount - i);
+    }
+
+
+    // F16C is not implied by AVX2, but is supported by all the CPUs implementing AVX2.
+    ARTE_TARGET("avx2,f16c")
+    void floatToHalf_avx2(const float * aSource, std::uint16_t * aDestination, std::size_t aCount)
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= aCount; i += 8)
+        {
+            __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(aSource + i), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(aDestination + i), halves);
+        }
+        floatToHalf_scalar(aSource + i, aDestination + i, aCount - i);
+    }
+
+
+    ARTE_TARGET("avx2,f16c")
+    void halfToFloat_avx2(const std::uint16_t * aSource, float * aDestination, std::size_t aCount)
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= aCount; i += 8)
+        {
+            __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aSource + i));
+            _mm256_storeu_ps(aDestination + i, _mm256_cvtph_ps(halves));
+        }
+        halfToFloat_scalar(aSource + i, aDestination + i, aCount - i);
+    }
+
+
+    // Each group of 4 pixels is compared to all palette entries at once:
+    // the squared distances are accumulated as 32-bit lanes, one per pixel.
+    ARTE_TARGET("ssse3")
+    std::uint32_t selectPaletteIndices_sse(const std::uint8_t * aBlock,
+                                           const std::uint8_t * aPalette,
+                                           int aPaletteSize,
+                                           std::uint8_t * aIndices)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i total = zero;
+
+        for (int group = 0; group != 4; ++group)
+        {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aBlock + group * 16));
+            const __m128i low = _mm_unpacklo_epi8(pixels, zero);
+            const __m128i high = _mm_unpackhi_epi8(pixels, zero);
+
+            __m128i best = _mm_set1_epi32(std::numeric_limits<std::int32_t>::max());
+            __m128i bestIndex = zero;
+            for (int entry = 0; entry != aPaletteSize; ++entry)
+            {
+                const std::uint8_t * color = aPalette + entry * 4;
+                const __m128i broadcast = _mm_setr_epi16(color[0], color[1], color[2], color[3],
+                                                         color[0], color[1], color[2], color[3]);
+                const __m128i differenceLow = _mm_sub_epi16(low, broadcast);
+                const __m128i differenceHigh = _mm_sub_epi16(high, broadcast);
+                // Each pixel gives two partial sums (r² + g², b² + a²), which are then added horizontally.
+                const __m128i distance = _mm_hadd_epi32(_mm_madd_epi16(differenceLow, differenceLow),
+                                                        _mm_madd_epi16(differenceHigh, differenceHigh));
+
+                const __m128i closer = _mm_cmplt_epi32(distance, best);
+                best = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, best));
+                bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(entry)),
+                                         _mm_andnot_si128(closer, bestIndex));
+            }
+
+            alignas(16) std::array<std::int32_t, 4> indices;
+            _mm_store_si128(reinterpret_cast<__m128i *>(indices.data()), bestIndex);
+            for (int pixel = 0; pixel != 4; ++pixel)
+            {
+                aIndices[group * 4 + pixel] = static_cast<std::uint8_t>(indices[pixel]);
+            }
+            total = _mm_add_epi32(total, best);
+        }
+
+        alignas(16) std::array<std::uint32_t, 4> sums;
+        _mm_store_si128(reinterpret_cast<__m128i *>(sums.data()), total);
+        return sums[0] + sums[1] + sums[2] + sums[3];
+    }
+
+
+    // Bitmask of the visible pixels (with a non-zero alpha, the high byte of each 32-bit lane)
+    // among the 4 RGBA pixels at `aRgba`.
+    ARTE_TARGET("ssse3")
+    unsigned int visibleMask_sse(const std::uint8_t * aRgba)
+    {
+        const __m128i alpha = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(aRgba)),
+                                            _mm_set1_epi32(static_cast<int>(0xFF000000)));
+        const __m128i transparent = _mm_cmpeq_epi32(alpha, _mm_setzero_si128());
+        return ~static_cast<unsigned int>(_mm_movemask_ps(_mm_castsi128_ps(transparent))) & 0xF;
+    }
+
+
+    ARTE_TARGET("ssse3")
+    std::size_t findFirstVisible_sse(const std::uint8_t * aRgba, std::size_t aCount)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= aCount; i += 4)
+        {
+            if (unsigned int visible = visibleMask_sse(aRgba + 4 * i))
+            {
+                return i + std::countr_zero(visible);
+            }
+        }
+        return i + findFirstVisible_scalar(aRgba + 4 * i, aCount - i);
+    }
+
+
+    ARTE_TARGET("ssse3")
+    std::size_t findVisibleEnd_sse(const std::uint8_t * aRgba, std::size_t aCount)
+    {
+        std::size_t end = aCount;
+        for (; end >= 4; end -= 4)
+        {
+            if (unsigned int visible = visibleMask_sse(aRgba + 4 * (end - 4)))
+            {
+                return end - 4 + std::bit_width(visible);
+            }
+        }
+        return findVisibleEnd_scalar(aRgba, end);
+    }
+
+
+    ARTE_TARGET("avx2")
+    unsigned int visibleMask_avx2(const std::uint8_t * aRgba)
+    {
+        const __m256i alpha = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(aRgba)),
+                                               _mm256_set1_epi32(static_cast<int>(0xFF000000)));
+        const __m256i transparent = _mm256_cmpeq_epi32(alpha, _mm256_setzero_si256());
+        return ~static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(transparent))) & 0xFF;
+    }
+
+
+    ARTE_TARGET("avx2")
+    std::size_t findFirstVisible_avx2(const std::uint8_t * aRgba, std::size_t aCount)
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= aCount; i += 8)
+        {
+            if (unsigned int visible = visibleMask_avx2(aRgba + 4 * i))
+            {
+                return i + std::countr_zero(visible);
+            }
+        }
+        return i + findFirstVisible_scalar(aRgba + 4 * i, aCount - i);
+    }
+
+
+    ARTE_TARGET("avx2")
+    std::size_t findVisibleEnd_avx2(const std::uint8_t * aRgba, std::size_t aCount)
+    {
+        std::size_t end = aCount;
+        for (; end >= 8; end -= 8)
+        {
+            if (unsigned int visible = visibleMask_avx2(aRgba + 4 * (end - 8)))
+            {
+                return end - 8 + std::bit_width(visible);
+            }
+        }
+        return findVisibleEnd_scalar(aRgba, end);
+    }
+
+#endif // ARTE_KERNELS_X86
+
+
+    SimdLevel detect()
+    {
+#if defined(ARTE_KERNELS_X86)
+#   if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        const bool ssse3 = (info[2] & (1 << 9)) != 0;
+        // AVX registers must also be saved by the OS
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool ymmEnabled = osxsave && ((_xgetbv(0) & 0x6) == 0x6);
+        const bool f16c = (info[2] & (1 << 29)) != 0;
+        __cpuidex(info, 7, 0);
+        const bool avx2 = ymmEnabled && f16c && (info[1] & (1 << 5)) != 0;
+#   else
+        __builtin_cpu_init();
+        const bool ssse3 = __builtin_cpu_supports("ssse3");
+        const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#   endif
+        if (avx2)
+        {
+            return SimdLevel::Avx2;
+        }
+        else if (ssse3)
+        {
+            return SimdLevel::Sse;
+        }
+#endif
+        return SimdLevel::Scalar;
+    }
+
+
+    std::atomic<SimdLevel> & simdLevelStorage()
+    {
+        static std::atomic<SimdLevel> level{detectSimdLevel()};
+        return level;
+    }
+
+
+    std::array<float, 256> makeSRGBDecodeTable()
+    {
+        std::array<float, 256> table;
+        for (int encoded = 0; encoded != 256; ++encoded)
+        {
+            double c = encoded / 255.;
+            table[encoded] = static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+        }
+        return table;
+    }
+
+
+} // anonymous namespace
+
+
+SimdLevel detectSimdLevel()
+{
+    static const SimdLevel detected = detect();
+    return detected;
+}
+
+
+SimdLevel getSimdLevel()
+{
+    return simdLevelStorage().load(std::memory_order_relaxed);
+}
+
+
+SimdLevel setSimdLevel(SimdLevel aLevel)
+{
+    SimdLevel effective = std::min(aLevel, detectSimdLevel());
+    simdLevelStorage().store(effective, std::memory_order_relaxed);
+    return effective;
+}
+
+
+void averageRgbToGray(const std::uint8_t * aRgb, std::uint8_t * aGray, std::size_t aCount)
+{
+    switch (getSimdLevel())
+    {
+#if defined(ARTE_KERNELS_X86)
+        // The deinterleaving does not gain from 256-bit registers, whose shuffles are restricted to 128-bit lanes.
+        case SimdLevel::Avx2:
+        case SimdLevel::Sse:
+            return averageRgbToGray_sse(aRgb, aGray, aCount);
+#endif
+        default:
+            return averageRgbToGray_scalar(aRgb, aGray, aCount);
+    }
+}
+
+
+void unormToFloat(const std::uint8_t * aSource, float * aDestination, std::size_t aCount)
+{
+    switch (getSimdLevel())
+    {
+#if defined(ARTE_KERNELS_X86)
+        case SimdLevel::Avx2:
+            return unormToFloat_avx2(aSource, aDestination, aCount);
+        case SimdLevel::Sse:
+            return unormToFloat_sse(aSource, aDestination, aCount);
+#endif
+        default:
+            return unormToFloat_scalar(aSource, aDestination, aCount);
+    }
+}
+
+
+void floatToUnorm(const float * aSource, std::uint8_t * aDestination, std::size_t aCount)
+{
+    switch (getSimdLevel())
+    {
+#if defined(ARTE_KERNELS_X86)
+        case SimdLevel::Avx2:
+            return floatToUnorm_avx2(aSource, aDestination, aCount);
+        case SimdLevel::Sse:
+            return floatToUnorm_sse(aSource, aDestination, aCount);
+#endif
+        default:
+            return floatToUnorm_scalar(aSource, aDestination, aCount);
+    }
+}
+
+
+void encodeSRGB(const float * aLinear, std::uint8_t * aEncoded, std::size_t aCount)
+{
+    switch (getSimdLevel())
+    {
+#if defined(ARTE_KERNELS_X86)
+        case SimdLevel::Avx2:
+            return encodeSRGB_avx2(aLinear, aEncoded, aCount);
+        case SimdLevel::Sse:
+            return encodeSRGB_sse(aLinear, aEncoded, aCount);
+#endif
+        default:
+            return encodeSRGB_scalar(aLinear, aEncoded, aCount);
+    }
+}
+
+
+void floatToHalf(const float * aSource, std::uint16_t * aDestination, std::size_t aCount)
+{
+    switch (getSimdLevel())
+    {
+#if defined(ARTE_KERNELS_X86)
+        // There are no conversion instructions before F16C, the Sse level uses the scalar code.
+        case SimdLevel::Avx2:
+            return floatToHalf_avx2(aSource, aDestination, aCount);
+#endif
+        default:
+            return floatToHalf_scalar(aSource, aDestination, aCount);
+    }
+}
+
+
+void halfToFloat(const std::uint16_t * aSource, float * aDestination, std::size_t aCount)
+{
+    switch (getSimdLevel())
+    {
+#if defined(ARTE_KERNELS_X86)
+        case SimdLevel::Avx2:
+            return halfToFloat_avx2(aSource, aDestination, aCount);
+#endif
+        default:
+            return halfToFloat_scalar(aSource, aDestination, aCount);
+    }
+}
+
+
+std::uint32_t selectPaletteIndices(const std::uint8_t * aBlock,
+                                   const std::uint8_t * aPalette,
+                                   int aPaletteSize,
+                                   std::uint8_t * aIndices)
+{
+    switch (getSimdLevel())
+    {
+#if defined(ARTE_KERNELS_X86)
+        // A block only fills 4 vectors of 128 bits, wider registers do not help.
+        case SimdLevel::Avx2:
+        case SimdLevel::Sse:
+            return selectPaletteIndices_sse(aBlock, aPalette, aPaletteSize, aIndices);
+#endif
+        default:
+            return selectPaletteIndices_scalar(aBlock, aPalette, aPaletteSize, aIndices);
+    }
+}
+
+
+std::size_t findFirstVisible(const std::uint8_t * aRgba, std::size_t aCount)
+{
+    switch (getSimdLevel())
+    {
+#if defined(ARTE_KERNELS_X86)
+        case SimdLevel::Avx2:
+            return findFirstVisible_avx2(aRgba, aCount);
+        case SimdLevel::Sse:
+            return findFirstVisible_sse(aRgba, aCount);
+#endif
+        default:
+            return findFirstVisible_scalar(aRgba, aCount);
+    }
+}
+
+
+std::size_t findVisibleEnd(const std::uint8_t * aRgba, std::size_t aCount)
+{
+    switch (getSimdLevel())
+    {
+#if defined(ARTE_KERNELS_X86)
+        case SimdLevel::Avx2:
+            return findVisibleEnd_avx2(aRgba, aCount);
+        case SimdLevel::Sse:
+            return findVisibleEnd_sse(aRgba, aCount);
+#endif
+        default:
+            return findVisibleEnd_scalar(aRgba, aCount);
+    }
+}
+
+
+float decodeSRGB(std::uint8_t aEncoded)
+{
+    static const std::array<float, 256> table = makeSRGBDecodeTable();
+    return table[aEncoded];
+}
+
+
+} // namespace kernels
+} // namespace detail
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,86 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+namespace kernels {
+
+
+/// \brief The instruction sets the conversion kernels can be dispatched to.
+///
+/// `Scalar` designates the generic code paths, going pixel by pixel through the math library.
+enum class SimdLevel
+{
+    Scalar,
+    Sse,  // SSE2 + SSSE3
+    Avx2, // AVX2 + F16C
+};
+
+
+/// \brief The best level supported by the executing CPU, detected once.
+SimdLevel detectSimdLevel();
+
+/// \brief The level currently used by the conversion functions (defaults to the detected level).
+SimdLevel getSimdLevel();
+
+/// \brief Restrict the conversion functions to `aLevel`, notably to compare against the scalar paths.
+/// \return The level actually in effect, which is never above the detected level.
+SimdLevel setSimdLevel(SimdLevel aLevel);
+
+
+// Each kernel processes a contiguous run of `aCount` elements (channels, unless stated otherwise),
+// with the instruction set selected by getSimdLevel().
+// The pointers do not need to be aligned.
+
+/// \brief Average the 3 channels of `aCount` packed RGB pixels, truncating as integer division.
+void averageRgbToGray(const std::uint8_t * aRgb, std::uint8_t * aGray, std::size_t aCount);
+
+/// \brief Map [0, 255] channels to [0.f, 1.f], as `value / 255.f`.
+void unormToFloat(const std::uint8_t * aSource, float * aDestination, std::size_t aCount);
+
+/// \brief Clamp channels to [0.f, 1.f], and map them to [0, 255] rounding to nearest.
+void floatToUnorm(const float * aSource, std::uint8_t * aDestination, std::size_t aCount);
+
+/// \brief Encode linear channels in [0.f, 1.f] to 8-bit sRGB (values outside of the range are clamped).
+///
+/// The transfer function is approximated by a polynomial in successive square roots,
+/// which is within a quarter of a quantization step of the exact curve.
+void encodeSRGB(const float * aLinear, std::uint8_t * aEncoded, std::size_t aCount);
+
+/// \brief Convert float channels to IEEE 754 half-floats, rounding to nearest even.
+void floatToHalf(const float * aSource, std::uint16_t * aDestination, std::size_t aCount);
+
+/// \brief Convert IEEE 754 half-float channels to float, which is exact.
+void halfToFloat(const std::uint16_t * aSource, float * aDestination, std::size_t aCount);
+
+/// \brief For each of the 16 RGBA pixels of `aBlock`, write to `aIndices` the index of the closest
+/// of the `aPaletteSize` RGBA colors in `aPalette` (by squared distance, the lowest index on ties).
+/// \return The sum of the squared distances of the pixels to their selected color.
+/// \note Unlike the other kernels, it processes a fixed count of pixels: a 4x4 block of block compression.
+std::uint32_t selectPaletteIndices(const std::uint8_t * aBlock,
+                                   const std::uint8_t * aPalette,
+                                   int aPaletteSize,
+                                   std::uint8_t * aIndices);
+
+/// \brief Index of the first of the `aCount` RGBA pixels whose alpha is not zero, or `aCount` if they are
+/// all fully transparent.
+std::size_t findFirstVisible(const std::uint8_t * aRgba, std::size_t aCount);
+
+/// \brief One past the index of the last of the `aCount` RGBA pixels whose alpha is not zero, or 0 if they are
+/// all fully transparent.
+std::size_t findVisibleEnd(const std::uint8_t * aRgba, std::size_t aCount);
+
+/// \brief Exact decoding of the 8-bit sRGB value `aEncoded` to a linear value in [0.f, 1.f].
+/// It is read from a 256-entry table.
+float decodeSRGB(std::uint8_t aEncoded);
+
+
+} // namespace kernels
+} // namespace detail
+} // namespace arte
+} // namespace ad
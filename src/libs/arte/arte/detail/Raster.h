@@ -0,0 +1,89 @@
+#pragma once
+
+
+#include "../RasterAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief Alignment of the first byte of rasters allocated by Image.
+///
+/// It is large enough for aligned AVX-512 loads, and matches the usual cache line size.
+/// When the rows are padded to a multiple of this value, each row starts on such a boundary.
+constexpr std::size_t gRasterAlignment = 64;
+
+
+namespace detail {
+
+
+    struct RasterDeleter
+    {
+        void operator()(unsigned char * aRaster) const
+        {
+            if (mAllocator == nullptr)
+            {
+                delete [] aRaster;
+            }
+            else
+            {
+                mAllocator->deallocate(aRaster, mSizeBytes);
+            }
+        }
+
+        /// \brief nullptr when the raster was allocated via plain `new []` (see adoptRaster()).
+        RasterAllocator * mAllocator{nullptr};
+        std::size_t mSizeBytes{0};
+    };
+
+
+    using Raster = std::unique_ptr<unsigned char[], RasterDeleter>;
+
+
+    inline Raster allocateRaster(std::size_t aSizeBytes,
+                                 RasterAllocator & aAllocator = currentRasterAllocator())
+    {
+        return Raster{
+            aAllocator.allocate(aSizeBytes),
+            RasterDeleter{&aAllocator, aSizeBytes},
+        };
+    }
+
+
+    /// \brief Take ownership of a raster of `aSizeBytes` allocated via plain `new []` (e.g. by the image loaders).
+    ///
+    /// Such rasters are only aligned for fundamental types. When `aRaster` does not start on
+    /// a gRasterAlignment boundary, it is copied into a raster from the current allocator, so all
+    /// Image rasters keep the same alignment guarantee.
+    inline Raster adoptRaster(std::unique_ptr<unsigned char[]> aRaster, std::size_t aSizeBytes)
+    {
+        if (reinterpret_cast<std::uintptr_t>(aRaster.get()) % gRasterAlignment == 0)
+        {
+            return Raster{aRaster.release()};
+        }
+
+        Raster aligned = allocateRaster(aSizeBytes);
+        std::copy_n(aRaster.get(), aSizeBytes, aligned.get());
+        return aligned;
+    }
+
+
+    /// \brief Return the smallest multiple of `aRowAlignment` able to hold `aLineBytes`.
+    inline std::size_t computeStride(std::size_t aLineBytes, std::size_t aRowAlignment)
+    {
+        // Must be a power of 2
+        assert(aRowAlignment != 0 && (aRowAlignment & (aRowAlignment - 1)) == 0);
+        return (aLineBytes + aRowAlignment - 1) & ~(aRowAlignment - 1);
+    }
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,89 @@
+#pragma once
+
+
+#include <platform/Filesystem.h>
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+namespace sheetcache {
+
+
+// The binary cache of a sprite sheet is laid out as:
+//   Header | Frame[mFrameCount] | strings | raster (tightly packed RGBA rows, in the loaded orientation)
+// The structures are copied as is: the cache is local to a machine and is never distributed.
+// The sheet name is not stored, it is given by the data file the cache is associated to.
+
+
+constexpr std::array<char, 8> gMagic{'A', 'D', 'S', 'H', 'E', 'E', 'T', '\0'};
+constexpr std::uint32_t gVersion = 2;
+
+
+/// \brief Identifies the state of a source file, so the cache is rebuilt when the source changes.
+struct SourceStamp
+{
+    bool operator==(const SourceStamp &) const = default;
+
+    std::int64_t mModificationTime;
+    std::uint64_t mSize;
+};
+
+
+inline SourceStamp getSourceStamp(const filesystem::path & aFile)
+{
+    return {
+        static_cast<std::int64_t>(filesystem::last_write_time(aFile).time_since_epoch().count()),
+        static_cast<std::uint64_t>(filesystem::file_size(aFile)),
+    };
+}
+
+
+/// \brief A range of characters in the strings section.
+struct StringRef
+{
+    std::uint32_t mOffset;
+    std::uint32_t mSize;
+};
+
+
+struct Header
+{
+    std::array<char, 8> mMagic;
+    std::uint32_t mVersion;
+    std::uint32_t mFrameCount;
+    SourceStamp mDataStamp;
+    SourceStamp mImageStamp;
+    float mScale;
+    std::int32_t mWidth;
+    std::int32_t mHeight;
+    /// \brief Path of the sheet image, relative to the folder of the data file.
+    StringRef mImagePath;
+    std::uint64_t mFramesOffset{0};
+    std::uint64_t mStringsOffset{0};
+    std::uint64_t mStringsSize{0};
+    std::uint64_t mRasterOffset{0};
+};
+
+
+struct Frame
+{
+    StringRef mName;
+    std::array<std::int32_t, 4> mArea; // x, y, width, height
+    std::array<std::int32_t, 2> mTrimOffset;
+    std::array<std::int32_t, 2> mSourceSize;
+    float mDuration; // 0 for sheets without durations
+};
+
+
+static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<Frame>);
+
+
+} // namespace sheetcache
+} // namespace detail
+} // namespace arte
+} // namespace ad
@@ -8,6 +8,8 @@
 #include <math/Transformations.h>
 
 #include <fstream>
+#include <string_view>
+#include <type_traits>
 
 
 namespace ad {
@@ -227,7 +229,7 @@ std::vector<T_index> makeIndicesVector(const Json & aArray)
 
 // Note: Could not find a way to achieve it directly with json.value
 template <class T_value, class T_tag>
-std::optional<T_value> getOptional(Json aObject, T_tag && aTag)
+std::optional<T_value> getOptional(const Json & aObject, T_tag && aTag)
 {
     if (aObject.contains(std::forward<T_tag>(aTag)))
     {
@@ -251,7 +253,7 @@ template <class T_object, class ... VT_args>
 T_object load(const Json & aObjectJson, VT_args && ... vaArgs);
 
 template <class T_value, class T_tag>
-std::optional<T_value> loadOptional(Json aObject, T_tag && aTag)
+std::optional<T_value> loadOptional(const Json & aObject, T_tag && aTag)
 {
     if (aObject.contains(std::forward<T_tag>(aTag)))
     {
@@ -264,22 +266,14 @@ std::optional<T_value> loadOptional(Json aObject, T_tag && aTag)
 template <class T_object, class T_tag, class ... VT_args>
 void populateVector(const Json & aJson, std::vector<T_object> & aVector, T_tag && aTag, VT_args && ... vaArgs)
 {
-    aVector.reserve(aJson.at(std::forward<T_tag>(aTag)).size());
-    for (auto object : aJson.at(aTag))
+    const Json & array = aJson.at(std::forward<T_tag>(aTag));
+    aVector.reserve(array.size());
+    for (const Json & object : array)
     {
         aVector.push_back(load<T_object>(object, std::forward<VT_args>(vaArgs)...));
     }
 }
 
-template <class T_object, class T_tag, class ... VT_args>
-void populateVectorIfPresent(const Json & aJson, std::vector<T_object> & aVector, T_tag && aTag, VT_args && ... vaArgs)
-{
-    if(aJson.contains(aTag))
-    {
-        populateVector(aJson, aVector, aTag, std::forward<VT_args>(vaArgs)...);
-    }
-}
-
 
 
 
@@ -330,10 +324,10 @@ Primitive load(const Json & aPrimitiveObject)
 {
     return Primitive{
         .mode = aPrimitiveObject.value<EnumType>(gTagMode, 4), // 4 is the default mode
-        .attributes = [attributes = aPrimitiveObject.at(gTagAttributes)]()
+        .attributes = [&attributes = aPrimitiveObject.at(gTagAttributes)]()
             {
                 std::map<std::string, Index<Accessor>> result;
-                for (auto attribute : attributes.items())
+                for (const auto & attribute : attributes.items())
                 {
                     result.emplace(attribute.key(), attribute.value().get<Index<Accessor>::Value_t>());
                 }
@@ -349,7 +343,7 @@ template <>
 Mesh load(const Json & aMeshObject)
 {
     std::vector<Primitive> primitives;
-    for (auto primitive : aMeshObject.at(gTagPrimitives))
+    for (const Json & primitive : aMeshObject.at(gTagPrimitives))
     {
         primitives.push_back(load<Primitive>(primitive));
     }
@@ -480,7 +474,7 @@ Animation load(const Json & aJson)
 template <>
 animation::Channel load(const Json & aJson)
 {
-    Json target = aJson.at(gTagTarget);
+    const Json & target = aJson.at(gTagTarget);
 
     return {
         .sampler = aJson.at(gTagSampler).get<Index<animation::Sampler>>(),
@@ -626,21 +620,15 @@ texture::Sampler load(const Json & aJson)
 
 
 template <>
-Skin load(const Json & aJson, Gltf & aGltf)
+Skin load(const Json & aJson)
 {
-    Skin result{
+    // The joint nodes are marked by Gltf constructor, once all nodes are loaded.
+    return {
         .name = aJson.value(gTagName, ""),
         .inverseBindMatrices = getOptional<Index<Accessor>>(aJson, gTagInverseBindMatrices),
         .skeleton = getOptional<Index<Node>>(aJson, gTagSkeleton),
         .joints = makeIndicesVector<Index<Node>>(getOptionalArray(aJson, gTagJoints)),
     };
-
-    for (auto joint : result.joints)
-    {
-        aGltf.get(joint)->usedAsJoint = true;
-    }
-
-    return result;
 }
 
 
@@ -656,7 +644,7 @@ Camera load(const Json & aJson)
     {
     case Camera::Type::Orthographic:
     {
-        auto proj = aJson.at(gTagOrthographic);
+        const Json & proj = aJson.at(gTagOrthographic);
         result.projection = Camera::Orthographic{
             .xmag = proj.at(gTagXMag),
             .ymag = proj.at(gTagYMag),
@@ -667,7 +655,7 @@ Camera load(const Json & aJson)
     }
     case Camera::Type::Perspective:
     {
-        auto proj = aJson.at(gTagPerspective);
+        const Json & proj = aJson.at(gTagPerspective);
         result.projection = Camera::Perspective{
             .aspectRatio = getOptional<float>(proj, gTagAspectRatio),
             .yfov = proj.at(gTagYFov),
@@ -758,25 +746,51 @@ namespace gltf {
 Gltf::Gltf(const filesystem::path & aGltfJson) :
     mPath{aGltfJson}
 {
+    auto consume = [](auto & aVector, const Json & aElement)
+    {
+        aVector.push_back(load<typename std::remove_reference_t<decltype(aVector)>::value_type>(aElement));
+        return true;
+    };
+
+    // Each element of the top-level arrays is loaded as soon as it is parsed, then discarded:
+    // the DOM of the whole document is never materialized.
     std::ifstream jsonInput{aGltfJson.string()};
-    Json json;
-    jsonInput >> json;
+    Json json = detail::parseConsumingElements(
+        jsonInput,
+        [&](std::string_view aCollection, const Json & aElement) -> bool
+        {
+            if      (aCollection == gTagScenes)      return consume(mScenes, aElement);
+            else if (aCollection == gTagNodes)       return consume(mNodes, aElement);
+            else if (aCollection == gTagMeshes)      return consume(mMeshes, aElement);
+            else if (aCollection == gTagAnimations)  return consume(mAnimations, aElement);
+            else if (aCollection == gTagBuffers)     return consume(mBuffers, aElement);
+            else if (aCollection == gTagBufferViews) return consume(mBufferViews, aElement);
+            else if (aCollection == gTagAccessors)   return consume(mAccessors, aElement);
+            else if (aCollection == gTagMaterials)   return consume(mMaterials, aElement);
+            else if (aCollection == gTagImages)      return consume(mImages, aElement);
+            else if (aCollection == gTagTextures)    return consume(mTextures, aElement);
+            else if (aCollection == gTagSamplers)    return consume(mSamplers, aElement);
+            else if (aCollection == gTagSkins)       return consume(mSkins, aElement);
+            else if (aCollection == gTagCameras)     return consume(mCameras, aElement);
+            return false;
+        });
+
+    // The required arrays remain in the document (empty), so their absence is still an error.
+    for (const char * required : {gTagScenes, gTagNodes, gTagMeshes, gTagBuffers, gTagBufferViews, gTagAccessors})
+    {
+        json.at(required);
+    }
 
     mDefaultScene = getOptional<Index<Scene>>(json, gTagScene);
 
-    populateVector(json, mScenes, gTagScenes);
-    populateVector(json, mNodes, gTagNodes);
-    populateVector(json, mMeshes, gTagMeshes);
-    populateVectorIfPresent(json, mAnimations, gTagAnimations);
-    populateVector(json, mBuffers, gTagBuffers);
-    populateVector(json, mBufferViews, gTagBufferViews);
-    populateVector(json, mAccessors, gTagAccessors);
-    populateVectorIfPresent(json, mMaterials, gTagMaterials);
-    populateVectorIfPresent(json, mImages, gTagImages);
-    populateVectorIfPresent(json, mTextures, gTagTextures);
-    populateVectorIfPresent(json, mSamplers, gTagSamplers);
-    populateVectorIfPresent(json, mSkins, gTagSkins, *this);
-    populateVectorIfPresent(json, mCameras, gTagCameras);
+    // Skins can appear before the nodes in the document.
+    for (const Skin & skin : mSkins)
+    {
+        for (Index<Node> joint : skin.joints)
+        {
+            mNodes.at(joint).usedAsJoint = true;
+        }
+    }
 
     ADLOG(gMainLogger, info)("Loaded glTF file with {} scene(s), {} node(s), {} meshe(s), {} material(s), {} animation(s), {} skin(s), {} camera(s), {} buffer(s).",
                              mScenes.size(), mNodes.size(), mMeshes.size(), mMaterials.size(), mAnimations.size(), mSkins.size(), mCameras.size(), mBuffers.size());
@@ -0,0 +1,210 @@
+#include "AnimatedSpriting.h"
+
+#include "shaders.h"
+
+#include "detail/UnitQuad.h"
+
+#include <renderer/BufferLoad.h>
+#include <renderer/Texture.h>
+#include <renderer/Uniforms.h>
+
+#include <math/Transformations.h>
+
+#include <array>
+#include <bit>
+#include <vector>
+
+
+namespace ad {
+namespace graphics {
+
+
+namespace {
+
+
+VertexSpecification makeQuad()
+{
+    VertexSpecification specification = detail::make_SpriteQuad();
+
+    // Per-instance attributes
+    specification.mVertexBuffers.push_back(
+        initVertexBuffer<AnimatedSpriting::Instance>(
+            specification.mVertexArray,
+            {
+                // Model transform
+                { 2, {3, offsetof(AnimatedSpriting::Instance, mModelTransform) + 0 * sizeof(GLfloat), MappedGL<GLfloat>::enumerator}},
+                { 3, {3, offsetof(AnimatedSpriting::Instance, mModelTransform) + 3 * sizeof(GLfloat), MappedGL<GLfloat>::enumerator}},
+                { 4, {3, offsetof(AnimatedSpriting::Instance, mModelTransform) + 6 * sizeof(GLfloat), MappedGL<GLfloat>::enumerator}},
+                { {5, ShaderParameter::Access::Integer}, {1, offsetof(AnimatedSpriting::Instance, mAnimation),     MappedGL<GLint>::enumerator}},
+                { 6,                                     {1, offsetof(AnimatedSpriting::Instance, mStartTime),     MappedGL<GLfloat>::enumerator}},
+                { 7,                                     {1, offsetof(AnimatedSpriting::Instance, mSpeed),         MappedGL<GLfloat>::enumerator}},
+                { {8, ShaderParameter::Access::Integer}, {1, offsetof(AnimatedSpriting::Instance, mRepeat),        MappedGL<GLint>::enumerator}},
+                { 9,                                     {1, offsetof(AnimatedSpriting::Instance, mOpacity),       MappedGL<GLfloat>::enumerator}},
+                { 10,                                    {2, offsetof(AnimatedSpriting::Instance, mAxisMirroring), MappedGL<GLint>::enumerator}},
+            },
+            1
+        ));
+
+    return specification;
+}
+
+
+Program makeProgram()
+{
+    Program program = makeLinkedProgram({
+                          {GL_VERTEX_SHADER,   gAnimatedSpriteVertexShader},
+                          {GL_FRAGMENT_SHADER, gAnimationFragmentShader},
+                      });
+
+    setUniform(program, "spriteSampler",   AnimatedSpriting::gTextureUnit);
+    setUniform(program, "u_animations",    AnimatedSpriting::gAnimationsTextureUnit);
+    setUniform(program, "u_frameEndTimes", AnimatedSpriting::gFrameEndTimesTextureUnit);
+    setUniform(program, "u_frameSprites",  AnimatedSpriting::gFrameSpritesTextureUnit);
+
+    return program;
+}
+
+
+} // anonymous namespace
+
+
+AnimatedSpriting::Instance::Instance(math::AffineMatrix<3, GLfloat> aModelTransform,
+                                     sprite::AnimationHandle aAnimation,
+                                     GLfloat aStartTime,
+                                     GLfloat aSpeed,
+                                     Playback aPlayback,
+                                     GLfloat aOpacity,
+                                     Mirroring aMirroring) :
+    mModelTransform{aModelTransform},
+    mAnimation{static_cast<GLint>(aAnimation.mIndex)},
+    mStartTime{aStartTime},
+    mSpeed{aSpeed},
+    mRepeat{aPlayback == Playback::Repeat ? 1 : 0},
+    mOpacity{aOpacity},
+    mAxisMirroring{
+        (test(aMirroring, Mirroring::FlipHorizontal) ? -1 : 1),
+        (test(aMirroring, Mirroring::FlipVertical) ? -1 : 1)
+    }
+{}
+
+
+AnimatedSpriting::Instance::Instance(Position2<GLfloat> aRenderingPosition,
+                                     sprite::AnimationHandle aAnimation,
+                                     GLfloat aStartTime,
+                                     GLfloat aSpeed,
+                                     Playback aPlayback,
+                                     GLfloat aOpacity,
+                                     Mirroring aMirroring) :
+    Instance{math::trans2d::translate(aRenderingPosition.as<math::Vec>()),
+             aAnimation,
+             aStartTime,
+             aSpeed,
+             aPlayback,
+             aOpacity,
+             aMirroring}
+{}
+
+
+AnimatedSpriting::AnimatedSpriting(GLfloat aPixelSize) :
+        mVertexSpecification{makeQuad()},
+        mProgram{makeProgram()}
+{
+    setPixelWorldSize(aPixelSize);
+    setTime(0.f);
+
+    setCameraTransformation(math::AffineMatrix<3, GLfloat>::Identity());
+    setProjectionTransformation(math::AffineMatrix<3, GLfloat>::Identity());
+}
+
+
+void AnimatedSpriting::loadAnimations(const sprite::Animator & aAnimator)
+{
+    using Texel = std::array<GLint, 4>;
+
+    // The floating point values stored in integer texels are reinterpreted by the shader.
+    std::vector<Texel> animations;
+    std::vector<GLfloat> frameEndTimes;
+    std::vector<Texel> frameSprites;
+    for (const sprite::Animation & animation : aAnimator.getAnimations())
+    {
+        animations.push_back({
+            static_cast<GLint>(frameEndTimes.size()),
+            static_cast<GLint>(animation.frames.size()),
+            std::bit_cast<GLint>(static_cast<GLfloat>(animation.totalDuration)),
+            std::bit_cast<GLint>(static_cast<GLfloat>(animation.uniformFrameDuration)),
+        });
+
+        for (const sprite::Animation::Frame & frame : animation.frames)
+        {
+            const LoadedSprite & area = frame.loadedSprite;
+            frameEndTimes.push_back(frame.endTime);
+            frameSprites.push_back({area.x(), area.y(), area.width(), area.height()});
+            frameSprites.push_back({frame.trim.offset.x(), frame.trim.offset.y(),
+                                    frame.trim.sourceSize.width(), frame.trim.sourceSize.height()});
+        }
+    }
+
+    load(mAnimations.mBuffer, std::span{animations}, BufferHint::StaticDraw);
+    attachBuffer(mAnimations, GL_RGBA32I);
+    load(mFrameEndTimes.mBuffer, std::span{frameEndTimes}, BufferHint::StaticDraw);
+    attachBuffer(mFrameEndTimes, GL_R32F);
+    load(mFrameSprites.mBuffer, std::span{frameSprites}, BufferHint::StaticDraw);
+    attachBuffer(mFrameSprites, GL_RGBA32I);
+}
+
+
+void AnimatedSpriting::updateInstances(std::span<const Instance> aInstances)
+{
+    respecifyBuffer(mVertexSpecification.mVertexBuffers.back(),
+                    aInstances,
+                    BufferHint::StreamDraw);
+    mInstanceCount = static_cast<GLsizei>(aInstances.size());
+}
+
+
+void AnimatedSpriting::render(const sprite::LoadedAtlas & aAtlas) const
+{
+    activate(mVertexSpecification, mProgram);
+
+    auto unitGuard = scopeTextureUnitActivation(gTextureUnit);
+    ScopedBind scopedTexture{*aAtlas.texture};
+    auto animationsUnitGuard = scopeTextureUnitActivation(gAnimationsTextureUnit);
+    ScopedBind scopedAnimations{mAnimations.mTexture};
+    auto frameEndTimesUnitGuard = scopeTextureUnitActivation(gFrameEndTimesTextureUnit);
+    ScopedBind scopedFrameEndTimes{mFrameEndTimes.mTexture};
+    auto frameSpritesUnitGuard = scopeTextureUnitActivation(gFrameSpritesTextureUnit);
+    ScopedBind scopedFrameSprites{mFrameSprites.mTexture};
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP,
+                          0,
+                          detail::gQuadVerticeCount,
+                          mInstanceCount);
+}
+
+
+void AnimatedSpriting::setTime(GLfloat aTime)
+{
+    setUniform(mProgram, "u_time", aTime);
+}
+
+
+void AnimatedSpriting::setPixelWorldSize(GLfloat aPixelSize)
+{
+    setUniform(mProgram, "u_pixelWorldSize", math::Vec<2, GLfloat>{aPixelSize, aPixelSize});
+}
+
+
+void AnimatedSpriting::setCameraTransformation(const math::AffineMatrix<3, GLfloat> & aTransformation)
+{
+    setUniform(mProgram, "u_camera", aTransformation);
+}
+
+
+void AnimatedSpriting::setProjectionTransformation(const math::Matrix<3, 3, GLfloat> & aTransformation)
+{
+    setUniform(mProgram, "u_projection", aTransformation);
+}
+
+
+} // namespace graphics
+} // namespace ad
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "commons.h"
+
+#include "SpriteAnimator.h"
+#include "SpriteLoading.h"
+
+#include <math/Homogeneous.h>
+
+#include <renderer/Drawing.h>
+#include <renderer/TextureBuffer.h>
+
+#include <glad/glad.h>
+
+#include <span>
+
+
+namespace ad {
+namespace graphics {
+
+
+/// \brief Draws animated sprites, whose current frame is selected by the vertex shader from a time uniform.
+///
+/// The frame tables of the animations are loaded once from a `sprite::Animator`.
+/// Each instance designates its animation, with a start time and a speed:
+/// purely time-driven animations require no instance update, only `setTime()`.
+/// The frames are selected and rendered as `Spriting` does with the sprites of `sprite::Animator::at()`.
+class AnimatedSpriting
+{
+public:
+    enum class Playback
+    {
+        Once,   // the last frame is held once the animation is over
+        Repeat,
+    };
+
+    struct Instance
+    {
+        /// \param aStartTime The time (see `setTime()`) at which the animation local time is 0.
+        /// \param aSpeed Factor from time to the animation local time.
+        Instance(math::AffineMatrix<3, GLfloat> aModelTransform,
+                 sprite::AnimationHandle aAnimation,
+                 GLfloat aStartTime,
+                 GLfloat aSpeed = 1.f,
+                 Playback aPlayback = Playback::Repeat,
+                 GLfloat aOpacity = 1.f,
+                 Mirroring aMirroring = Mirroring::None);
+
+        Instance(Position2<GLfloat> aRenderingPosition,
+                 sprite::AnimationHandle aAnimation,
+                 GLfloat aStartTime,
+                 GLfloat aSpeed = 1.f,
+                 Playback aPlayback = Playback::Repeat,
+                 GLfloat aOpacity = 1.f,
+                 Mirroring aMirroring = Mirroring::None);
+
+        math::AffineMatrix<3, GLfloat> mModelTransform;
+        GLint mAnimation;
+        GLfloat mStartTime;
+        GLfloat mSpeed;
+        GLint mRepeat;
+        GLfloat mOpacity;
+        Vec2<int> mAxisMirroring;
+    };
+
+    AnimatedSpriting(GLfloat aPixelSize = 1.f);
+
+    /// \brief Load the frame tables of all animations in `aAnimator`, replacing the previous tables.
+    ///
+    /// The animations must be loaded again when animations are added to `aAnimator`.
+    /// \attention The atlas rendered must be the atlas where `aAnimator` loaded the frames.
+    void loadAnimations(const sprite::Animator & aAnimator);
+
+    void updateInstances(std::span<const Instance> aInstances);
+
+    /// \brief Set the time at which the animations are evaluated, in the unit of the animations durations.
+    ///
+    /// \note The time is single precision on the GPU: clients should keep it (and the instances start times)
+    /// relative to a recent origin, instead of letting it grow for the whole application lifetime.
+    void setTime(GLfloat aTime);
+
+    void render(const sprite::LoadedAtlas & aAtlas) const;
+
+    /// \brief Define the size of a pixel in world units.
+    void setPixelWorldSize(GLfloat aPixelSize);
+
+    void setCameraTransformation(const math::AffineMatrix<3, GLfloat> & aTransformation);
+    void setProjectionTransformation(const math::Matrix<3, 3, GLfloat> & aTransformation);
+
+
+    static constexpr GLint gTextureUnit{0};
+    static constexpr GLint gAnimationsTextureUnit{1};
+    static constexpr GLint gFrameEndTimesTextureUnit{2};
+    static constexpr GLint gFrameSpritesTextureUnit{3};
+
+private:
+    VertexSpecification mVertexSpecification;
+    Program  mProgram;
+    GLsizei mInstanceCount{0};
+
+    // The frame tables, read by the vertex shader (see gAnimatedSpriteVertexShader for their layout).
+    BufferTexture mAnimations;
+    BufferTexture mFrameEndTimes;
+    BufferTexture mFrameSprites;
+};
+
+
+} // namespace graphics
+} // namespace ad
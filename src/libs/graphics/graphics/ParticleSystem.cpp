@@ -0,0 +1,231 @@
+#include "ParticleSystem.h"
+
+#include <math/Transformations.h>
+
+#include <cassert>
+#include <initializer_list>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+// SSE2 is part of the x86-64 baseline, so it does not require runtime dispatch.
+#   define GRAPHICS_PARTICLES_SSE2
+#   include <emmintrin.h>
+#endif
+
+
+namespace ad {
+namespace graphics {
+
+
+namespace {
+
+
+    // Each kernel processes a contiguous run of `aCount` particles.
+    // The vector loops leave the tails which do not fill a complete vector to the scalar loops.
+
+
+    /// \brief Semi-implicit Euler step: the velocity is incremented by `aVelocityIncrement`,
+    /// then the position advances with the updated velocity.
+    void integrate(GLfloat * aPosition, GLfloat * aVelocity,
+                   GLfloat aVelocityIncrement, GLfloat aDeltaTime,
+                   std::size_t aCount)
+    {
+        std::size_t i = 0;
+#if defined(GRAPHICS_PARTICLES_SSE2)
+        const __m128 increment = _mm_set1_ps(aVelocityIncrement);
+        const __m128 deltaTime = _mm_set1_ps(aDeltaTime);
+        for (; i + 4 <= aCount; i += 4)
+        {
+            __m128 velocity = _mm_add_ps(_mm_loadu_ps(aVelocity + i), increment);
+            __m128 position = _mm_add_ps(_mm_loadu_ps(aPosition + i), _mm_mul_ps(velocity, deltaTime));
+            _mm_storeu_ps(aVelocity + i, velocity);
+            _mm_storeu_ps(aPosition + i, position);
+        }
+#endif
+        for (; i != aCount; ++i)
+        {
+            aVelocity[i] += aVelocityIncrement;
+            aPosition[i] += aVelocity[i] * aDeltaTime;
+        }
+    }
+
+
+    /// \brief Advance each value by its rate during `aDeltaTime`.
+    void advance(GLfloat * aValues, const GLfloat * aRates, GLfloat aDeltaTime, std::size_t aCount)
+    {
+        std::size_t i = 0;
+#if defined(GRAPHICS_PARTICLES_SSE2)
+        const __m128 deltaTime = _mm_set1_ps(aDeltaTime);
+        for (; i + 4 <= aCount; i += 4)
+        {
+            _mm_storeu_ps(aValues + i,
+                          _mm_add_ps(_mm_loadu_ps(aValues + i),
+                                     _mm_mul_ps(_mm_loadu_ps(aRates + i), deltaTime)));
+        }
+#endif
+        for (; i != aCount; ++i)
+        {
+            aValues[i] += aRates[i] * aDeltaTime;
+        }
+    }
+
+
+    void increment(GLfloat * aValues, GLfloat aIncrement, std::size_t aCount)
+    {
+        std::size_t i = 0;
+#if defined(GRAPHICS_PARTICLES_SSE2)
+        const __m128 increment = _mm_set1_ps(aIncrement);
+        for (; i + 4 <= aCount; i += 4)
+        {
+            _mm_storeu_ps(aValues + i, _mm_add_ps(_mm_loadu_ps(aValues + i), increment));
+        }
+#endif
+        for (; i != aCount; ++i)
+        {
+            aValues[i] += aIncrement;
+        }
+    }
+
+
+    /// \brief Return the first index from `aFirst` where the particle is dead, or `aCount` if there are none.
+    std::size_t findDead(const GLfloat * aAge, const GLfloat * aLifetime, std::size_t aFirst, std::size_t aCount)
+    {
+        std::size_t i = aFirst;
+#if defined(GRAPHICS_PARTICLES_SSE2)
+        // Skip the groups of particles which are all alive, the common case.
+        for (; i + 4 <= aCount; i += 4)
+        {
+            if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(aAge + i), _mm_loadu_ps(aLifetime + i))) != 0)
+            {
+                break;
+            }
+        }
+#endif
+        for (; i != aCount; ++i)
+        {
+            if (aAge[i] >= aLifetime[i])
+            {
+                return i;
+            }
+        }
+        return aCount;
+    }
+
+
+} // anonymous namespace
+
+
+ParticleSystem::ParticleSystem(std::size_t aCapacity, Vec2<GLfloat> aAcceleration, Fading aFading) :
+    mCapacity{aCapacity},
+    mAcceleration{aAcceleration},
+    mFading{aFading}
+{
+    for (std::vector<GLfloat> * column : {&mPositionX, &mPositionY, &mVelocityX, &mVelocityY,
+                                          &mAngle, &mAngularVelocity, &mAge, &mLifetime})
+    {
+        column->reserve(mCapacity);
+    }
+    mSprite.reserve(mCapacity);
+}
+
+
+bool ParticleSystem::emit(const Emission & aEmission)
+{
+    if (size() == mCapacity)
+    {
+        return false;
+    }
+
+    mPositionX.push_back(aEmission.mPosition.x());
+    mPositionY.push_back(aEmission.mPosition.y());
+    mVelocityX.push_back(aEmission.mVelocity.x());
+    mVelocityY.push_back(aEmission.mVelocity.y());
+    mAngle.push_back(aEmission.mAngle);
+    mAngularVelocity.push_back(aEmission.mAngularVelocity);
+    mAge.push_back(0.f);
+    mLifetime.push_back(aEmission.mLifetime);
+    mSprite.push_back(aEmission.mSprite);
+    return true;
+}
+
+
+void ParticleSystem::update(GLfloat aDeltaTime)
+{
+    const std::size_t count = size();
+
+    integrate(mPositionX.data(), mVelocityX.data(), mAcceleration.x() * aDeltaTime, aDeltaTime, count);
+    integrate(mPositionY.data(), mVelocityY.data(), mAcceleration.y() * aDeltaTime, aDeltaTime, count);
+    advance(mAngle.data(), mAngularVelocity.data(), aDeltaTime, count);
+    increment(mAge.data(), aDeltaTime, count);
+
+    // The particle moved in place of a removed particle has to be tested too,
+    // so the search resumes at the removed index.
+    for (std::size_t dead = findDead(mAge.data(), mLifetime.data(), 0, size());
+         dead != size();
+         dead = findDead(mAge.data(), mLifetime.data(), dead, size()))
+    {
+        remove(dead);
+    }
+}
+
+
+void ParticleSystem::remove(std::size_t aIndex)
+{
+    auto moveLast = [aIndex](auto & aColumn)
+    {
+        aColumn[aIndex] = aColumn.back();
+        aColumn.pop_back();
+    };
+
+    moveLast(mPositionX);
+    moveLast(mPositionY);
+    moveLast(mVelocityX);
+    moveLast(mVelocityY);
+    moveLast(mAngle);
+    moveLast(mAngularVelocity);
+    moveLast(mAge);
+    moveLast(mLifetime);
+    moveLast(mSprite);
+}
+
+
+void ParticleSystem::writeInstances(std::span<Spriting::Instance> aInstances) const
+{
+    assert(aInstances.size() == size());
+
+    for (std::size_t i = 0; i != aInstances.size(); ++i)
+    {
+        const GLfloat opacity = (mFading == Fading::Linear) ? 1.f - mAge[i] / mLifetime[i] : 1.f;
+        std::construct_at(
+            &aInstances[i],
+            math::trans2d::rotate(math::Radian<GLfloat>{mAngle[i]})
+                * math::trans2d::translate(math::Vec<2, GLfloat>{mPositionX[i], mPositionY[i]}),
+            mSprite[i],
+            opacity);
+    }
+}
+
+
+void ParticleSystem::writeInstances(Spriting & aSpriting) const
+{
+    aSpriting.writeInstances(size(),
+                             [this](std::span<Spriting::Instance> aInstances)
+                             {
+                                 writeInstances(aInstances);
+                             });
+}
+
+
+void ParticleSystem::clear()
+{
+    for (std::vector<GLfloat> * column : {&mPositionX, &mPositionY, &mVelocityX, &mVelocityY,
+                                          &mAngle, &mAngularVelocity, &mAge, &mLifetime})
+    {
+        column->clear();
+    }
+    mSprite.clear();
+}
+
+
+} // namespace graphics
+} // namespace ad
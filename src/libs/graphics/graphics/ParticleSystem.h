@@ -0,0 +1,97 @@
+#pragma once
+
+#include "commons.h"
+
+#include "Sprite.h"
+#include "Spriting.h"
+
+#include <glad/glad.h>
+
+#include <span>
+#include <vector>
+
+
+namespace ad {
+namespace graphics {
+
+
+/// \brief Simulates short-lived sprites (sparks, debris, ...), rendered as `Spriting` instances.
+///
+/// The particles are stored as a structure of arrays, allocated once for the capacity:
+/// updating a given attribute of all particles is a loop over a contiguous array, which is vectorized.
+/// Dead particles are removed by moving the last particle in their place, so the order of particles
+/// is not stable.
+class ParticleSystem
+{
+public:
+    enum class Fading
+    {
+        None,
+        Linear, // opacity goes from 1 at emission to 0 at the end of the lifetime
+    };
+
+    struct Emission
+    {
+        Position2<GLfloat> mPosition;
+        Vec2<GLfloat> mVelocity;
+        GLfloat mLifetime;
+        TrimmedSprite mSprite;
+        GLfloat mAngle{0.f}; // in radians
+        GLfloat mAngularVelocity{0.f};
+    };
+
+    /// \param aCapacity The maximal number of live particles, the storage is never reallocated.
+    /// \param aAcceleration Uniformly applied to all particles (e.g. gravity).
+    explicit ParticleSystem(std::size_t aCapacity,
+                            Vec2<GLfloat> aAcceleration = {0.f, 0.f},
+                            Fading aFading = Fading::Linear);
+
+    /// \return false if the system is at capacity, in which case the particle is not emitted.
+    bool emit(const Emission & aEmission);
+
+    /// \brief Advance all particles by `aDeltaTime`, then remove the particles which reached their lifetime.
+    void update(GLfloat aDeltaTime);
+
+    /// \brief Write the live particles into `aInstances`, which must be exactly `size()` long.
+    ///
+    /// The instances are constructed in place, so `aInstances` might be uninitialized memory.
+    void writeInstances(std::span<Spriting::Instance> aInstances) const;
+
+    /// \brief Write the live particles directly into the instance buffer of `aSpriting`.
+    void writeInstances(Spriting & aSpriting) const;
+
+    void clear();
+
+    std::size_t size() const
+    { return mAge.size(); }
+
+    std::size_t capacity() const
+    { return mCapacity; }
+
+    void setAcceleration(Vec2<GLfloat> aAcceleration)
+    { mAcceleration = aAcceleration; }
+
+private:
+    /// \brief Move the last particle to `aIndex`, replacing the particle there.
+    void remove(std::size_t aIndex);
+
+    std::size_t mCapacity;
+    Vec2<GLfloat> mAcceleration;
+    Fading mFading;
+
+    // Hot attributes, read and written by each update.
+    std::vector<GLfloat> mPositionX;
+    std::vector<GLfloat> mPositionY;
+    std::vector<GLfloat> mVelocityX;
+    std::vector<GLfloat> mVelocityY;
+    std::vector<GLfloat> mAngle;
+    std::vector<GLfloat> mAngularVelocity;
+    std::vector<GLfloat> mAge;
+    std::vector<GLfloat> mLifetime;
+    // Cold attribute, only read when writing the instances.
+    std::vector<TrimmedSprite> mSprite;
+};
+
+
+} // namespace graphics
+} // namespace ad
@@ -26,5 +26,28 @@ using SpriteArea = arte::SpriteArea;
 using LoadedSprite = SpriteArea;
 
 
+// Placement of a trimmed sprite in its untrimmed frame.
+using SpriteTrim = arte::FrameTrim;
+
+
+/// \brief A loaded sprite, with the trim to render it at the place of its untrimmed frame.
+struct TrimmedSprite
+{
+    /// \brief An untrimmed sprite.
+    /*implicit*/ TrimmedSprite(LoadedSprite aLoadedSprite) :
+        mLoadedSprite{aLoadedSprite},
+        mTrim{.sourceSize = aLoadedSprite.dimension()}
+    {}
+
+    TrimmedSprite(LoadedSprite aLoadedSprite, SpriteTrim aTrim) :
+        mLoadedSprite{aLoadedSprite},
+        mTrim{aTrim}
+    {}
+
+    LoadedSprite mLoadedSprite;
+    SpriteTrim mTrim;
+};
+
+
 } // namespace graphics
 } // namespace ad
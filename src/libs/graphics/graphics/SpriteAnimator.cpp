@@ -2,55 +2,112 @@
 
 #include "Spriting.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
 
 namespace ad {
 namespace graphics {
 namespace sprite {
 
 
-LoadedSprite Animation::at(Duration_t aLocalTime) const
+Animation::Animation(Duration_t aTotalDuration, std::vector<Frame> aFrames) :
+    totalDuration{aTotalDuration},
+    frames{std::move(aFrames)}
 {
-    auto frameIt = frames.begin();
-    for (; frameIt != (frames.end() - 1); ++frameIt)
+    assert(!frames.empty());
+
+    const Duration_t firstDuration = frames.front().endTime;
+    for (std::size_t index = 1; index != frames.size(); ++index)
     {
-        if (frameIt->endTime >= aLocalTime) break;
+        if (frames[index].endTime - frames[index - 1].endTime != firstDuration)
+        {
+            return;
+        }
     }
-    return frameIt->loadedSprite;
+    uniformFrameDuration = firstDuration;
+}
+
+
+std::size_t Animation::frameIndexAt(Duration_t aLocalTime) const
+{
+    const std::size_t lastIndex = frames.size() - 1;
+
+    // No end time compares greater or equal to NaN: as with a linear scan, it maps to the last frame.
+    if (std::isnan(aLocalTime))
+    {
+        return lastIndex;
+    }
+
+    if (uniformFrameDuration > 0)
+    {
+        if (aLocalTime <= 0)
+        {
+            return 0;
+        }
+        // Fixed step: guess the index, then correct the rounding errors against the actual end times.
+        const Duration_t guess = std::ceil(aLocalTime / uniformFrameDuration) - 1;
+        std::size_t index = guess < (Duration_t)lastIndex ? (std::size_t)std::max(guess, Duration_t{0}) : lastIndex;
+        if (index > 0 && frames[index - 1].endTime >= aLocalTime)
+        {
+            --index;
+        }
+        else if (index < lastIndex && frames[index].endTime < aLocalTime)
+        {
+            ++index;
+        }
+        return index;
+    }
+
+    // The last frame is excluded from the search, it is the result if no other frame matches.
+    auto found = std::lower_bound(frames.begin(), frames.begin() + lastIndex, aLocalTime,
+                                  [](const Frame & aFrame, Duration_t aTime)
+                                  {
+                                      return aFrame.endTime < aTime;
+                                  });
+    return found - frames.begin();
 }
 
 
 void Animator::insertAnimationFrames(const arte::AnimationSpriteSheet & aSpriteSheet,
-                                     math::Vec<2, int> aTextureOffset)
+                                     std::span<const LoadedSprite> aLoadedFrames)
 {
     // Should not load empty sprite sheets.
     assert(aSpriteSheet.cbegin() != aSpriteSheet.cend());
+    assert(aLoadedFrames.size() == (std::size_t)std::distance(aSpriteSheet.cbegin(), aSpriteSheet.cend()));
 
     std::vector<Animation::Frame> animationFrames;
     Animation::Duration_t durationAccumulator = 0;
+    auto loadedIt = aLoadedFrames.begin();
     std::for_each(aSpriteSheet.cbegin(), aSpriteSheet.cend(),
         [&](const arte::AnimationSpriteSheet::Frame & aSourceFrame)
         {
-            LoadedSprite loaded = aSourceFrame;
-            loaded.origin() += aTextureOffset;
+            LoadedSprite loaded = *loadedIt++;
 
             durationAccumulator += aSourceFrame.duration;
             animationFrames.push_back(Animation::Frame{
                 // Frame name is not saved at the moment
                 //aSourceFrame.name,
                 durationAccumulator,
-                loaded
+                loaded,
+                aSourceFrame.trim,
             });
         }
     ); 
-    mAnimations.emplace(aSpriteSheet.name(), 
-                        Animation{aSpriteSheet.totalDuration(), std::move(animationFrames)});
+    // As with a map emplace, an animation already loaded under this name is kept.
+    auto [position, inserted] = mHandles.try_emplace(aSpriteSheet.name(), AnimationHandle{mAnimations.size()});
+    if (inserted)
+    {
+        mAnimations.push_back(Animation{aSpriteSheet.totalDuration(), std::move(animationFrames)});
+    }
 }
 
 
 LoadedAtlas Animator::load(const arte::AnimationSpriteSheet & aSpriteSheet)
 {
-    insertAnimationFrames(aSpriteSheet, {0, 0});
-    return loadAtlas(aSpriteSheet.image());
+    // Packing the frames (instead of loading the sheet image as is) merges the identical frames.
+    return load(&aSpriteSheet, &aSpriteSheet + 1);
 }
 
 
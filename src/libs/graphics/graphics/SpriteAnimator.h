@@ -11,7 +11,11 @@
 
 #include <math/Color.h>
 
+#include <cstddef>
+#include <iterator>
+#include <span>
 #include <unordered_map>
+#include <vector>
 
 
 namespace ad {
@@ -30,18 +34,53 @@ struct Animation
     {
         Duration_t endTime; // the local end time for this frame
         LoadedSprite loadedSprite;
+        SpriteTrim trim;
     };
 
-    /// \brief Obtain the `LoadedSprite` corresponding to local animation time `aLocalTime`.
+    /// \brief Compile the lookup of `aFrames`, which must not be empty.
+    Animation(Duration_t aTotalDuration, std::vector<Frame> aFrames);
+
+    /// \brief Obtain the sprite corresponding to local animation time `aLocalTime`.
     ///  
-    /// The `LoadedSprite` can then be renderer using `Spriting` renderer.
+    /// The sprite can then be renderer using `Spriting` renderer, which applies its trim.
     ///
     /// \note Please see `math::ParameterAnimation` template to implement
     /// easing and periodicity behaviours.
-    LoadedSprite at(Duration_t aLocalTime) const;
+    TrimmedSprite at(Duration_t aLocalTime) const
+    {
+        const Frame & frame = frames[frameIndexAt(aLocalTime)];
+        return {frame.loadedSprite, frame.trim};
+    }
+
+    /// \brief The index of the first frame ending at or after `aLocalTime`,
+    /// or of the last frame if the animation is over (or `aLocalTime` is NaN).
+    ///
+    /// This is constant time for animations where all frames have the same duration,
+    /// logarithmic in the number of frames otherwise.
+    std::size_t frameIndexAt(Duration_t aLocalTime) const;
 
     Duration_t totalDuration;
     std::vector<Frame> frames;
+    /// \brief The duration of each frame if they are all equal, 0 otherwise.
+    /// It is computed at construction, `frames` should not be modified afterward.
+    Duration_t uniformFrameDuration{0};
+};
+
+
+/// \brief Designates an `Animation` in an `Animator`, without hashing its identifier on each access.
+struct AnimationHandle
+{
+    bool operator==(const AnimationHandle &) const = default;
+
+    std::size_t mIndex;
+};
+
+
+/// \brief The animation played by an entity, and the entity local time in this animation.
+struct AnimationState
+{
+    AnimationHandle mAnimation;
+    Animation::Duration_t mLocalTime;
 };
 
 
@@ -54,26 +93,51 @@ public:
     /// This means a Spriting renderer can later draw frames for this animation.
     LoadedAtlas load(const arte::AnimationSpriteSheet & aSpriteSheet);
 
-    /// \brief Load several sprite sheets, assembling them into a consolidated atlas.
+    /// \brief Load several sprite sheets, packing all their frames into a consolidated atlas.
     template <class T_iterator>
     LoadedAtlas load(T_iterator aSheetBegin, T_iterator aSheetEnd);
 
+    /// \brief Retrieves the handle of an `Animation` from its identifier.
+    /// The handle should be kept by clients accessing the animation repeatedly.
+    AnimationHandle getHandle(const handy::StringId & aAnimationId) const
+    { return mHandles.at(aAnimationId); }
+
     /// \brief Retrieves an `Animation` from its identifier. 
     const Animation & get(const handy::StringId & aAnimationId) const
-    { return mAnimations.at(aAnimationId); }
+    { return get(getHandle(aAnimationId)); }
+
+    const Animation & get(AnimationHandle aAnimation) const
+    { return mAnimations[aAnimation.mIndex]; }
 
     /// \brief Retrieve an `Animation` frame directly.
-    LoadedSprite at(const handy::StringId & aAnimationId, Animation::Duration_t aAnimationTime) const
+    TrimmedSprite at(const handy::StringId & aAnimationId, Animation::Duration_t aAnimationTime) const
     { return get(aAnimationId).at(aAnimationTime); }
 
+    TrimmedSprite at(AnimationHandle aAnimation, Animation::Duration_t aAnimationTime) const
+    { return get(aAnimation).at(aAnimationTime); }
+
+    /// \brief All loaded animations, each at the index of its `AnimationHandle`.
+    std::span<const Animation> getAnimations() const
+    { return mAnimations; }
+
+    /// \brief Evaluate the sprite of each animated entity in `aStates`, in a single pass.
+    /// \param aOutput Receives the sprites, in the order of `aStates`
+    /// (e.g. the `begin()` of a range of the same size, or a `std::back_inserter`).
+    /// \return The output iterator, past the last written sprite.
+    template <class T_outputIterator>
+    T_outputIterator evaluate(std::span<const AnimationState> aStates, T_outputIterator aOutput) const;
+
 private:
     /// Prepare the frames in `aSpriteSheet` to be renderable from `aSpriting`, but does not
     /// load any texture (this must be done separately).
+    /// \param aLoadedFrames The area of each frame of `aSpriteSheet` in the loaded texture.
     void insertAnimationFrames(const arte::AnimationSpriteSheet & aSpriteSheet, 
-                               math::Vec<2, int> aTextureOffset);
+                               std::span<const LoadedSprite> aLoadedFrames);
 
+    // Contiguous, so evaluating many entities does not chase nodes of the map.
+    std::vector<Animation> mAnimations;
     // Note Ad 2021/12:14: It not obvious wether it would be best to use a unordered_map or plain map here.
-    std::unordered_map<handy::StringId, Animation> mAnimations;
+    std::unordered_map<handy::StringId, AnimationHandle> mHandles;
 };
 
 
@@ -83,24 +147,41 @@ private:
 template <class T_iterator>
 LoadedAtlas Animator::load(T_iterator aSheetBegin, T_iterator aSheetEnd)
 {
-    arte::Image<math::sdr::Rgba> spriteAtlas = arte::stackVertical<math::sdr::Rgba>(
-        aSheetBegin, aSheetEnd, 
-        [](const arte::AnimationSpriteSheet & aSpriteSheet)
+    // Pack the individual frames, instead of stacking the complete sheet images.
+    std::vector<arte::ImageView<const math::sdr::Rgba>> frames;
+    for (T_iterator sheetIt = aSheetBegin; sheetIt != aSheetEnd; ++sheetIt)
+    {
+        // The iterator might not point directly to an AnimationSpriteSheet (e.g. to a reference_wrapper).
+        const arte::AnimationSpriteSheet & spriteSheet = *sheetIt;
+        for (auto frameIt = spriteSheet.cbegin(); frameIt != spriteSheet.cend(); ++frameIt)
         {
-            return aSpriteSheet.image();
-        });
+            frames.push_back(spriteSheet.image().view(frameIt->area));
+        }
+    }
 
-    math::Vec<2, int> offset{0, 0};
+    auto [atlas, loadedFrames] = loadPacked(frames);
+
+    std::span<const LoadedSprite> remainingFrames{loadedFrames};
     for (T_iterator sheetIt = aSheetBegin; sheetIt != aSheetEnd; ++sheetIt)
     {
-        insertAnimationFrames(*sheetIt, offset);
-        // The iterator might not point directly to an AnimationSpriteSheet (e.g. to a reference_wrapper).
         const arte::AnimationSpriteSheet & spriteSheet = *sheetIt;
-        offset.y() += spriteSheet.image().dimensions().height();
+        const auto frameCount = (std::size_t)std::distance(spriteSheet.cbegin(), spriteSheet.cend());
+        insertAnimationFrames(spriteSheet, remainingFrames.first(frameCount));
+        remainingFrames = remainingFrames.subspan(frameCount);
     }
 
-    // return the loaded atlas
-    return loadAtlas(spriteAtlas);
+    return atlas;
+}
+
+
+template <class T_outputIterator>
+T_outputIterator Animator::evaluate(std::span<const AnimationState> aStates, T_outputIterator aOutput) const
+{
+    for (const AnimationState & state : aStates)
+    {
+        *aOutput++ = mAnimations[state.mAnimation.mIndex].at(state.mLocalTime);
+    }
+    return aOutput;
 }
 
 
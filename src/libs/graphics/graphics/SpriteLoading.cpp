@@ -1,16 +1,77 @@
 #include "SpriteLoading.h"
 
+#include "detail/Logging.h"
+
+#include <arte/AtlasPacking.h>
 #include <arte/SpriteSheet.h>
 
+#include <renderer/SynchronousQueries.h>
+
+#include <stdexcept>
+#include <string>
+
 
 namespace ad {
 namespace graphics {
 namespace sprite {
 
 
+SheetLoad loadPacked(std::span<const arte::ImageView<const math::sdr::Rgba>> aSprites)
+{
+    const int maxTextureSize = getMaxTextureSize();
+    arte::Atlas<math::sdr::Rgba> atlas = arte::packAtlas<math::sdr::Rgba>(
+        aSprites,
+        math::sdr::gTransparent,
+        arte::PackingOptions{
+            .mMaxPageSize = {maxTextureSize, maxTextureSize},
+            // Keeps sprites isolated from their neighbours, should filtering ever be enabled.
+            .mPadding = 1,
+            // Spriting renderer does not support rotated sprites.
+            .mAllowRotation = false,
+            // Repeated frames and tiles (notably the empty ones) are stored once.
+            .mDeduplicate = true,
+        });
+
+    if (atlas.mDeduplicatedBytes != 0)
+    {
+        ADLOG(gMainLogger, debug)("Sprite atlas deduplication saved {} bytes.", atlas.mDeduplicatedBytes);
+    }
+
+    if (atlas.mPages.size() > 1)
+    {
+        throw std::runtime_error{
+            "Sprites require " + std::to_string(atlas.mPages.size())
+            + " atlas pages, but only a single texture is supported."};
+    }
+
+    std::vector<LoadedSprite> loadedSprites;
+    loadedSprites.reserve(atlas.mPlacements.size());
+    for (const arte::PackedRectangle & placement : atlas.mPlacements)
+    {
+        loadedSprites.push_back(placement.mArea);
+    }
+
+    if (atlas.mPages.empty() || atlas.mPages.front().dimensions().area() == 0)
+    {
+        // No sprite has any pixel (or there are no sprites): the texture is never sampled,
+        // so no storage is allocated for it.
+        return {
+            LoadedAtlas{.texture{std::make_shared<Texture>(GL_TEXTURE_RECTANGLE)}},
+            std::move(loadedSprites)
+        };
+    }
+    return {loadAtlas(atlas.mPages.front()), std::move(loadedSprites)};
+}
+
+
 SheetLoad load(const arte::TileSheet & aTileSheet)
 {
-    return load(aTileSheet.cbegin(), aTileSheet.cend(), aTileSheet.image());
+    std::vector<arte::ImageView<const math::sdr::Rgba>> tiles;
+    for (auto tileIt = aTileSheet.cbegin(); tileIt != aTileSheet.cend(); ++tileIt)
+    {
+        tiles.push_back(aTileSheet.image().view(tileIt->area));
+    }
+    return loadPacked(tiles);
 }
 
 
@@ -6,6 +6,8 @@
 #include <renderer/Texture.h>
 #include <renderer/TextureUtilities.h>
 
+#include <span>
+
 
 namespace ad {
 namespace graphics {
@@ -39,7 +41,15 @@ template <std::ranges::range T_range, class T_pixel>
 SheetLoad load(T_range aRange, const arte::Image<T_pixel> & aRasterData);
 
 
-/// \brief Load all sprites from a TileSheet.
+/// \brief Pack the `aSprites` images into a single atlas, much denser than stacking the source images.
+///
+/// Pixel-identical sprites share a single region of the atlas.
+/// \return The atlas, and the sprite for each of `aSprites` (in the same order).
+/// \throw std::runtime_error if the sprites do not fit in a single texture.
+SheetLoad loadPacked(std::span<const arte::ImageView<const math::sdr::Rgba>> aSprites);
+
+
+/// \brief Load all sprites from a TileSheet, packing them in the atlas.
 SheetLoad load(const arte::TileSheet & aTileSheet);
 
 
@@ -2,7 +2,8 @@
 
 #include "shaders.h"
 #include "SpriteLoading.h"
-#include "Vertex.h"
+
+#include "detail/UnitQuad.h"
 
 #include <renderer/Texture.h>
 #include <renderer/Uniforms.h>
@@ -16,53 +17,11 @@ namespace ad {
 namespace graphics {
 
 
-// Note: texture_2D_rect indices are texel based (not normalized)
-constexpr size_t gVerticesCount{4};
-Vertex gVerticesQuad[gVerticesCount] = {
-    Vertex{
-        {0.0f, 0.0f},
-        {0, 0},
-    },
-    Vertex{
-        {0.0f,  1.0f},
-        {0, 1},
-    },
-    Vertex{
-        { 1.0f, 0.0f},
-        {1, 0},
-    },
-    Vertex{
-        { 1.0f,  1.0f},
-        {1, 1},
-    },
-};
-
 namespace {
 
 VertexSpecification makeQuad()
 {
-    VertexSpecification specification;
-
-    // Per-vertex attributes
-    specification.mVertexBuffers.emplace_back(
-        loadVertexBuffer(
-            specification.mVertexArray,
-            {
-                // Postion
-                { 0,                                     {2, offsetof(Vertex, mPosition), MappedGL<GLfloat>::enumerator}},
-                // UV
-                { {1, ShaderParameter::Access::Integer}, {2, offsetof(Vertex, mUV),       MappedGL<GLint>::enumerator}},
-            },
-            sizeof(Vertex),
-            sizeof(gVerticesQuad),
-            gVerticesQuad,
-            BufferHint::StaticDraw
-        ));
-        /// TODO For that to work, the array_utils have to work with math type derived from MatrixBase
-        //using namespace vertex; // for vertex::attr()
-        //makeLoadedVertexBuffer(range(gVerticesQuad),
-        //                       attr(0,                               &Vertex::mPosition),
-        //                       attr({1, ShaderParameter::Access::Integer}, &Vertex::mUV)));
+    VertexSpecification specification = detail::make_SpriteQuad();
 
     // Per-instance attributes
     specification.mVertexBuffers.push_back(
@@ -77,6 +36,8 @@ VertexSpecification makeQuad()
                 { {5, ShaderParameter::Access::Integer}, {4, offsetof(Spriting::Instance, mLoadedSprite),  MappedGL<GLint>::enumerator}},
                 { 6,                                     {1, offsetof(Spriting::Instance, mOpacity),       MappedGL<GLfloat>::enumerator}},
                 { 7,                                     {2, offsetof(Spriting::Instance, mAxisMirroring), MappedGL<GLint>::enumerator}},
+                { 8,                                     {2, offsetof(Spriting::Instance, mTrimOffset),    MappedGL<GLint>::enumerator}},
+                { 9,                                     {2, offsetof(Spriting::Instance, mSourceSize),    MappedGL<GLint>::enumerator}},
             },
             1
         ));
@@ -102,21 +63,23 @@ Program makeProgram()
 
 
 Spriting::Instance::Instance(math::AffineMatrix<3, GLfloat> aModelTransform,
-                             LoadedSprite aSprite,
+                             TrimmedSprite aSprite,
                              GLfloat aOpacity,
                              Mirroring aMirroring) :
     mModelTransform{aModelTransform},
-    mLoadedSprite{std::move(aSprite)},
+    mLoadedSprite{aSprite.mLoadedSprite},
     mOpacity{aOpacity},
     mAxisMirroring{
         (test(aMirroring, Mirroring::FlipHorizontal) ? -1 : 1),
         (test(aMirroring, Mirroring::FlipVertical) ? -1 : 1)
-    }
+    },
+    mTrimOffset{aSprite.mTrim.offset},
+    mSourceSize{aSprite.mTrim.sourceSize}
 {}
 
 
 Spriting::Instance::Instance(Position2<GLfloat> aRenderingPosition, 
-                             LoadedSprite aSprite,
+                             TrimmedSprite aSprite,
                              GLfloat aOpacity,
                              Mirroring aMirroring) :
     Instance{math::trans2d::translate(aRenderingPosition.as<math::Vec>()), 
@@ -158,7 +121,7 @@ void Spriting::render(const sprite::LoadedAtlas & aAtlas) const
 
     glDrawArraysInstanced(GL_TRIANGLE_STRIP,
                           0,
-                          gVerticesCount,
+                          detail::gQuadVerticeCount,
                           mInstanceCount);
 }
 
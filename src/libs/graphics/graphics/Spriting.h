@@ -8,10 +8,12 @@
 
 #include <math/Homogeneous.h>
 
+#include <renderer/BufferLoad.h>
 #include <renderer/Drawing.h>
 
 #include <glad/glad.h>
 
+#include <utility>
 #include <vector>
 
 
@@ -27,13 +29,15 @@ class Spriting
 public:
     struct Instance
     {
+        /// \note A trimmed sprite is offset to the place of its untrimmed frame,
+        /// and mirrored within the untrimmed frame.
         Instance(math::AffineMatrix<3, GLfloat> aModelTransform,
-                 LoadedSprite aSprite,
+                 TrimmedSprite aSprite,
                  GLfloat aOpacity = 1.f,
                  Mirroring aMirroring = Mirroring::None); 
 
         Instance(Position2<GLfloat> aRenderingPosition, 
-                 LoadedSprite aSprite,
+                 TrimmedSprite aSprite,
                  GLfloat aOpacity = 1.f,
                  Mirroring aMirroring = Mirroring::None);
             
@@ -59,12 +63,21 @@ public:
         LoadedSprite mLoadedSprite;
         GLfloat mOpacity;
         Vec2<int> mAxisMirroring;
+        Vec2<int> mTrimOffset;
+        Size2<int> mSourceSize;
     };
 
     Spriting(GLfloat aPixelSize = 1.f);
 
     void updateInstances(std::span<const Instance> aInstances);
 
+    /// \brief Replace the instances with `aInstanceCount` instances written by `aWriter`
+    /// directly into the instance buffer, without an intermediate copy.
+    ///
+    /// `aWriter(std::span<Instance>)` must construct all the instances of the span, which are uninitialized.
+    template <class F_writer>
+    void writeInstances(std::size_t aInstanceCount, F_writer && aWriter);
+
     // TODO Externalize the VertexSpecification in a dedicated struct, and take it as an argument.
     // It would be more flexible, and remove some constness issues (seen Grapito Render system).
     // The dedicated struct type maintains static format safety.
@@ -89,5 +102,16 @@ private:
 };
 
 
+template <class F_writer>
+void Spriting::writeInstances(std::size_t aInstanceCount, F_writer && aWriter)
+{
+    respecifyMapped<Instance>(mVertexSpecification.mVertexBuffers.back(),
+                              static_cast<GLsizei>(aInstanceCount),
+                              BufferHint::StreamDraw,
+                              std::forward<F_writer>(aWriter));
+    mInstanceCount = static_cast<GLsizei>(aInstanceCount);
+}
+
+
 } // namespace graphics
 } // namespace ad
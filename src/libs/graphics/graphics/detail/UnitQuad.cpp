@@ -1,6 +1,7 @@
 #include "UnitQuad.h"
 
 #include "../shaders.h"
+#include "../Vertex.h"
 
 #include <renderer/Uniforms.h>
 
@@ -45,6 +46,32 @@ VertexSpecification make_Rectangle(math::Rectangle<GLfloat> aVertices)
     return result;
 }
 
+VertexSpecification make_SpriteQuad()
+{
+    // Note: texture_2D_rect indices are texel based (not normalized)
+    std::array<Vertex, gQuadVerticeCount> vertices{
+        Vertex{
+            {0.0f, 0.0f},
+            {0, 0},
+        },
+        Vertex{
+            {0.0f,  1.0f},
+            {0, 1},
+        },
+        Vertex{
+            { 1.0f, 0.0f},
+            {1, 0},
+        },
+        Vertex{
+            { 1.0f,  1.0f},
+            {1, 1},
+        },
+    };
+    VertexSpecification result;
+    appendToVertexSpecification(result, gVertexDescription, std::span(vertices), BufferHint::StaticDraw);
+    return result;
+}
+
 Program make_PassthroughProgram(GLint aTextureUnit)
 {
     Program passthrough = makeLinkedProgram({
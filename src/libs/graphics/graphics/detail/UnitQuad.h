@@ -31,6 +31,10 @@ constexpr GLsizei gQuadVerticeCount = 4;
 std::array<VertexUnitQuad, gQuadVerticeCount> make_RectangleVertices(math::Rectangle<GLfloat> aVertices);
 
 VertexSpecification make_Rectangle(math::Rectangle<GLfloat> aVertices);
+
+/// \brief The unit quad of the sprite renderers, whose integer uv are to be scaled by the sprite area.
+/// Drawn as a triangle strip of `gQuadVerticeCount` vertices.
+VertexSpecification make_SpriteQuad();
 // TODO make a global VertexSpecification instance instead
 VertexSpecification make_UnitQuad();
 
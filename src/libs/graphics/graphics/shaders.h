@@ -14,6 +14,8 @@ inline const GLchar* gSpriteVertexShader = R"#(
     layout(location=5) in ivec4 in_TextureArea;
     layout(location=6) in float in_Opacity;
     layout(location=7) in vec2  in_AxisMirroring;
+    layout(location=8) in vec2  in_TrimOffset;
+    layout(location=9) in vec2  in_SourceSize;
 
     uniform vec2 u_pixelWorldSize;
     uniform mat3 u_camera;
@@ -24,7 +26,12 @@ inline const GLchar* gSpriteVertexShader = R"#(
 
     void main(void)
     {
-        vec3 vertexPosition_local = vec3(ve_VertexPosition * in_TextureArea.zw * u_pixelWorldSize, 1.);
+        // The trimmed sprite is placed in its untrimmed frame, mirroring happening in the untrimmed frame.
+        vec2 trimOffset = mix(in_TrimOffset,
+                              in_SourceSize - in_TrimOffset - in_TextureArea.zw,
+                              lessThan(in_AxisMirroring, vec2(0., 0.)));
+        vec3 vertexPosition_local =
+            vec3((trimOffset + ve_VertexPosition * in_TextureArea.zw) * u_pixelWorldSize, 1.);
         vec3 vertexPosition_world = in_ModelTransform * vertexPosition_local;
         vec3 vertexPosition_ndc = u_projection * u_camera * vertexPosition_world;
 
@@ -41,6 +48,125 @@ inline const GLchar* gSpriteVertexShader = R"#(
 )#";
 
 
+// Selects the frame of each instance from its animation and the time uniform,
+// so time-driven animations do not require per-frame instance updates.
+inline const GLchar* gAnimatedSpriteVertexShader = R"#(
+    #version 400
+
+    layout(location=0) in vec2  ve_VertexPosition;
+    layout(location=1) in ivec2 ve_UV;
+
+    layout(location=2)  in mat3  in_ModelTransform;
+    layout(location=5)  in int   in_Animation;
+    layout(location=6)  in float in_StartTime;
+    layout(location=7)  in float in_Speed;
+    layout(location=8)  in int   in_Repeat;
+    layout(location=9)  in float in_Opacity;
+    layout(location=10) in vec2  in_AxisMirroring;
+
+    uniform vec2 u_pixelWorldSize;
+    uniform mat3 u_camera;
+    uniform mat3 u_projection;
+    uniform float u_time;
+
+    // For each animation: first frame, frame count, total duration (bits), uniform frame duration (bits).
+    uniform isamplerBuffer u_animations;
+    // For each frame: its end time in the animation.
+    uniform samplerBuffer u_frameEndTimes;
+    // For each frame: its area in the atlas, then its trim offset and source size.
+    uniform isamplerBuffer u_frameSprites;
+
+    out vec2  ex_UV;
+    out float ex_Opacity;
+
+    float endTime(int aFrame)
+    {
+        return texelFetch(u_frameEndTimes, aFrame).r;
+    }
+
+    // Must select the same frame as sprite::Animation::frameIndexAt()
+    int frameIndexAt(int aFirstFrame, int aFrameCount, float aUniformFrameDuration, float aLocalTime)
+    {
+        int lastIndex = aFrameCount - 1;
+
+        if (isnan(aLocalTime))
+        {
+            return lastIndex;
+        }
+
+        if (aUniformFrameDuration > 0.)
+        {
+            if (aLocalTime <= 0.)
+            {
+                return 0;
+            }
+            int index = int(clamp(ceil(aLocalTime / aUniformFrameDuration) - 1., 0., float(lastIndex)));
+            if (index > 0 && endTime(aFirstFrame + index - 1) >= aLocalTime)
+            {
+                --index;
+            }
+            else if (index < lastIndex && endTime(aFirstFrame + index) < aLocalTime)
+            {
+                ++index;
+            }
+            return index;
+        }
+
+        // Lower bound of the local time in the end times, the last frame being excluded.
+        int first = 0;
+        int count = lastIndex;
+        while (count > 0)
+        {
+            int step = count / 2;
+            if (endTime(aFirstFrame + first + step) < aLocalTime)
+            {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else
+            {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    void main(void)
+    {
+        ivec4 animation = texelFetch(u_animations, in_Animation);
+        float totalDuration = intBitsToFloat(animation.z);
+
+        float localTime = (u_time - in_StartTime) * in_Speed;
+        if (in_Repeat != 0 && totalDuration > 0.)
+        {
+            localTime = mod(localTime, totalDuration);
+        }
+
+        int frame = animation.x + frameIndexAt(animation.x, animation.y, intBitsToFloat(animation.w), localTime);
+        ivec4 textureArea = texelFetch(u_frameSprites, 2 * frame);
+        ivec4 trim = texelFetch(u_frameSprites, 2 * frame + 1);
+
+        // The rest is identical to the sprite vertex shader.
+        vec2 trimOffset = mix(vec2(trim.xy),
+                              vec2(trim.zw - trim.xy - textureArea.zw),
+                              lessThan(in_AxisMirroring, vec2(0., 0.)));
+        vec3 vertexPosition_local =
+            vec3((trimOffset + ve_VertexPosition * textureArea.zw) * u_pixelWorldSize, 1.);
+        vec3 vertexPosition_world = in_ModelTransform * vertexPosition_local;
+        vec3 vertexPosition_ndc = u_projection * u_camera * vertexPosition_world;
+
+        gl_Position = vec4(vertexPosition_ndc.x, vertexPosition_ndc.y, 0., 1.);
+
+        vec2 uv = ve_UV - vec2(0.5, 0.5);
+        uv *= in_AxisMirroring;
+        uv += vec2(0.5, 0.5);
+
+        ex_UV = textureArea.xy + uv * textureArea.zw;
+        ex_Opacity = in_Opacity;
+    }
+)#";
+
+
 inline const GLchar* gAnimationFragmentShader = R"#(
     #version 400
 
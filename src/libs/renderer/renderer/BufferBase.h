@@ -18,6 +18,7 @@ enum class BufferType
     ElementArray = GL_ELEMENT_ARRAY_BUFFER,
     Uniform = GL_UNIFORM_BUFFER,
     DrawIndirect = GL_DRAW_INDIRECT_BUFFER,
+    Texture = GL_TEXTURE_BUFFER,
 };
 
 
@@ -4,6 +4,8 @@
 #include "ScopeGuards.h"
 
 #include <span>
+#include <stdexcept>
+#include <string>
 
 
 namespace ad {
@@ -61,6 +63,59 @@ void loadSingle(const BufferAny & aBuffer, T_data aInstanceData, BufferHint aUsa
 }
 
 
+/// @brief Respecify the data store of `aBuffer` to accomodate `aInstanceCount` objects of type `T_data`,
+/// which are written by `aWriter` directly into the mapped data store.
+/// @param aWriter Invoked with a `std::span<T_data>` viewing the mapped data store,
+/// whose objects are not initialized: it must write all of them.
+/// It is invoked again in the rare event the data store is corrupted while mapped.
+/// @throw std::runtime_error if the data store cannot be mapped, or is repeatedly corrupted.
+/// @note The previous data store is orphaned, so mapping does not wait for pending draws using it.
+template <class T_data, BufferType N_type, class F_writer>
+void respecifyMapped(const Buffer<N_type> & aBuffer,
+                     GLsizei aInstanceCount,
+                     BufferHint aUsageHint,
+                     F_writer && aWriter)
+{
+    constexpr GLenum target = static_cast<GLenum>(N_type);
+    const GLsizeiptr size = sizeof(T_data) * aInstanceCount;
+
+    ScopedBind bound{aBuffer};
+    glBufferData(target, size, NULL, getGLBufferHint(aUsageHint));
+    if (aInstanceCount == 0)
+    {
+        return;
+    }
+
+    // Unmapping returns GL_FALSE if the data store was corrupted while mapped (e.g. on a screen mode change),
+    // in which case its content is undefined: the objects are written again.
+    constexpr int maxAttempts = 3;
+    for (int attempt = 0; attempt != maxAttempts; ++attempt)
+    {
+        void * mapped = glMapBufferRange(target, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped == nullptr)
+        {
+            throw std::runtime_error("Could not map buffer (" + std::to_string(__LINE__) + ")");
+        }
+
+        try
+        {
+            aWriter(std::span<T_data>{static_cast<T_data *>(mapped), static_cast<std::size_t>(aInstanceCount)});
+        }
+        catch (...)
+        {
+            glUnmapBuffer(target);
+            throw;
+        }
+
+        if (glUnmapBuffer(target) == GL_TRUE)
+        {
+            return;
+        }
+    }
+    throw std::runtime_error("Buffer data store corrupted while mapped (" + std::to_string(__LINE__) + ")");
+}
+
+
 /// @brief Updates a subset of a buffer data store.
 /// @param aInstanceCountOffset The offset to the start of the buffer subset to replace,
 /// expressed in number of objects, **not** bytes.
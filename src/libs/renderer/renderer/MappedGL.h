@@ -3,6 +3,8 @@
 
 #include "GL_Loader.h"
 
+#include <arte/HalfFloat.h>
+
 #include <math/Color.h>
 
 
@@ -91,6 +93,8 @@ MAP(MappedPixel, math::sdr::Grayscale, GL_RED);
 MAP(MappedPixel, math::sdr::Rgb, GL_RGB);
 MAP(MappedPixel, math::sdr::Rgba, GL_RGBA);
 MAP(MappedPixel, math::hdr::Rgb_f, GL_RGB);
+MAP(MappedPixel, arte::Rgb_h, GL_RGB);
+MAP(MappedPixel, arte::Rgba_h, GL_RGBA);
 
 template <class T_pixel>
 struct MappedSizedPixel;
@@ -110,8 +114,10 @@ MAP_AND_REVERSE(MappedSizedPixel, math::sdr::Rgba, GL_RGBA8);
 // Note: It seems the RGBE (.hdr) image format, often used to load Image<Rgb_f>
 // has a dynamic range exceeding half-float (RGB16F)
 // see: https://en.wikipedia.org/wiki/RGBE_image_format#description
-// TODO: we should find a way to use a Float 16 for hdr images
+// When the range is known to fit, arte::to_half() halves the upload size.
 MAP_AND_REVERSE(MappedSizedPixel, math::hdr::Rgb_f, GL_RGB32F);
+MAP_AND_REVERSE(MappedSizedPixel, arte::Rgb_h, GL_RGB16F);
+MAP_AND_REVERSE(MappedSizedPixel, arte::Rgba_h, GL_RGBA16F);
 
 template <class T_pixel>
 struct MappedPixelComponentType;
@@ -123,6 +129,8 @@ MAP(MappedPixelComponentType, math::sdr::Grayscale, GL_UNSIGNED_BYTE);
 MAP(MappedPixelComponentType, math::sdr::Rgb,       GL_UNSIGNED_BYTE);
 MAP(MappedPixelComponentType, math::sdr::Rgba,      GL_UNSIGNED_BYTE);
 MAP(MappedPixelComponentType, math::hdr::Rgb_f,     GL_FLOAT);
+MAP(MappedPixelComponentType, arte::Rgb_h,          GL_HALF_FLOAT);
+MAP(MappedPixelComponentType, arte::Rgba_h,         GL_HALF_FLOAT);
 
 constexpr GLuint getPixelFormatBitSize(GLenum aSizedInternalFormat) 
 {
@@ -146,10 +154,28 @@ constexpr GLuint getPixelFormatBitSize(GLenum aSizedInternalFormat)
         case GL_RGBA8_SNORM:
         case GL_SRGB8_ALPHA8:
             return 32;
+        case GL_RGB16F:
+            return 3 * 16;
+        case GL_RGBA16F:
+            return 4 * 16;
         case GL_RGB32F:
             return 3 * 32;
 
         // Compressed formats
+        // BC1
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+            return 4;
+        // BC3
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            return 8;
+        // BC4
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+            return 4;
         // BC5
         case GL_COMPRESSED_RG_RGTC2:
         case GL_COMPRESSED_SIGNED_RG_RGTC2:
@@ -253,6 +279,7 @@ constexpr GLenum getGLMappedBufferBinding(GLenum aBufferTarget)
         BINDINGCASE(GL_PIXEL_PACK_BUFFER, GL_PIXEL_PACK_BUFFER_BINDING);
         BINDINGCASE(GL_PIXEL_UNPACK_BUFFER, GL_PIXEL_UNPACK_BUFFER_BINDING);
         BINDINGCASE(GL_SHADER_STORAGE_BUFFER, GL_SHADER_STORAGE_BUFFER_BINDING);
+        BINDINGCASE(GL_TEXTURE_BUFFER, GL_TEXTURE_BUFFER_BINDING);
         BINDINGCASE(GL_TRANSFORM_FEEDBACK_BUFFER, GL_TRANSFORM_FEEDBACK_BUFFER_BINDING);
         BINDINGCASE(GL_UNIFORM_BUFFER, GL_UNIFORM_BUFFER_BINDING);
 
@@ -7,6 +7,7 @@
 #include "ScopeGuards.h"
 
 #include <arte/Image.h>
+#include <arte/Mipmaps.h>
 
 #include <handy/Guard.h>
 
@@ -34,6 +35,14 @@ inline Guard scopeUnpackAlignment(GLint aAlignment)
 }
 
 
+/// \brief Set the row length (in pixels) of subsequent texture unpack operation to `aRowLength`,
+/// then restore the previous row length on returned guard destruction.
+inline Guard scopeUnpackRowLength(GLint aRowLength)
+{
+    return scopePixelStorageMode(GL_UNPACK_ROW_LENGTH, aRowLength);
+}
+
+
 /// \brief Set the alignment of subsequent texture pack (read from texture into client memory)
 /// operation to `aAlignment`, then restore the previous alignment on returned guard destruction.
 inline Guard scopePackAlignment(GLint aAlignment)
@@ -167,19 +176,14 @@ inline void setFiltering(const Texture & aTexture, GLenum aFiltering)
 
 inline GLsizei countCompleteMipmaps(math::Size<2, int> aResolution)
 {
-    return static_cast<GLsizei>(std::floor(
-        std::log2(
-            std::max(aResolution.width(), aResolution.height())
-    ))) + 1;
+    return static_cast<GLsizei>(arte::countCompleteMipmaps(aResolution));
 }
 
 
 inline constexpr math::Size<2, GLsizei> getMipmapSize(math::Size<2, int> aFullResolution, unsigned int aLevel)
 {
-    return {
-        std::max(1, aFullResolution.width() / (int)std::pow(2, aLevel)),
-        std::max(1, aFullResolution.height() / (int)std::pow(2, aLevel)),
-    };
+    const math::Size<2, int> size = arte::getMipmapSize(aFullResolution, aLevel);
+    return {static_cast<GLsizei>(size.width()), static_cast<GLsizei>(size.height())};
 }
 
 
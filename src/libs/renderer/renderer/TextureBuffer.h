@@ -0,0 +1,46 @@
+#pragma once
+
+
+#include "BufferBase.h"
+#include "ScopeGuards.h"
+#include "Texture.h"
+
+#include <cassert>
+
+
+namespace ad {
+namespace graphics {
+
+
+using TextureBufferObject = Buffer<BufferType::Texture>;
+
+
+/// \brief A buffer texture, giving shaders access to the data store of a buffer via `texelFetch()`.
+///
+/// Buffer textures are much larger than uniform blocks (at least 65536 texels),
+/// which makes them suitable for lookup tables indexed from the shaders.
+struct BufferTexture
+{
+    TextureBufferObject mBuffer;
+    Texture mTexture{GL_TEXTURE_BUFFER};
+};
+
+
+/// \brief Make `aTexture` (of target `GL_TEXTURE_BUFFER`) access the data store of `aBuffer`,
+/// whose texels are interpreted with the sized `aInternalFormat` (e.g. `GL_RGBA32I`).
+inline void attachBuffer(const Texture & aTexture, const TextureBufferObject & aBuffer, GLenum aInternalFormat)
+{
+    assert(aTexture.mTarget == GL_TEXTURE_BUFFER);
+    ScopedBind bound{aTexture};
+    glTexBuffer(GL_TEXTURE_BUFFER, aInternalFormat, aBuffer);
+}
+
+
+inline void attachBuffer(const BufferTexture & aBufferTexture, GLenum aInternalFormat)
+{
+    attachBuffer(aBufferTexture.mTexture, aBufferTexture.mBuffer, aInternalFormat);
+}
+
+
+} // namespace graphics
+} // namespace ad
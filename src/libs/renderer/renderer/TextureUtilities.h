@@ -5,14 +5,18 @@
 
 #include "MappedGL.h"
 
+#include <arte/BlockCompression.h>
+
 namespace ad::graphics {
 
 
+/// \param aOptions Notably selects the compression level and the parallelism of the PNG encoder.
 template <class T_Pixel>
 void serializeTexture(const graphics::Texture & aTexture,
                       GLint aLevel,
                       arte::ImageFormat aFormat,
-                      std::ostream & aOut)
+                      std::ostream & aOut,
+                      const arte::EncodingOptions & aOptions = {})
 {
     graphics::ScopedBind boundTexture{aTexture};
 
@@ -51,7 +55,7 @@ void serializeTexture(const graphics::Texture & aTexture,
                   raster.get());
 
     arte::Image<T_Pixel> result{size, std::move(raster)};
-    result.write(aFormat, aOut);
+    result.write(aFormat, aOut, arte::ImageOrientation::Unchanged, aOptions);
 }
 
 
@@ -61,22 +65,64 @@ struct InputImageParameters
     template <class T_pixel>
     static InputImageParameters From(const arte::Image<T_pixel> & aImage);
 
+    /// \note `T_pixel` might be const qualified.
+    template <class T_pixel>
+    static InputImageParameters From(arte::ImageView<T_pixel> aImageView);
+
     math::Size<2, GLsizei> resolution;
     GLenum format;
     GLenum type;
     GLint alignment; // maps to GL_UNPACK_ALIGNMENT
+    GLint rowLength = 0; // maps to GL_UNPACK_ROW_LENGTH, 0 means rows are `resolution.width()` pixels
 };
 
 
 template <class T_pixel>
 InputImageParameters InputImageParameters::From(const arte::Image<T_pixel> & aImage)
 {
-    return {
-        aImage.dimensions(),
-        MappedPixel_v<T_pixel>,
-        MappedPixelComponentType_v<T_pixel>,
-        (GLint)aImage.rowAlignment()
+    return From(aImage.view());
+}
+
+
+template <class T_pixel>
+InputImageParameters InputImageParameters::From(arte::ImageView<T_pixel> aImageView)
+{
+    using Pixel_t = std::remove_const_t<T_pixel>;
+
+    // OpenGL computes the stride of client rows as the pixel size times GL_UNPACK_ROW_LENGTH
+    // (or the width when 0), rounded up to a multiple of GL_UNPACK_ALIGNMENT (1, 2, 4 or 8).
+    // Find a combination reproducing the view stride exactly.
+    auto roundUp = [](std::size_t aValue, std::size_t aAlignment)
+    {
+        return (aValue + aAlignment - 1) / aAlignment * aAlignment;
     };
+    const std::size_t stride = aImageView.stride_bytes();
+
+    for (GLint alignment : {8, 4, 2, 1})
+    {
+        // Prefer leaving the row length to 0
+        if (roundUp(aImageView.size_bytes_line(), alignment) == stride)
+        {
+            return {aImageView.dimensions(),
+                    MappedPixel_v<Pixel_t>, MappedPixelComponentType_v<Pixel_t>,
+                    alignment, 0};
+        }
+    }
+    // Views on a sub-rectangle of a larger image require a row length
+    const std::size_t rowLength = stride / sizeof(Pixel_t);
+    for (GLint alignment : {8, 4, 2, 1})
+    {
+        if (roundUp(rowLength * sizeof(Pixel_t), alignment) == stride)
+        {
+            return {aImageView.dimensions(),
+                    MappedPixel_v<Pixel_t>, MappedPixelComponentType_v<Pixel_t>,
+                    alignment, (GLint)rowLength};
+        }
+    }
+
+    throw std::invalid_argument{
+        "The image stride (" + std::to_string(stride)
+        + " bytes) cannot be expressed with OpenGL pixel storage modes."};
 }
 
 
@@ -97,6 +143,7 @@ inline void writeTo(const Texture & aTexture,
 
     // Handle alignment
     Guard scopedAlignemnt = scopeUnpackAlignment(aInput.alignment);
+    Guard scopedRowLength = scopeUnpackRowLength(aInput.rowLength);
 
     glTexSubImage2D(aTexture.mTarget, aMipmapLevelId,
                     aTextureOffset.x(), aTextureOffset.y(),
@@ -119,6 +166,7 @@ inline void writeTo(const Texture & aTexture,
 
     // Handle alignment
     Guard scopedAlignemnt = scopeUnpackAlignment(aInput.alignment);
+    Guard scopedRowLength = scopeUnpackRowLength(aInput.rowLength);
 
     glTexSubImage3D(aTexture.mTarget, aMipmapLevelId,
                     aTextureOffset.x(), aTextureOffset.y(), aTextureOffset.z(),
@@ -128,6 +176,22 @@ inline void writeTo(const Texture & aTexture,
 }
 
 
+/// \brief Write the pixels addressed by `aImageView` into `aTexture`, whose storage is already allocated.
+/// \note The view might address a sub-rectangle of a larger image, no intermediate copy is made.
+template <class T_pixel>
+void writeTo(const Texture & aTexture,
+             arte::ImageView<T_pixel> aImageView,
+             math::Position<2, GLint> aTextureOffset = {0, 0},
+             GLint aMipmapLevelId = 0)
+{
+    writeTo(aTexture,
+            reinterpret_cast<const std::byte *>(aImageView.data()),
+            InputImageParameters::From(aImageView),
+            aTextureOffset,
+            aMipmapLevelId);
+}
+
+
 /// \brief Allocate storage and read `aImage` into `aTexture`.
 /// \note The number of mipmap levels allocated for the texture can be specified,
 /// but the provided image is always written to mipmal level #0.
@@ -151,6 +215,122 @@ void loadImage(const Texture & aTexture,
         InputImageParameters::From(aImage));
 }
 
+
+/// \brief Allocate storage and read the pixels addressed by `aImageView` into `aTexture`.
+template <class T_pixel>
+void loadImage(const Texture & aTexture,
+               arte::ImageView<T_pixel> aImageView,
+               GLint aMipmapLevelsCount = 1)
+{
+    // Probably too restrictive
+    assert(aTexture.mTarget == GL_TEXTURE_2D
+        || aTexture.mTarget == GL_TEXTURE_RECTANGLE);
+
+    allocateStorage(
+        aTexture,
+        MappedSizedPixel_v<std::remove_const_t<T_pixel>>,
+        aImageView.dimensions(),
+        aMipmapLevelsCount);
+    writeTo(aTexture, aImageView);
+}
+
+/// \brief Allocate storage for all the levels of `aMipChain`, and write each of them into `aTexture`.
+/// \note This does not require the driver to generate mipmaps, see `arte::buildMipChain()`.
+template <class T_pixel>
+void loadImage(const Texture & aTexture,
+               const arte::MipChain<T_pixel> & aMipChain)
+{
+    // Probably too restrictive
+    assert(aTexture.mTarget == GL_TEXTURE_2D
+        || aTexture.mTarget == GL_TEXTURE_RECTANGLE);
+
+    allocateStorage(
+        aTexture,
+        MappedSizedPixel_v<T_pixel>,
+        aMipChain.dimensions(),
+        aMipChain.levelCount());
+    for (int level = 0; level != aMipChain.levelCount(); ++level)
+    {
+        writeTo(aTexture, aMipChain.level(level), {0, 0}, level);
+    }
+}
+
+
+/// \brief The OpenGL compressed internal format storing `aFormat` blocks.
+/// \param aEncoding With ColorEncoding::Srgb, the color channels are decoded to linear when sampled.
+/// It must be Linear for Bc4, which stores a single non-color channel.
+inline GLenum getCompressedInternalFormat(arte::BlockFormat aFormat, arte::ColorEncoding aEncoding)
+{
+    const bool srgb = (aEncoding == arte::ColorEncoding::Srgb);
+    switch (aFormat)
+    {
+    case arte::BlockFormat::Bc1:
+        return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case arte::BlockFormat::Bc3:
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case arte::BlockFormat::Bc4:
+        if (srgb)
+        {
+            throw std::invalid_argument{"Bc4 has no sRGB encoded variant."};
+        }
+        return GL_COMPRESSED_RED_RGTC1;
+    case arte::BlockFormat::Bc7:
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    }
+    throw std::domain_error{"Invalid block format."};
+}
+
+
+/// \brief Write the blocks of `aCompressed` into `aTexture`, whose storage is already allocated
+/// with the matching compressed internal format (see `getCompressedInternalFormat()`).
+/// \note The blocks are uploaded as is, the driver does not need to recompress them.
+/// `aTextureOffset` must be a multiple of the block size.
+inline void writeTo(const Texture & aTexture,
+                    const arte::CompressedImage & aCompressed,
+                    arte::ColorEncoding aEncoding,
+                    math::Position<2, GLint> aTextureOffset = {0, 0},
+                    GLint aMipmapLevelId = 0)
+{
+    assert(aTexture.mTarget != GL_TEXTURE_CUBE_MAP);
+    assert(aTextureOffset.x() % arte::gBlockSize == 0 && aTextureOffset.y() % arte::gBlockSize == 0);
+
+    ScopedBind bound(aTexture);
+
+    // The blocks are tightly packed: the unpack modes describing client pixels do not apply.
+    Guard scopedAlignemnt = scopeUnpackAlignment(1);
+    Guard scopedRowLength = scopeUnpackRowLength(0);
+
+    glCompressedTexSubImage2D(aTexture.mTarget, aMipmapLevelId,
+                              aTextureOffset.x(), aTextureOffset.y(),
+                              aCompressed.mDimensions.width(), aCompressed.mDimensions.height(),
+                              getCompressedInternalFormat(aCompressed.mFormat, aEncoding),
+                              static_cast<GLsizei>(aCompressed.size_bytes()),
+                              aCompressed.data());
+}
+
+
+/// \brief Allocate compressed storage and write the blocks of `aCompressed` into `aTexture`.
+/// \note The number of mipmap levels allocated for the texture can be specified,
+/// but the provided blocks are always written to mipmap level #0.
+inline void loadImage(const Texture & aTexture,
+                      const arte::CompressedImage & aCompressed,
+                      arte::ColorEncoding aEncoding = arte::ColorEncoding::Linear,
+                      GLint aMipmapLevelsCount = 1)
+{
+    // Probably too restrictive
+    assert(aTexture.mTarget == GL_TEXTURE_2D);
+
+    allocateStorage(
+        aTexture,
+        getCompressedInternalFormat(aCompressed.mFormat, aEncoding),
+        aCompressed.mDimensions,
+        aMipmapLevelsCount);
+    writeTo(aTexture, aCompressed, aEncoding);
+}
+
+
+/// \brief Load `aImage` as level 0, then let the driver generate the complete mipmap chain.
+/// \note To control the filtering, or avoid requiring a context, prefer loading an `arte::MipChain`.
 template <class T_pixel>
 void loadImageCompleteMipmaps(const Texture & aTexture,
                               const arte::Image<T_pixel> & aImage)
@@ -175,7 +355,9 @@ inline void loadAnimationAsArray(const Texture & aTexture,
 
     ScopedBind bound(aTexture);
 
-    Guard scopedAlignemnt = scopeUnpackAlignment(aImage.rowAlignment());
+    InputImageParameters input = InputImageParameters::From(aImage);
+    Guard scopedAlignemnt = scopeUnpackAlignment(input.alignment);
+    Guard scopedRowLength = scopeUnpackRowLength(input.rowLength);
 
     glTexImage3D(aTexture.mTarget, 0, GL_RGBA,
                  aFrame.width(), aFrame.height(), static_cast<GLsizei>(aSteps),